@@ -1,3 +1,2 @@
 call scripts/generate_vs
 
-call shaders/compile_shaders
\ No newline at end of file
@@ -0,0 +1,55 @@
+#pragma once
+
+// ===============================================================================================================================================================================
+
+// CPU reference of the grass blade simulation performed in grassCompute.comp, used to check the GPU results numerically.
+
+// ===============================================================================================================================================================================
+
+#include <glm/glm.hpp>
+
+#include "GrassBlade.h"
+
+#include <vector>
+#include <cstdint>
+
+// ===============================================================================================================================================================================
+
+// Simulation settings shared by the GPU (pushed as constants) and the CPU reference.
+struct BladeSimulationParameters {
+	float gravity = 1.0f;		// Environmental gravity acceleration pulling the tip down (Z is up).
+	float windForce = 4.0f;		// Scales the sampled wind vector into a force on the tip.
+	float trampleRecoveryTime = 4.0f;	// Seconds for a fully trampled blade to regain its stiffness.
+	float simulationDistance = 30.0f;	// Blades with roots horizontally closer than this to the camera are fully simulated.
+	float swayDistance = 80.0f;			// Blades closer than this (and beyond simulationDistance) sway analytically, blades beyond it are static.
+	glm::vec2 cameraPosition = glm::vec2(0.0f);	// Horizontal camera position the tiers were measured from.
+	float deltaTime = 0.0f;		// Seconds simulated this step, already clamped to kGrassMaxSimulationStep.
+};
+
+// The outcome of comparing a sample of GPU simulated blades against the CPU reference.
+struct BladeSimulationValidation {
+	uint32_t sampled = 0;		// Blades read back from the GPU.
+	uint32_t compared = 0;		// Sampled blades that were simulated or swayed rather than culled or static (those carry their state forward unchanged).
+	uint32_t mismatched = 0;	// Compared blades further than the tolerance from the reference.
+	float maxError = 0.0f;		// Largest distance between a GPU and CPU control point, or difference in trample amount.
+	float meanError = 0.0f;		// Average of the largest control point distance per compared blade.
+};
+
+namespace BladeSimulation {
+
+	// Advances one blade by parameters.deltaTime. Mirrors simulateBlade in grassCompute.comp, any change there must be made here too.
+	// Tests every collider rather than the blade's grid cell, so a binning mistake on the GPU shows up as a mismatch.
+	GrassBladeInstanceData step(const GrassBladeInstanceData& lastState, glm::vec2 windSample, float lastTrample, const std::vector<glm::vec4>& colliders, 
+		const BladeSimulationParameters& parameters, float& trample);
+
+	// Analytic pose of a blade in the middle distance tier. Mirrors swayBlade in grassCompute.comp.
+	GrassBladeInstanceData sway(const GrassBladeInstanceData& lastState, glm::vec2 windSample, const BladeSimulationParameters& parameters);
+
+	// Bilinearly samples a square wind field with repeat addressing, the same filtering the culling pass gets from its sampler.
+	glm::vec2 sampleWindField(const std::vector<glm::vec2>& windField, uint32_t resolution, glm::vec2 uv);
+
+	// Steps (or sways, depending on its distance tier) every last state on the CPU and compares it with the GPU's result for the same blade.
+	BladeSimulationValidation validate(const std::vector<GrassBladeInstanceData>& lastStates, const std::vector<GrassBladeInstanceData>& gpuStates,
+		const std::vector<float>& lastTrample, const std::vector<float>& gpuTrample, const std::vector<glm::vec2>& windSamples, 
+		const std::vector<glm::vec4>& colliders, const BladeSimulationParameters& parameters, float tolerance);
+}
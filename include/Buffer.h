@@ -9,6 +9,12 @@
 #define GLM_FORCE_DEPTH_ZERO_TO_ONE
 #include <glm/glm.hpp> 
 
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+#include "Constants.h"
+
 // ===============================================================================================================================================================================
 
 // Camera matrices & model matrix, bound to 2 pipelines where the grass pipeline ignores model matrix.
@@ -18,13 +24,91 @@ struct CameraUniformBufferObject {
 	alignas(16) glm::mat4 proj;
 };
 
-// Output value to determine the number of grass blades to draw.
+// Written by the culling pass and drawn from with vkCmdDrawIndirect, so the CPU never reads the counts back before drawing. The two draw
+// commands match the layout of VkDrawIndirectCommand, farFirstInstance starts at the blade count and moves back one per far blade.
 struct NumBladesBufferObject {
+	alignas(4) uint32_t nearVertexCount;
+	alignas(4) uint32_t numNearVisible;	// Near level of detail, compacted from the front of the visible blade buffer.
+	alignas(4) uint32_t nearFirstVertex;
+	alignas(4) uint32_t nearFirstInstance;
+	alignas(4) uint32_t farVertexCount;
+	alignas(4) uint32_t numFarVisible;	// Far level of detail, compacted from the back of the visible blade buffer.
+	alignas(4) uint32_t farFirstVertex;
+	alignas(4) uint32_t farFirstInstance;
 	alignas(4) uint32_t numVisible;
+	alignas(4) uint32_t numSimulated;	// Visible blades fully simulated (near tier).
+	alignas(4) uint32_t numSwaying;		// Visible blades swayed analytically (middle tier).
+	alignas(4) uint32_t numStatic;		// Visible blades left in their last pose (far tier).
 };
 
 // For use in the compute shader.
 struct PushConstantsObject {
 	alignas(4) uint32_t totalNumBlades;
 	alignas(4) float elapsed;
-};
\ No newline at end of file
+	alignas(4) float lodDistance;
+	alignas(16) glm::vec4 cameraPosition;
+	alignas(4) float windFieldWorldSize;
+	alignas(4) float deltaTime;			// Blade simulation step in seconds.
+	alignas(4) float gravity;			// See BladeSimulationParameters.
+	alignas(4) float windForce;			// See BladeSimulationParameters.
+	alignas(4) float trampleRecoveryTime;	// See BladeSimulationParameters.
+	alignas(4) float simulationDistance;	// See BladeSimulationParameters.
+	alignas(4) float swayDistance;			// See BladeSimulationParameters.
+};
+
+// Specialization constants (constant_id 0 to 3) of the terrain shaders and the grass compute shader, so both map the height map the same way.
+struct TerrainSpecializationConstants {
+	float heightMapScale = kTerrainHeightMapScale;
+	float terrainScale = kTerrainHeightScale;
+	float uvOffset = kTerrainUvOffset;
+	float uvSize = kTerrainUvSize;
+};
+
+// Specialization constants of the grass compute shader, the terrain's followed by a GrassComputeVariant (constant_id 4 to 8).
+struct GrassComputeSpecializationConstants {
+	TerrainSpecializationConstants terrain = {};
+	uint32_t workgroupSize = kGrassComputeWorkgroupSize;
+	uint32_t frustumCulling = 1;			// VkBool32, specialization booleans are 32 bits.
+	uint32_t wind = 1;
+	uint32_t windField = 1;
+	float frustumShrinkFactor = kFrustumShrinkFactor;
+};
+
+// For use in the wind field compute shader.
+struct WindPushConstantsObject {
+	alignas(8) glm::vec2 direction;
+	alignas(4) float strength;
+	alignas(4) float gustStrength;
+	alignas(4) float gustFrequency;
+	alignas(4) float elapsed;
+};
+
+// For use in the grass pipelines. The instanced strip path reads the number of strip vertices for the level of detail being drawn, the
+// tessellated path reads the tessellation levels (see SceneSettings).
+struct GrassPushConstantsObject {
+	alignas(4) uint32_t vertexCount;
+	alignas(4) float minTessellationLevel;
+	alignas(4) float maxTessellationLevel;
+	alignas(4) float tessellationDistance;
+};
+
+// Sphere colliders binned into a uniform grid, rebuilt on the CPU every frame (see ColliderGrid). Matches the std430 ColliderBuffer in grassCompute.comp.
+// A blade looks up the cell containing its root and tests only the colliders referenced by that cell.
+struct ColliderBufferObject {
+	alignas(8) glm::vec2 gridOrigin;
+	alignas(4) float cellSize;
+	alignas(4) uint32_t gridResolution;
+	alignas(4) uint32_t numColliders;
+	alignas(16) glm::vec4 colliders[kMaxColliders];					// XYZ centre (height above the terrain), W radius.
+	alignas(4) uint32_t cellStart[kColliderGridCells];				// First entry of each cell in colliderIndices.
+	alignas(4) uint32_t cellCount[kColliderGridCells];				// Number of entries of each cell in colliderIndices.
+	alignas(4) uint32_t colliderIndices[kMaxColliderReferences];	// Indices into colliders, grouped by cell.
+};
+
+// GLSL cannot see Constants.h, so ColliderBuffer in grassCompute.comp spells out the array sizes. Changing either constant must change the
+// shader too, otherwise the upload overruns the buffer or the shader reads the cells from the wrong offsets.
+static_assert(kMaxColliders == 512 && kColliderGridCells == 1024, "update the ColliderBuffer array sizes in grassCompute.comp.");
+static_assert(offsetof(ColliderBufferObject, colliders) == 32, "colliders must follow the std430 grid header.");
+static_assert(offsetof(ColliderBufferObject, cellStart) == 32 + sizeof(glm::vec4) * kMaxColliders, "cellStart must follow colliders.");
+static_assert(offsetof(ColliderBufferObject, colliderIndices) == offsetof(ColliderBufferObject, cellStart) + sizeof(uint32_t) * 2 * kColliderGridCells,
+	"colliderIndices must follow cellStart and cellCount.");
\ No newline at end of file
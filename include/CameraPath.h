@@ -0,0 +1,52 @@
+#pragma once
+
+// ===============================================================================================================================================================================
+
+// Keyframed camera flythroughs for reproducible benchmarks. Paths are driven by frame index rather than wall time, so every run renders the
+// same sequence of views regardless of how long each frame takes.
+
+// ===============================================================================================================================================================================
+
+#include <glm/glm.hpp>
+
+#include "Camera.h"
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+// ===============================================================================================================================================================================
+
+// A camera pose at a frame of the path.
+struct CameraKeyframe {
+	uint32_t frame = 0;
+	glm::vec3 position = glm::vec3(0.0f);
+	float pitch = 0.0f;
+	float yaw = 0.0f;		// Degrees, not wrapped, so interpolation never takes the long way round.
+	float fov = 45.0f;
+};
+
+class CameraPath {
+public:
+	// Reads a path saved by save(), one "frame x y z pitch yaw fov" keyframe per-line with '#' comments. Keyframe frames must be strictly
+	// increasing. Returns false if the file cannot be read or holds no keyframes.
+	bool load(const std::string& fileName);
+	bool save(const std::string& fileName) const;
+
+	// A loop over the meadow that starts and ends on the Defaults pose from Camera.h.
+	static CameraPath createDefaultFlythrough();
+
+	// Appends a keyframe, used to record a path from live input. Keyframes at or before the last keyframe's frame are ignored.
+	void addKeyframe(const CameraKeyframe& keyframe);
+
+	// Poses the camera at a frame of the path with a Catmull-Rom spline through the keyframes, parameterised by keyframe frame so unevenly
+	// spaced keyframes keep a steady speed. Frames beyond the end of the path wrap around, so a path can be shorter than the capture. Returns
+	// the path frame that was applied.
+	uint32_t apply(uint32_t frame, Camera& camera) const;
+
+	uint32_t getLength() const { return keyframes.empty() ? 0 : keyframes.back().frame; }
+	bool isEmpty() const { return keyframes.empty(); }
+
+private:
+	std::vector<CameraKeyframe> keyframes = {};
+};
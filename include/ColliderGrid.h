@@ -0,0 +1,24 @@
+#pragma once
+
+// ===============================================================================================================================================================================
+
+// Bins sphere colliders into the uniform grid read by the culling pass, so each blade only tests the colliders near its root.
+
+// ===============================================================================================================================================================================
+
+#include <glm/glm.hpp>
+
+#include "Buffer.h"
+
+#include <vector>
+#include <cstdint>
+
+// ===============================================================================================================================================================================
+
+namespace ColliderGrid {
+
+	// Writes the colliders (XYZ centre, W radius) and the per-cell index lists into buffer. A collider is referenced by every cell within its
+	// radius plus the tallest blade, since a blade rooted in that cell can lean its tip into the sphere. Returns the number of colliders written,
+	// colliders beyond kMaxColliders and references beyond kMaxColliderReferences are dropped.
+	uint32_t build(const std::vector<glm::vec4>& colliders, ColliderBufferObject& buffer);
+}
@@ -11,13 +11,15 @@ const std::vector<const char*> kValidationLayers = { "VK_LAYER_KHRONOS_validatio
 
 // ===============================================================================================================================================================================
 
-// Number of frames that are either being written to or presented during the application.
-static constexpr int kMaxFramesInFlight = 2;
+// Number of frames the CPU may record ahead of the GPU, overridden with --frames-in-flight up to kMaxFramesInFlight. More frames in flight
+// hide CPU and GPU stalls at the cost of input latency, one frame serialises the CPU and GPU.
+static constexpr int kDefaultFramesInFlight = 2;
+static constexpr int kMaxFramesInFlight = 4;
 
-// Number of frames to wait for until the application monitors frame timings.
+// Default number of frames to wait for until the application monitors frame timings, overridden with --warmup.
 static constexpr int kWaitFrames = 3000u;
 
-// Number of frames to capture the timing for.
+// Default number of frames to capture the timing for, overridden with --capture.
 static constexpr int kMonitorFrames = 10000u;
 
 // ===============================================================================================================================================================================
@@ -27,6 +29,12 @@ static constexpr int kMonitorFrames = 10000u;
 #define MEADOW_SCALE_Y 120
 #define MEADOW_SCALE_Z 1	
 
+// Terrain height map mapping, specialization constants of the terrain shaders and the grass compute shader so the blades sit on the terrain.
+constexpr float kTerrainHeightMapScale = 64.0f;				// World height of a white height map texel, before kTerrainHeightScale.
+constexpr float kTerrainHeightScale = 1.5f;
+constexpr float kTerrainUvOffset = 30.0f;					// The height map covers [-kTerrainUvOffset, kTerrainUvSize - kTerrainUvOffset] on X and Y.
+constexpr float kTerrainUvSize = 170.0f;
+
 // ===============================================================================================================================================================================
 
 #define APP_VERSION_MAJOR 1
@@ -39,4 +47,63 @@ constexpr uint32_t kMaxBlades = 2 << 21;
 constexpr float kGrassMinWidth = 0.050f;
 constexpr float kGrassMaxWidth = 0.100f;
 constexpr float kGrassMinHeight = 0.45f;
-constexpr float kGrassMaxHeight = 1.0f;
\ No newline at end of file
+constexpr float kGrassMaxHeight = 1.0f;
+constexpr float kGrassMinStiffness = 4.0f;
+constexpr float kGrassMaxStiffness = 12.0f;
+
+// Blade simulation related constants.
+constexpr float kGrassMaxSimulationStep = 1.0f / 30.0f;		// Longest step the simulation takes in one frame, keeps the stiffness recovery stable after a hitch.
+constexpr uint32_t kSimulationValidationSamples = 4096;		// Blades read back and checked against the CPU reference when validating the simulation.
+constexpr float kSimulationValidationTolerance = 1e-3f;		// World units a GPU control point may differ from the CPU reference by.
+
+// ===============================================================================================================================================================================
+
+// Non-tessellated fallback path for devices without tessellation shader support (ie., integrated GPUs and software rasterisers such as lavapipe).
+static constexpr bool kForceInstancedStripFallback = false;	// Use the fallback path even when the device supports tessellation (testing).
+constexpr uint32_t kStripNearVertexCount = 15;				// Triangle strip vertices per-blade for the near level of detail, (2 * segments) + 1 for the tip.
+constexpr uint32_t kStripFarVertexCount = 7;				// Triangle strip vertices per-blade for the far level of detail.
+constexpr uint32_t kTerrainGridResolution = 128;			// Quads per-side of the pre-subdivided terrain grid that replaces terrain tessellation.
+constexpr float kGrassLodDistance = 25.0f;					// Distance from the camera at which the culling pass moves a blade into the far level of detail.
+constexpr uint32_t kGrassComputeWorkgroupSize = 32;			// Default blades per work group of the culling pass, a warp on most hardware. See GrassComputeVariant.
+constexpr float kFrustumShrinkFactor = 1.0f;				// Shrinks the culling frustum for testing, 0 is no frustum and 1 is screen-space.
+
+// ===============================================================================================================================================================================
+
+// Wind field, a tileable texture of wind vectors updated once per-frame and sampled once per-blade by the culling pass.
+constexpr uint32_t kWindFieldResolution = 256;				// Texels per-side of the wind field texture.
+constexpr float kWindFieldWorldSize = 64.0f;				// World units covered by one tile of the wind field, the texture repeats beyond this.
+
+// ===============================================================================================================================================================================
+
+// Colliders, spheres that push and trample the blades. Binned on the CPU into a uniform grid over the meadow so each blade only tests nearby colliders.
+constexpr uint32_t kMaxColliders = 512;						// Spheres uploaded per-frame, anything beyond this is dropped.
+constexpr uint32_t kColliderGridResolution = 32;			// Cells per-side of the collider grid.
+constexpr uint32_t kColliderGridCells = kColliderGridResolution * kColliderGridResolution;	// Total cells in the collider grid.
+constexpr uint32_t kMaxColliderReferences = 8192;			// Collider to cell references, a collider is referenced by every cell it overlaps.
+constexpr float kColliderGridOrigin = -30.0f;				// Minimum X and Y of the meadow (see populateBladeInstanceBuffer).
+constexpr float kColliderGridWorldSize = 170.0f;			// World units covered by the collider grid along X and Y.
+
+// ===============================================================================================================================================================================
+
+// Profiling.
+constexpr uint32_t kGpuProfilerHistory = 256;				// Frames of GPU scope timings kept for the rolling average and p99.
+constexpr uint32_t kCpuProfilerRingSize = 1 << 18;			// CPU zones kept per-thread for the trace, a power of two. The oldest are overwritten.
+constexpr uint32_t kCpuProfilerGpuFrames = 1 << 14;		// Frames of GPU scope timestamps kept for the trace.
+constexpr float kLatencySmoothing = 0.05f;					// Weight of each frame in the moving average of the input-to-present latency.
+
+// ===============================================================================================================================================================================
+
+// Threading.
+constexpr uint32_t kTaskPoolMinThreads = 2;					// Workers started even on machines with fewer hardware threads, so start-up tasks still overlap.
+constexpr uint32_t kShaderWatcherPollMs = 250;				// How often the shader watcher checks for changes, and how long it takes to notice a stop.
+
+// ===============================================================================================================================================================================
+
+// Camera paths.
+constexpr uint32_t kCameraPathRecordInterval = 30;			// Frames between keyframes when recording a camera path from live input.
+constexpr uint32_t kCameraPathSegmentFrames = 600;			// Frames between keyframes of the built-in flythrough.
+// ===============================================================================================================================================================================
+
+// Scripted resize test (--resize-test).
+constexpr uint32_t kResizeTestInterval = 20;				// Frames between window resizes.
+constexpr uint32_t kResizeTestSteps = 24;					// Resizes before the test reports and closes the window.
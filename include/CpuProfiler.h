@@ -0,0 +1,122 @@
+#pragma once
+
+// ===============================================================================================================================================================================
+
+// CPU profiler, times RAII zones with a nanosecond clock into a lock-free, seqlocked ring buffer per-thread, and exports them together with the GPU
+// profiler's scopes as a Chrome trace (chrome://tracing or ui.perfetto.dev).
+
+// ===============================================================================================================================================================================
+
+#include "GpuProfiler.h"
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+// ===============================================================================================================================================================================
+
+// One completed zone. Zones are named with string literals, only the pointer is stored.
+struct CpuZoneEvent {
+	const char* name = nullptr;
+	uint64_t beginNs = 0;
+	uint64_t endNs = 0;
+	uint32_t depth = 0;			// Nesting depth on its thread, 0 for an outermost zone.
+};
+
+// The zones one thread recorded, oldest first.
+struct CpuThreadZones {
+	std::string name;
+	uint32_t threadId = 0;
+	std::vector<CpuZoneEvent> zones = {};
+};
+
+// The GPU scope timestamps of one frame, and the CPU time that frame's first command buffer was submitted.
+struct GpuFrameEvents {
+	uint64_t submitNs = 0;
+	std::array<GpuScopeTimestamps, static_cast<size_t>(GpuScope::Count)> scopes = {};
+};
+
+class CpuProfiler {
+public:
+	static CpuProfiler& get();
+
+	// Nanoseconds since the profiler was first used, on a steady clock.
+	static uint64_t now();
+
+	// Zones are only recorded while enabled, a disabled zone costs one relaxed atomic load.
+	void setEnabled(bool enable) { enabled.store(enable, std::memory_order_relaxed); }
+	bool isEnabled() const { return enabled.load(std::memory_order_relaxed); }
+
+	// Names the calling thread in the trace.
+	void setThreadName(const char* name);
+
+	// Appends a zone to the calling thread's ring buffer. Used by CpuProfileZone.
+	void recordZone(const char* name, uint64_t beginNs, uint64_t endNs, uint32_t depth);
+
+	// Keeps the GPU scopes of a resolved frame for the trace. Only called from the render thread.
+	void addGpuFrame(const GpuFrameEvents& frame);
+
+	// Copies the zones that began at or after sinceNs and are still in the ring buffers, per-thread. Safe while other threads record, zones
+	// overwritten during the copy are left out.
+	std::vector<CpuThreadZones> collectZones(uint64_t sinceNs) const;
+
+	// Writes collectZones(sinceNs) and the GPU frames submitted since as Chrome trace JSON. Returns false if the file could not be opened.
+	bool exportChromeTrace(const std::string& fileName, uint64_t sinceNs) const;
+
+private:
+	// One ring entry. sequence is 2 * zone + 1 while that zone is being written and 2 * zone + 2 once it is, so a reader knows which zone
+	// the slot holds and rejects a slot rewritten during its copy. The fields are relaxed atomics so that the copy is not a data race.
+	struct ZoneSlot {
+		std::atomic<uint64_t> sequence = 0;
+		std::atomic<const char*> name = nullptr;
+		std::atomic<uint64_t> beginNs = 0;
+		std::atomic<uint64_t> endNs = 0;
+		std::atomic<uint32_t> depth = 0;
+	};
+
+	// Single producer ring of one thread's zones. Only the owning thread writes events and depth, head is published with release ordering.
+	struct ThreadBuffer {
+		std::unique_ptr<ZoneSlot[]> events = nullptr;	// Allocated by the first zone, threads that only name themselves cost no ring.
+		std::atomic<uint64_t> head = 0;		// Zones written since the thread was registered, the ring index is head % kCpuProfilerRingSize.
+		uint32_t threadId = 0;
+		std::string name;
+		uint32_t depth = 0;					// Open zones on this thread.
+	};
+
+	// The calling thread's buffer, registered on first use.
+	ThreadBuffer& getThreadBuffer();
+	static thread_local ThreadBuffer* currentThreadBuffer;	// Cached so only the first zone of a thread takes the registration lock.
+
+	friend class CpuProfileZone;
+
+	std::atomic<bool> enabled = false;
+	mutable std::mutex threadsMutex;							// Guards threads, taken once per-thread on registration and by the export.
+	std::vector<std::unique_ptr<ThreadBuffer>> threads = {};	// Never shrinks, so a thread's buffer outlives the thread for the export.
+	std::vector<GpuFrameEvents> gpuFrames = {};					// Ring of kCpuProfilerGpuFrames frames.
+	uint64_t gpuFramesHead = 0;
+};
+
+// Times the enclosing scope on the calling thread.
+class CpuProfileZone {
+public:
+	explicit CpuProfileZone(const char* name);
+	~CpuProfileZone();
+
+	CpuProfileZone(const CpuProfileZone&) = delete;
+	CpuProfileZone& operator=(const CpuProfileZone&) = delete;
+
+private:
+	const char* name = nullptr;
+	uint64_t beginNs = 0;
+	bool active = false;		// Whether the profiler was enabled when the zone opened.
+};
+
+#define CPU_PROFILE_CONCAT_INNER(a, b) a##b
+#define CPU_PROFILE_CONCAT(a, b) CPU_PROFILE_CONCAT_INNER(a, b)
+
+// Declares a CpuProfileZone named name (a string literal) for the rest of the scope.
+#define CPU_PROFILE_ZONE(name) CpuProfileZone CPU_PROFILE_CONCAT(cpuProfileZone, __LINE__)(name)
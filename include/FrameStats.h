@@ -0,0 +1,117 @@
+#pragma once
+
+// ===============================================================================================================================================================================
+
+// Frame statistics recorder for benchmark captures. Writes one CSV row per-frame after a metadata header, and keeps running statistics of the
+// CPU frame time that are appended as a summary when the capture completes.
+
+// ===============================================================================================================================================================================
+
+#include <glm/glm.hpp>
+
+#include "GpuProfiler.h"
+
+#include <array>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+// ===============================================================================================================================================================================
+
+// Describes the run, written as "# key: value" lines before the column header.
+struct FrameStatsMetadata {
+	std::string build;
+	std::string device;
+	uint32_t numBlades = 0;
+	bool frustumCulling = true;
+	float maxTessellationLevel = 0.0f;	// 0 on the instanced strip path, which is not tessellated.
+	uint32_t computeWorkgroupSize = 32;	// Blades per work group of the culling pass.
+	bool windField = true;				// Wind sampled from the wind field texture, false for per-blade Perlin noise.
+	uint32_t width = 0, height = 0;
+	std::string presentMode;
+	uint32_t swapchainImages = 0;	// 0 when headless.
+	float fpsLimit = 0.0f;			// The main loop's frame limit, 0 when unlimited.
+	uint32_t framesInFlight = 0;
+	bool asyncCompute = false;		// Culling on a queue of its own, see VulkanApplication::setAsyncCompute.
+	bool dynamicRendering = false;	// vkCmdBeginRendering rather than a render pass, see VulkanApplication::setDynamicRendering.
+	std::string cameraPath;			// The played camera path, "none" when the camera was driven by live input.
+	uint32_t warmupFrames = 0;
+	uint32_t captureFrames = 0;
+};
+
+// One captured frame. GPU pass times lag the CPU time by the frames in flight, as they are resolved without stalling.
+struct FrameStatsSample {
+	double cpuMs = 0.0;
+	std::array<float, static_cast<size_t>(GpuScope::Count)> gpuMs = {};
+	float gpuComputeOverlapMs = 0.0f;	// Culling that ran alongside the previous frame's draws.
+	float inputToPresentMs = 0.0f;		// CPU time from polling input to queueing the present, 0 when headless.
+	uint32_t numVisible = 0;
+	glm::vec3 cameraPosition = glm::vec3(0.0f);
+	float cameraPitch = 0.0f;
+	float cameraYaw = 0.0f;
+	int64_t pathFrame = -1;			// Frame of the played camera path, -1 without one.
+};
+
+// Frame time statistics in milliseconds.
+struct FrameStatsSummary {
+	uint64_t numFrames = 0;
+	double mean = 0.0;
+	double median = 0.0;
+	double p95 = 0.0;
+	double p99 = 0.0;
+	double max = 0.0;
+	double variance = 0.0;
+	std::array<double, static_cast<size_t>(GpuScope::Count)> gpuMean = {};	// Mean GPU pass times.
+	double meanVisible = 0.0;												// Mean visible blades per-frame.
+	double meanComputeOverlap = 0.0;										// Mean gpuComputeOverlapMs.
+	double meanInputToPresent = 0.0;										// Mean inputToPresentMs.
+};
+
+// Column name of a GPU scope without spaces, e.g. "Wind field" becomes "gpuWindFieldMs".
+std::string getGpuScopeColumnName(GpuScope scope);
+
+class FrameStatsRecorder {
+public:
+	// Opens fileName and writes the metadata header. Returns false if the file could not be opened.
+	bool open(const std::string& fileName, const FrameStatsMetadata& metadata);
+
+	// Appends one row and updates the running statistics.
+	void record(const FrameStatsSample& sample);
+
+	// Appends the summary as "# key: value" lines and closes the file.
+	void close();
+
+	FrameStatsSummary getSummary() const;
+	uint64_t getNumFrames() const { return numFrames; }
+	bool isOpen() const { return file.is_open(); }
+
+private:
+	std::ofstream file;
+	std::vector<double> frameTimes = {};	// Kept for the order statistics, the capture length bounds its size.
+	uint64_t numFrames = 0;
+	double mean = 0.0;						// Welford's running mean and sum of squared deviations, numerically stable over long captures.
+	double m2 = 0.0;
+	double max = 0.0;
+	std::array<double, static_cast<size_t>(GpuScope::Count)> gpuTotals = {};	// Sums for the means in the summary.
+	double visibleTotal = 0.0;
+	double computeOverlapTotal = 0.0;
+	double inputToPresentTotal = 0.0;
+};
+
+// The consolidated table of a benchmark sweep, one row per-configuration with its settings and capture summary. Rows are written as each
+// configuration completes, so an interrupted sweep keeps the configurations that finished.
+class SweepResultsWriter {
+public:
+	// Opens fileName and writes the settings shared by every configuration (build, device, resolution, present mode, camera path, and
+	// capture lengths) as "# key: value" lines, then the column header. Returns false if the file could not be opened.
+	bool open(const std::string& fileName, const FrameStatsMetadata& metadata);
+
+	void write(const FrameStatsMetadata& metadata, const FrameStatsSummary& summary);
+
+	void close() { file.close(); }
+	bool isOpen() const { return file.is_open(); }
+
+private:
+	std::ofstream file;
+};
@@ -0,0 +1,148 @@
+#pragma once
+
+// ===============================================================================================================================================================================
+
+// GPU profiler, brackets named scopes of the compute and graphics command buffers with timestamp queries and keeps a rolling history of each.
+
+// ===============================================================================================================================================================================
+
+#include <vulkan/vulkan.h>
+
+#include <array>
+#include <vector>
+#include <cstdint>
+
+// ===============================================================================================================================================================================
+
+// The passes that are timed, each uses two queries (begin and end) per-frame in flight.
+enum class GpuScope : uint32_t {
+	WindField,	// Wind field compute dispatch.
+	Culling,	// Blade simulation and culling compute dispatch.
+	Terrain,	// Terrain draw.
+	Grass,		// Grass draws (both levels of detail).
+	ImGui,		// Dear ImGui draw.
+	Count
+};
+
+// The passes whose pipeline statistics are queried, one query per-frame in flight each.
+enum class GpuStatisticsScope : uint32_t {
+	Culling,	// Blade simulation and culling compute dispatch.
+	Terrain,	// Terrain draw.
+	Grass,		// Grass draws (both levels of detail).
+	Count
+};
+
+// Display names.
+const char* getGpuScopeName(GpuScope scope);
+const char* getGpuStatisticsScopeName(GpuStatisticsScope scope);
+
+// Whether a scope is recorded in the compute command buffer, which runs on the async compute queue when the device has one.
+bool isGpuComputeScope(GpuScope scope);
+bool isGpuComputeStatisticsScope(GpuStatisticsScope scope);
+
+// VK_QUERY_TYPE_PIPELINE_STATISTICS counters of one scope. Tessellation counters stay zero on the instanced strip path.
+struct PipelineStatistics {
+	uint64_t vertexShaderInvocations = 0;
+	uint64_t tessellationControlPatches = 0;
+	uint64_t tessellationEvaluationInvocations = 0;
+	uint64_t clippingInvocations = 0;			// Primitives reaching the clipping stage.
+	uint64_t clippingPrimitives = 0;			// Primitives leaving the clipping stage.
+	uint64_t fragmentShaderInvocations = 0;
+	uint64_t computeShaderInvocations = 0;
+};
+
+// Rolling statistics of one scope, in milliseconds.
+struct GpuScopeStatistics {
+	float average = 0.0f;		// Mean over the history.
+	float p99 = 0.0f;			// 99th percentile over the history.
+	float last = 0.0f;			// The most recently resolved sample.
+	uint32_t numSamples = 0;	// Samples in the history, fewer than kGpuProfilerHistory until it fills.
+};
+
+// Timestamps of one scope from the most recently resolved frame, in nanoseconds on the device's timeline.
+struct GpuScopeTimestamps {
+	uint64_t beginNs = 0;
+	uint64_t endNs = 0;
+	bool valid = false;			// False if the scope was not recorded that frame (ie., the wind field is disabled).
+};
+
+class GpuProfiler {
+public:
+	// Creates one timestamp query pool per-frame in flight. Leaves timing disabled (those calls become no-ops) if either queue cannot write timestamps.
+	// Also creates pipeline statistics query pools if the device supports pipelineStatisticsQuery (enabled in createLogicalDevice), the
+	// tessellation counters are only requested when the tessellation feature is enabled. The compute scopes get a pool of their own with
+	// only the compute counter, as a compute-only queue may not begin queries that count graphics stages.
+	VkResult create(VkPhysicalDevice physicalDevice, VkDevice device, uint32_t graphicsQueueFamily, uint32_t computeQueueFamily, uint32_t framesInFlight,
+		bool tessellation);
+	void destroy();
+
+	// Call once per-frame before any scope, in the compute command buffer. Reads back the results this frame slot recorded framesInFlight
+	// frames ago (without waiting, unfinished results are dropped), then resets the compute scopes' queries.
+	void beginFrame(VkCommandBuffer commandBuffer, uint32_t frameIndex);
+
+	// Resets the graphics scopes' queries, call in the graphics command buffer outside of a render pass. The queues do not wait on each
+	// other before the first draw, so each resets the queries it writes.
+	void beginGraphicsFrame(VkCommandBuffer commandBuffer, uint32_t frameIndex);
+
+	void beginScope(VkCommandBuffer commandBuffer, uint32_t frameIndex, GpuScope scope);
+	void endScope(VkCommandBuffer commandBuffer, uint32_t frameIndex, GpuScope scope);
+
+	// Pipeline statistics scopes must not overlap, and must begin and end within the same subpass.
+	void beginStatistics(VkCommandBuffer commandBuffer, uint32_t frameIndex, GpuStatisticsScope scope);
+	void endStatistics(VkCommandBuffer commandBuffer, uint32_t frameIndex, GpuStatisticsScope scope);
+
+	// Flags a scope as written this frame without recording it, for the scopes of a pre-recorded command buffer that is executed again. Its
+	// queries must still be reset each frame, as beginGraphicsFrame does for the graphics scopes.
+	void markScope(uint32_t frameIndex, GpuScope scope);
+	void markStatistics(uint32_t frameIndex, GpuStatisticsScope scope);
+
+	// Forgets the graphics scopes recorded this frame, for a frame whose graphics commands are never submitted.
+	void clearGraphicsScopes(uint32_t frameIndex);
+
+	GpuScopeStatistics getStatistics(GpuScope scope) const;
+
+	// How long each frame's compute scopes ran alongside the previous frame's graphics scopes, zero while both share a queue. Timestamps from
+	// different queues are compared on the device's single timestamp clock, as the CPU profiler's trace already assumes.
+	GpuScopeStatistics getComputeOverlapStatistics() const;
+	const std::array<GpuScopeTimestamps, static_cast<size_t>(GpuScope::Count)>& getLastTimestamps() const { return lastTimestamps; }
+	bool isEnabled() const { return enabled; }
+
+	// The most recently resolved counters of a scope.
+	const PipelineStatistics& getPipelineStatistics(GpuStatisticsScope scope) const { return lastStatistics[static_cast<size_t>(scope)]; }
+
+	// Per-frame averages of the counters resolved since the last resetPipelineStatisticsTotals, used for the benchmark output.
+	PipelineStatistics getAveragePipelineStatistics(GpuStatisticsScope scope) const;
+	void resetPipelineStatisticsTotals();
+	bool isPipelineStatisticsEnabled() const { return statisticsEnabled; }
+
+private:
+	static constexpr uint32_t kGraphicsPool = 0;
+	static constexpr uint32_t kComputePool = 1;
+	static uint32_t getPoolIndex(GpuScope scope) { return isGpuComputeScope(scope) ? kComputePool : kGraphicsPool; }
+
+	VkResult createStatisticsPools(VkPhysicalDevice physicalDevice, uint32_t framesInFlight, bool tessellation);
+	void resolveFrame(uint32_t frameIndex);
+	void resolveComputeOverlap();
+	void resolveStatistics(uint32_t frameIndex);
+
+	VkDevice device = VK_NULL_HANDLE;
+	std::vector<std::array<VkQueryPool, 2>> queryPools = {};				// Graphics and compute pools per-frame in flight, two queries per-scope.
+	std::vector<std::array<bool, static_cast<size_t>(GpuScope::Count)>> recordedScopes = {};	// Scopes written into each pool since its last reset.
+	std::array<std::vector<float>, static_cast<size_t>(GpuScope::Count)> history = {};		// Ring buffers of scope durations in milliseconds.
+	std::array<uint32_t, static_cast<size_t>(GpuScope::Count)> historyHead = {};
+	std::array<GpuScopeTimestamps, static_cast<size_t>(GpuScope::Count)> lastTimestamps = {};
+	std::array<GpuScopeTimestamps, static_cast<size_t>(GpuScope::Count)> previousTimestamps = {};	// The frame resolved before lastTimestamps.
+	std::vector<float> overlapHistory = {};									// Ring buffer of compute overlap in milliseconds.
+	uint32_t overlapHead = 0;
+	std::vector<std::array<VkQueryPool, static_cast<size_t>(GpuStatisticsScope::Count)>> statisticsPools = {};	// One query per-frame in flight and statistics scope.
+	std::vector<std::array<bool, static_cast<size_t>(GpuStatisticsScope::Count)>> recordedStatistics = {};
+	std::array<PipelineStatistics, static_cast<size_t>(GpuStatisticsScope::Count)> lastStatistics = {};
+	std::array<PipelineStatistics, static_cast<size_t>(GpuStatisticsScope::Count)> statisticsTotals = {};
+	std::array<uint64_t, static_cast<size_t>(GpuStatisticsScope::Count)> numStatisticsTotals = {};
+	std::array<VkQueryPipelineStatisticFlags, static_cast<size_t>(GpuStatisticsScope::Count)> statisticsFlags = {};	// Counters of each scope's pools.
+	double timestampPeriod = 1.0;											// Nanoseconds per-timestamp tick.
+	uint64_t graphicsTimestampMask = ~0ull;									// Valid bits of a timestamp on each queue family.
+	uint64_t computeTimestampMask = ~0ull;
+	bool enabled = false;
+	bool statisticsEnabled = false;
+};
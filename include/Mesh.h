@@ -14,6 +14,7 @@
 class Quad {
 public:
 	MeshTransform generateQuad(glm::vec3 position);
+	MeshTransform generateGrid(glm::vec3 position, uint32_t resolution); // Subdivided quad for when the terrain cannot be tessellated.
 
 	std::vector<Vertex> vertices;
 	std::vector<uint16_t> indices;
@@ -7,7 +7,9 @@
 // ===============================================================================================================================================================================
 
 #include <string>
+#include <compare>
 #include <optional>
+#include <vector>
 
 // ===============================================================================================================================================================================
 
@@ -16,6 +18,8 @@ struct QueueFamilyIndices {
 public:
 	std::optional<uint32_t> graphicsAndComputeFamily;
 	std::optional<uint32_t> presentFamily;
+	std::optional<uint32_t> asyncComputeFamily;		// A queue that can run compute alongside the graphics queue, empty if there is none.
+	uint32_t asyncComputeQueueIndex = 0;			// Index of that queue in its family, 1 when it is a second queue of the graphics family.
 
 	bool isComplete() { return graphicsAndComputeFamily.has_value() && presentFamily.has_value(); }
 };
@@ -32,9 +36,15 @@ inline QueueFamilyIndices findQueueFamilies(VkPhysicalDevice device, VkSurfaceKH
 
 	int i = 0;
 	for (const auto& queueFamily : queueFamilies) {
+		if (indices.isComplete()) {
+			break;
+		}
 
-		VkBool32 presentSupport = false;
-		vkGetPhysicalDeviceSurfaceSupportKHR(device, i, surface, &presentSupport);
+		// Headless runs have no surface, nothing is presented so any family will do and present shares the graphics queue.
+		VkBool32 presentSupport = (surface == VK_NULL_HANDLE);
+		if (surface != VK_NULL_HANDLE) {
+			vkGetPhysicalDeviceSurfaceSupportKHR(device, i, surface, &presentSupport);
+		}
 
 		// Graphics and compute family.
 		if (queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT && queueFamily.queueFlags & VK_QUEUE_COMPUTE_BIT) {
@@ -46,16 +56,107 @@ inline QueueFamilyIndices findQueueFamilies(VkPhysicalDevice device, VkSurfaceKH
 			indices.presentFamily = i;
 		}
 
-		if (indices.isComplete()) {
-			break;
-		}
-
 		i++;
 	}
 
+	// Prefer a dedicated compute family, which usually maps to separate hardware queues, then a second queue of the graphics family.
+	for (uint32_t family = 0; family < queueFamilyCount; ++family) {
+		if ((queueFamilies[family].queueFlags & VK_QUEUE_COMPUTE_BIT) && !(queueFamilies[family].queueFlags & VK_QUEUE_GRAPHICS_BIT)) {
+			indices.asyncComputeFamily = family;
+			indices.asyncComputeQueueIndex = 0;
+			return indices;
+		}
+	}
+	if (indices.graphicsAndComputeFamily.has_value() && queueFamilies[indices.graphicsAndComputeFamily.value()].queueCount > 1) {
+		indices.asyncComputeFamily = indices.graphicsAndComputeFamily;
+		indices.asyncComputeQueueIndex = 1;
+	}
+
 	return indices;
 }
 
+// The way grass blades are turned into geometry, chosen from the capabilities of the physical device.
+enum class GrassRenderPath {
+	Tessellated,	// One patch per-blade, tessellated along its Bézier curve (requires tessellationShader).
+	InstancedStrip	// One triangle strip per-blade, evaluated along its Bézier curve in the vertex shader.
+};
+
+// The pipelines a shader hot reload can rebuild, one per-start-up pipeline task.
+enum class ReloadablePipeline {
+	Model,			// The terrain, tessellated or the pre-subdivided grid depending on the GrassRenderPath.
+	Compute,		// The grass animation and culling pass, rebuilt for the current GrassComputeVariant.
+	WindField,
+	Grass,			// The tessellated grass or the instanced strips depending on the GrassRenderPath.
+	Count
+};
+
+// Wind settings, editable in Dear ImGui and pushed to the wind field compute shader every frame.
+struct WindParameters {
+public:
+	float directionDegrees = 45.0f;	// Direction the wind blows towards, around the Z (up) axis.
+	float strength = 0.5f;			// Constant part of the wind.
+	float gustStrength = 0.35f;		// Noise driven variation on top of the constant wind.
+	float gustFrequency = 0.25f;	// How quickly the gusts evolve and travel across the field.
+	bool enabled = true;			// Off compiles the wind out of the culling pass and skips the wind field pass.
+};
+
+// Sphere colliders fed to the blade simulation every frame, editable in Dear ImGui.
+struct ColliderParameters {
+public:
+	bool cameraCollider = true;				// A ball resting on the ground directly below the camera.
+	float cameraColliderRadius = 1.5f;		// Radius of the camera's ball.
+	int numOrbitingColliders = 0;			// Balls circling the middle of the meadow, for testing many colliders at once.
+	float orbitingColliderRadius = 0.75f;	// Radius of each orbiting ball.
+	float orbitSpeed = 0.25f;				// Radians per-second the orbiting balls travel.
+};
+
+// Scene settings a benchmark sweep varies between configurations, see VulkanApplication::applySceneSettings. Also editable in Dear ImGui.
+struct SceneSettings {
+public:
+	uint32_t numBlades = 0;					// Blades populated and simulated, at most the blade capacity. 0 fills the capacity.
+	bool frustumCulling = true;				// Frustum cull the blades in the compute pass, off draws every blade (the NoCull captures).
+	float minTessellationLevel = 2.0f;		// Grass tessellation level at and beyond tessellationDistance.
+	float maxTessellationLevel = 16.0f;		// Grass tessellation level at the camera.
+	float tessellationDistance = 40.0f;		// Distance over which the level falls from max to min.
+	uint32_t computeWorkgroupSize = 32;		// Blades per work group of the culling pass, selects a GrassComputeVariant.
+	bool windField = true;					// Sample the wind field texture, or evaluate Perlin noise per-blade (the original method).
+};
+
+// A permutation of the grass compute pipeline. Each member is a specialization constant, so a feature that is off is compiled out rather than
+// branched over. Variants are built on first use and cached, see VulkanApplication::getComputePipeline.
+struct GrassComputeVariant {
+public:
+	bool frustumCulling = true;
+	bool wind = true;
+	bool windField = true;					// Sample the wind field texture, or evaluate Perlin noise per-blade. Ignored without wind.
+	uint32_t workgroupSize = 32;			// Blades per work group, a power of two within the device's compute limits.
+
+	auto operator<=>(const GrassComputeVariant&) const = default;
+};
+
+// The state the pre-recorded terrain and grass draws of a frame slot depend on. The slot's secondary command buffers are re-recorded when any
+// of it changes, see VulkanApplication::startSecondaryRecording.
+struct SceneCommandState {
+public:
+	VkPipeline modelPipeline = VK_NULL_HANDLE;	// Replaced by a shader hot reload.
+	VkPipeline grassPipeline = VK_NULL_HANDLE;
+	uint32_t width = 0, height = 0;				// The viewport and scissor, changed by recreating the swapchain.
+	float minTessellationLevel = 0.0f;			// The grass push constants, editable in ImGui.
+	float maxTessellationLevel = 0.0f;
+	float tessellationDistance = 0.0f;
+
+	bool operator==(const SceneCommandState&) const = default;
+};
+
+// The secondary command buffers executed in the render pass, in execution order. Each is recorded on the task pool with a command pool of
+// its own, see VulkanApplication::startSecondaryRecording.
+enum class SecondaryPass : uint32_t {
+	Terrain,	// Terrain draw, re-recorded when the SceneCommandState changes.
+	Grass,		// Grass draws of both levels of detail, re-recorded with the terrain.
+	ImGui,		// Dear ImGui draw, recorded every frame. Not used headless.
+	Count
+};
+
 // Collection of data relevant to the GPU and application to display in Dear ImGui.
 struct GPUData {
 public:
@@ -64,6 +165,39 @@ public:
 	unsigned int versionMajor = 0, versionMinor = 0;
 	unsigned int apiMajor = 0, apiMinor = 0, apiPatch = 0;
 	uint32_t numVisible = 0;
+	uint32_t numSimulated = 0, numSwaying = 0, numStatic = 0;
+};
+
+// RGBA8 pixels of an image file, decoded on a worker thread ahead of the upload.
+struct DecodedImage {
+public:
+	std::vector<unsigned char> pixels = {};
+	int width = 0, height = 0;
+};
+
+// How the start-up pipelines were created, shown in the start-up report.
+struct PipelineCacheReport {
+public:
+	bool warm = false;						// The pipeline cache on disk was valid and loaded, so the driver could skip compiling.
+	std::string status;						// Why the cache on disk was loaded or rejected.
+	size_t loadedBytes = 0;
+	double creationMs = 0.0;				// From queuing the first pipeline to the last one finishing.
+};
+
+// A pipeline rebuilt by a shader hot reload on the task pool, waiting to be swapped in at a frame boundary.
+struct ReloadedPipeline {
+public:
+	ReloadablePipeline pipeline = ReloadablePipeline::Model;
+	VkPipeline handle = VK_NULL_HANDLE;
+	GrassComputeVariant variant = {};		// The variant a reloaded compute pipeline was built for.
+};
+
+// A pipeline replaced by a shader hot reload, destroyed once the frames that may still be using it have completed.
+struct RetiredPipeline {
+public:
+	VkPipeline handle = VK_NULL_HANDLE;
+	uint64_t computeValue = 0;				// The timeline values of the last submits that may have used it.
+	uint64_t graphicsValue = 0;
 };
 
 // Vulkan-style info struct for abstracted buffer creation.
@@ -74,6 +208,7 @@ public:
 	VkMemoryPropertyFlags memProperties;
 	VkBuffer* pBuffer;
 	VkDeviceMemory* pBufferMemory;
+	bool concurrent;					// Shared by the graphics and async compute queue families, without ownership transfers.
 };
 
 // Vulkan-style info struct for abstracted image creation.
@@ -88,4 +223,5 @@ struct ImageCreateInfo {
 	VkMemoryPropertyFlags properties;
 	VkImage* pImage;
 	VkDeviceMemory* pImageMemory;
+	bool concurrent;					// Shared by the graphics and async compute queue families, without ownership transfers.
 };
\ No newline at end of file
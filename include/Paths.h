@@ -0,0 +1,18 @@
+#pragma once
+
+// ===============================================================================================================================================================================
+
+// Locations of the files the application loads at runtime, resolved from the executable so it can be launched from any working directory.
+
+// ===============================================================================================================================================================================
+
+#include <filesystem>
+#include <string>
+
+// ===============================================================================================================================================================================
+
+// The directory holding the running executable. Falls back to the working directory if the platform cannot report it.
+std::filesystem::path getExecutableDirectory();
+
+// A compiled shader, e.g. "grass.vert.spv". The build writes every shader to the shaders directory next to the executable.
+std::string getShaderPath(const std::string& fileName);
@@ -0,0 +1,61 @@
+#pragma once
+
+// ===============================================================================================================================================================================
+
+// Watches the shader source directory for hot reload. A background thread collects the names of shader sources that were written (inotify on
+// Linux, modification times elsewhere), and the render loop takes them at a frame boundary to recompile and rebuild the pipelines using them.
+
+// ===============================================================================================================================================================================
+
+#include <atomic>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+// ===============================================================================================================================================================================
+
+class ShaderWatcher {
+public:
+	ShaderWatcher() = default;
+	~ShaderWatcher() { stop(); }
+
+	ShaderWatcher(const ShaderWatcher&) = delete;
+	ShaderWatcher& operator=(const ShaderWatcher&) = delete;
+
+	// Starts watching directory on a background thread. Returns false if the directory does not exist or cannot be watched.
+	bool start(const std::filesystem::path& directory);
+	void stop();
+
+	// Returns the shader sources written since the last call, e.g. "grass.vert", each once however many times it was written.
+	std::vector<std::string> takeChanges();
+
+	bool isWatching() const { return thread.joinable(); }
+	const std::filesystem::path& getDirectory() const { return directory; }
+
+private:
+	void run();
+	void addChange(const std::string& fileName);
+
+	std::filesystem::path directory = {};
+	std::thread thread;
+	std::atomic<bool> stopping = false;
+	std::mutex mutex;									// Guards changes.
+	std::set<std::string> changes = {};
+	int inotifyFd = -1;									// Linux only.
+	std::map<std::string, std::filesystem::file_time_type> writeTimes = {};	// Other platforms, the last seen write time of each source.
+};
+
+// Whether fileName is a shader stage the build compiles, by its extension.
+bool isShaderSource(const std::string& fileName);
+
+// The shader source directory of the build that produced the executable, empty if it was built without one.
+std::filesystem::path getShaderSourceDirectory();
+
+// Compiles a shader source from the shader source directory to its SPIR-V next to the executable (see getShaderPath), with the compiler the
+// build used. The previous SPIR-V is only replaced on success. Throws with the compiler's exit code on failure, the compiler prints its own
+// diagnostics.
+void compileShader(const std::string& fileName);
@@ -18,6 +18,7 @@ public:
 	std::vector<VkFramebuffer> framebuffers = {};				// A collection of framebuffer objects for each image to define attachments used in rendering images.
 	VkFormat imageFormat = {};									// A reference to the format of the images used by the swapchain. Determines how pixel data is stored and displayed.
 	VkExtent2D extents = {};									// A reference to the dimensions of the images used by the swapchain. Determines the resolution of the images.
+	VkPresentModeKHR presentMode = VK_PRESENT_MODE_FIFO_KHR;	// The present mode chosen for the swapchain, reported with benchmark captures.
 	VkSurfaceCapabilitiesKHR capabilities;
 	std::vector<VkSurfaceFormatKHR> formats;
 	std::vector<VkPresentModeKHR> presentModes;
@@ -34,4 +35,32 @@ public:
 
 		vkDestroySwapchainKHR(device, handle, nullptr);
 	}
+};
+
+// A swapchain replaced by recreateSwapchain, with the depth attachment of its framebuffers. Destroyed once the frames that rendered to it
+// have completed, so a resize never waits for the device to idle.
+struct RetiredSwapchain {
+public:
+	SwapChain swapchain = {};
+	VkImage depthImage = VK_NULL_HANDLE;
+	VkImageView depthImageView = VK_NULL_HANDLE;
+	VkDeviceMemory depthImageMemory = VK_NULL_HANDLE;
+	uint64_t graphicsValue = 0;									// The graphics timeline value after which nothing uses it.
+
+	void destroy(VkDevice device)
+	{
+		swapchain.cleanupSwapchain(device);
+		vkDestroyImageView(device, depthImageView, nullptr);
+		vkDestroyImage(device, depthImage, nullptr);
+		vkFreeMemory(device, depthImageMemory, nullptr);
+	}
+};
+
+// CPU time spent in recreateSwapchain, the stall a resize adds to its frame, in milliseconds.
+struct SwapchainRecreationStats {
+public:
+	uint32_t count = 0;
+	double lastMs = 0.0;
+	double totalMs = 0.0;
+	double maxMs = 0.0;
 };
\ No newline at end of file
@@ -0,0 +1,60 @@
+#pragma once
+
+// ===============================================================================================================================================================================
+
+// A fixed pool of worker threads running submitted tasks in FIFO order, used to overlap independent initialisation work.
+
+// ===============================================================================================================================================================================
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#include <cstdint>
+
+// ===============================================================================================================================================================================
+
+class TaskPool {
+public:
+	// Starts numThreads workers, or one fewer than the hardware threads (at least kTaskPoolMinThreads) when 0.
+	TaskPool() : TaskPool(0) {}
+	explicit TaskPool(uint32_t numThreads);
+
+	// Runs the tasks still queued, then joins the workers.
+	~TaskPool();
+
+	TaskPool(const TaskPool&) = delete;
+	TaskPool& operator=(const TaskPool&) = delete;
+
+	// Queues task and returns a future of its result. Exceptions thrown by the task are rethrown by the future's get(). Tasks must not wait
+	// on other tasks of the pool, a pool with every worker waiting cannot make progress.
+	template<typename Task>
+	std::future<std::invoke_result_t<Task>> submit(Task&& task)
+	{
+		using Result = std::invoke_result_t<Task>;
+		std::shared_ptr<std::packaged_task<Result()>> packagedTask = std::make_shared<std::packaged_task<Result()>>(std::forward<Task>(task));
+		std::future<Result> result = packagedTask->get_future();
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			tasks.emplace_back([packagedTask]() { (*packagedTask)(); });
+		}
+		condition.notify_one();
+		return result;
+	}
+
+	uint32_t getNumThreads() const { return static_cast<uint32_t>(workers.size()); }
+
+private:
+	void runWorker(uint32_t index);
+
+	std::vector<std::thread> workers = {};
+	std::deque<std::function<void()>> tasks = {};
+	std::mutex mutex;						// Guards tasks and stopping.
+	std::condition_variable condition;		// Signalled when a task is queued or the pool stops.
+	bool stopping = false;
+};
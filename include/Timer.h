@@ -2,11 +2,12 @@
 
 // ===============================================================================================================================================================================
 
-// For use in internally calculating delta time for the application update.
+// For use in internally calculating delta time for the application update, and pacing the application loop to a frame limit.
 
 // ===============================================================================================================================================================================
 
 #include <chrono>
+#include <thread>
 
 // ===============================================================================================================================================================================
 
@@ -25,4 +26,42 @@ public:
 
 private:
     std::chrono::high_resolution_clock::time_point lastTime;
-};
\ No newline at end of file
+};
+
+// Paces the application loop to a frame rate. Sleeps until shortly before each deadline, then spins the rest, as a sleep can overshoot by a
+// scheduler tick.
+class FrameLimiter {
+public:
+    // Blocks until the next frame is due, returns immediately when fps is 0. Deadlines advance by whole periods so the rate holds on average,
+    // and restart from now after the rate changes or a frame overruns its deadline by more than a period.
+    void wait(float fps) {
+        if (fps <= 0.0f) {
+            pacing = false;
+            return;
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        auto framePeriod = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(1.0 / fps));
+        if (!pacing || framePeriod != period || now > deadline + framePeriod) {
+            pacing = true;
+            period = framePeriod;
+            deadline = now;
+            return;
+        }
+
+        deadline += period;
+        if (deadline - now > spinTime) {
+            std::this_thread::sleep_until(deadline - spinTime);
+        }
+        while (std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::yield();
+        }
+    }
+
+private:
+    static constexpr std::chrono::microseconds spinTime = std::chrono::microseconds(1000);
+
+    bool pacing = false;
+    std::chrono::steady_clock::duration period = {};
+    std::chrono::steady_clock::time_point deadline = {};
+};
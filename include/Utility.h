@@ -47,7 +47,7 @@ namespace Utils {
 	static std::vector<char> readFile(const std::string& filename) {
 		std::ifstream file(filename, std::ios::ate | std::ios::binary);
 		if (!file.is_open()) {
-			throw std::runtime_error("failed to open file!");
+			throw std::runtime_error("failed to open file " + filename);
 		}
 		size_t fileSize = (size_t)file.tellg();
 		std::vector<char> buffer(fileSize);
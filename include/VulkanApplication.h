@@ -6,13 +6,17 @@
 
 // ===============================================================================================================================================================================
 
+#if defined(_WIN32)
 #define VK_USE_PLATFORM_WIN32_KHR
+#endif
 #include <vulkan/vulkan.h>
 
 #define GLFW_INCLUDE_VULKAN
 #include <GLFW/glfw3.h>
+#if defined(_WIN32)
 #define GLFW_EXPOSE_NATIVE_WIN32
 #include <GLFW/glfw3native.h>
+#endif
 
 #define GLM_FORCE_DEPTH_ZERO_TO_ONE
 #include <glm/glm.hpp> 
@@ -30,9 +34,21 @@
 #include "Camera.h"
 #include "MiscStructs.h"
 #include "Constants.h"
+#include "BladeSimulation.h"
+#include "ColliderGrid.h"
+#include "GpuProfiler.h"
+#include "FrameStats.h"
+#include "TaskPool.h"
+#include "ShaderWatcher.h"
  
 // STL.
+#include <array>
+#include <chrono>
+#include <future>
+#include <map>
 #include <optional>
+#include <set>
+#include <string>
 #include <vector>
 
 // ===============================================================================================================================================================================
@@ -46,9 +62,27 @@ public:
 	// Set-up/preparation.
 	void linkWindowToVulkan(GLFWwindow* window);	// Link the global window to the Vulkan application.
 	void linkCameraToVulkan(Camera* camera);		// Link the global camera to the Vulkan application.
+	void enableHeadless(uint32_t width, uint32_t height);	// Render offscreen without a window, surface, swapchain, or ImGui. Call before initialisation.
+	void setBladeCapacity(uint32_t capacity);		// Size the blade buffers for capacity blades instead of kMaxBlades. Call before initialisation.
+	void setLoadPipelineCache(bool load);			// Ignore the pipeline cache on disk to time a cold start, it is still saved. Call before initialisation.
+	void setFramesInFlight(uint32_t count);			// Frames the CPU may record ahead of the GPU, 1 to kMaxFramesInFlight. Call before initialisation.
+	void setAsyncCompute(bool enable);			// Cull on a queue of its own when the device has one, overlapping the previous frame's draws. Call before initialisation.
+	void setDynamicRendering(bool enable);		// Render with vkCmdBeginRendering when the device supports it, rather than a render pass. Call before initialisation.
+	void setPresentMode(VkPresentModeKHR mode);	// Preferred present mode, see chooseSwapPresentMode. Once running, the swapchain is recreated after the next present.
+	void setSwapchainImageCount(uint32_t count);	// Swapchain images to request, 0 for one more than the surface minimum. Once running, recreates the swapchain as above.
+	void setFrameLimit(float fps);				// Frame rate the main loop paces itself to, 0 for no limit.
+	float getFrameLimit() const { return frameLimit; }
+	void setInputTimestamp(uint64_t ns);		// CpuProfiler::now() when this frame's input was polled, the start of the input-to-present latency.
 	VkResult initialiseApplication();				// Set up all Vulkan and application specific structures.
 	void prepareImGuiDrawData();					// Dear ImGui draw data commands for later rendering.
 
+	// Benchmarking.
+	FrameStatsMetadata getFrameStatsMetadata() const;		// Describes the build, device, blade count, resolution, and present mode.
+	FrameStatsSample getFrameStatsSample(double cpuMs) const;	// Latest GPU pass times, visible blades, and camera pose alongside a CPU frame time.
+	PipelineCacheReport getPipelineCacheReport() const { return pipelineCacheReport; }	// Whether start-up pipeline creation was cold or warm, and how long it took.
+	SwapchainRecreationStats getSwapchainRecreationStats() const { return swapchainRecreationStats; }	// How long resizes stalled the frames that recreated the swapchain.
+	void applySceneSettings(const SceneSettings& settings);	// Repopulates the blades if their count changed, then switches culling and tessellation.
+
 	// Release memory allocations.
 	void cleanupApplication(GLFWwindow* window);
 private:
@@ -59,21 +93,30 @@ private:
 	VkResult createLogicalDevice();									//			 |
 	VkResult createGlfwSurface();									//			 |
 	VkResult createSwapchain();										//			 |
+	VkResult createOffscreenTargets();								//			 |
 	VkResult recreateSwapchain();									//			 |
 	VkResult createSwapchainImageViews();							//			 |
 	VkResult createRenderPass();									//			 |
 	VkResult createDescriptorSetLayouts();							//			 |
 	VkResult createModelDescriptorSetLayout();						//			 |
 	VkResult createGrassDescriptorSetLayout();						//			 |
+	VkResult createWindFieldDescriptorSetLayout();					//			 |
 	VkResult createDepthResources();								//			 | 
 	VkResult createTextureResources();								//			 |
 	VkResult createHeightMapImage();								//			 |
 	VkResult createHeightMapImageView();							//			 |
 	VkResult createHeightMapSampler();								//			 |
+	VkResult createWindFieldImage();								//			 |
+	void startInitialisationTasks();								//			 |
+	VkResult createPipelineCache();									//			 |
 	VkResult createPipelines();										//			 | 
-	VkResult createMeshPipeline();									//			 |
+	VkResult waitForPipelines();									//			 |
+	VkResult createMeshPipeline(VkPipeline& pipeline);			//			 |
+	VkResult createMeshGridPipeline(VkPipeline& pipeline);		//			 |
 	VkResult createComputePipeline();								//			 |
-	VkResult createGrassPipeline();									//			 | ---> Vulkan application initialisation.
+	VkResult createWindFieldPipeline(VkPipeline& pipeline);		//			 |
+	VkResult createGrassPipeline(VkPipeline& pipeline);			//			 | ---> Vulkan application initialisation.
+	VkResult createGrassStripPipeline(VkPipeline& pipeline);	//			 |
 	VkResult createFrameBuffers();									//			 |
 	VkResult createCommandPool();									//			 |
 	void createMeshObjects();										//			 |
@@ -82,12 +125,14 @@ private:
 	VkResult createVertexBuffer();									//			 |
 	VkResult createIndexBuffer();									//			 |
 	VkResult createUniformBuffers();								//			 |
+	VkResult createColliderBuffers();								//			 |
 	VkResult createDescriptorPool();								//			 |
 	void createNumBladesBuffer();									//			 |
 	VkResult createDescriptorSets();								//			 |
 	void createBladeInstanceStagingBuffer();						//			 |
 	VkResult createModelDescriptorSets();							//			 |
 	VkResult createGrassDescriptorSets();							//			 |
+	VkResult createWindFieldDescriptorSets();						//			 |
 	VkResult createCommandBuffers();								//			 |
 	VkResult createGraphicsCommandBuffer();							//			 |
 	VkResult createComputeCommandBuffer();							//			 |
@@ -95,11 +140,37 @@ private:
 	VkResult createDefaultCamera();									//			 |
 	VkResult createImGuiImplementation();							// - - - - - '
 
-	// Updates the uniform buffer object that is bound to both the model and grass pipeline, so they receive the most recent data (re-maps the memory).
+	// Writes the pipeline cache data behind a header identifying the device and driver, so the next launch can reuse the compiled pipelines.
+	void savePipelineCache();
+
+	// The SPIR-V of a shader, read ahead by startInitialisationTasks when it was queued there, from disk otherwise. Safe on any thread.
+	std::vector<char> getShaderCode(const std::string& fileName) const;
+
+	// Updates currentFrame's uniform buffer object, bound to both the model and grass pipeline, so they receive the most recent data (persistently mapped).
 	void updateUniformBuffer(uint32_t currentFrame);
 
-	// Map the memory from the num blades buffer to determine number of grass blades to draw.
-	uint32_t retrieveNumVisibleBlades();
+	// Seconds since initialisation, used instead of glfwGetTime() as headless runs never initialise glfw.
+	double getElapsedTime() const;
+
+	// Copies localBladeInstanceBuffer into every blade state buffer through the staging buffers.
+	void uploadBladeInstances();
+
+	// Gathers this frame's colliders and bins them into the collider buffer for currentFrame (persistently mapped).
+	void updateColliderBuffer(uint32_t currentFrame);
+
+	// Reads currentFrame's num blades buffer for the blade counts shown in ImGui. The draws read it on the GPU, so this is only called once the
+	// frame slot's last frame has completed and its counts lag by the frames in flight.
+	NumBladesBufferObject retrieveNumVisibleBlades();
+
+	// Blocks until the last frame recorded in currentFrame's slot has finished on both queues, the only point the CPU waits on the GPU.
+	void waitForFrameSlot();
+
+	// Submits currentFrame's graphics command buffer behind its compute pass and signals the next graphics timeline value. Windowed runs also
+	// wait for the acquired swapchain image and signal present, headless runs pass VK_NULL_HANDLE for both.
+	void submitGraphicsCommandBuffer(VkSemaphore imageAvailable, VkSemaphore renderFinished);
+
+	// Reads back a sample of the last simulated blade states and the wind field, and compares them against the CPU reference integrator.
+	void validateBladeSimulation();
 
 	// Creates a buffer, creates its memory requirements, and allocates and binds the buffer memory. Returns a VkResult.
 	VkResult createBuffer(BufferCreateInfo& bufferCreateInfo);
@@ -110,12 +181,51 @@ private:
 	// Copy from srcBuffer to dstBuffer passing the size of srcBuffer so the command knows how much data to copy. Performs vkCmdCopyBuffer.
 	void copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size);
 
-	// Bind pipelines and populate the command buffer with commands (i.e., vkCmdDraw) for the graphics pipeline.
+	// Begins the render pass, or dynamic rendering, and executes the frame slot's secondary command buffers in it once
+	// startSecondaryRecording's tasks have finished. Only this primary and the ImGui draw are recorded every frame.
 	void recordCommandBuffer(VkCommandBuffer commandBuffer, uint32_t imageIndex);
 
+	// Transition the acquired image and the depth attachment as the render pass would, and begin rendering to them. endDynamicRendering
+	// leaves the image ready to present, or to read back when headless.
+	void beginDynamicRendering(VkCommandBuffer commandBuffer, uint32_t imageIndex, const std::array<VkClearValue, 2>& clearValues);
+	void endDynamicRendering(VkCommandBuffer commandBuffer, uint32_t imageIndex);
+
+	// Queues the recording of currentFrame's secondary command buffers on the task pool, so they are recorded in parallel with each other and
+	// with the compute submit and image acquire: the terrain and grass draws unless they were already recorded with the current
+	// SceneCommandState, and the ImGui draw. The draws are indirect from buffers owned by the frame slot, so nothing else they record changes
+	// between frames. Call after recording the compute command buffer, which resets the GPU profiler's scopes for the frame.
+	void startSecondaryRecording();
+
+	// Waits for the recordings queued by startSecondaryRecording, rethrowing their errors.
+	void waitForSecondaryRecording();
+
+	// Records one pass of a frame slot into its secondary command buffer. Safe on any thread, as long as no other thread records the same pass.
+	void recordSecondaryCommandBuffer(SecondaryPass pass, uint32_t frame);
+	void recordTerrainCommands(VkCommandBuffer commandBuffer, uint32_t frame);
+	void recordGrassCommands(VkCommandBuffer commandBuffer, uint32_t frame);
+	void recordImGuiCommands(VkCommandBuffer commandBuffer, uint32_t frame);
+	SceneCommandState getSceneCommandState() const;
+
 	// Bind pipelines and populate the command buffer with commands (i.e., vkCmdDispatch) for the compute pipeline.
 	void recordComputeCommandBuffer(VkCommandBuffer commandBuffer);
 
+	// The grass compute variant selected by the current scene and wind settings.
+	GrassComputeVariant getComputeVariant() const;
+
+	// Returns the grass compute pipeline for a variant, building it through the pipeline cache on first use. Throws if the workgroup size is
+	// not a power of two within the device's compute limits.
+	VkPipeline getComputePipeline(const GrassComputeVariant& variant);
+
+	// Builds the grass compute pipeline for a variant without caching it, so a shader hot reload can build one on the task pool.
+	VkPipeline createComputePipelineVariant(const GrassComputeVariant& variant);
+
+	// Run at the start of every frame. Destroys the retired pipelines whose frames have completed, swaps in the pipelines of a finished
+	// reload, and queues a reload of the shader sources edited since: recompiled and rebuilt on the task pool, so the frame never waits.
+	void updateShaderHotReload();
+
+	// Destroys the swapchains replaced by recreateSwapchain whose frames have completed on the graphics timeline.
+	void updateRetiredSwapchains();
+
 	// Reads a SPIR-V code file and turns it into a handle that can be bound to a VkPipeline.
 	VkShaderModule createShaderModule(const std::vector<char>& code);
 
@@ -128,7 +238,7 @@ private:
 	// Determine the best supported format for the swapchain images.
 	VkSurfaceFormatKHR chooseSwapchainSurfaceFormat(const std::vector<VkSurfaceFormatKHR>& availableFormats);
 
-	// Determine the best supported present mode for the swapchain.
+	// The requested present mode if supported, otherwise the nearest mode that is, see setPresentMode.
 	VkPresentModeKHR chooseSwapPresentMode(const std::vector<VkPresentModeKHR>& availablePresentModes);
 
 	// Determine the best extents for the swapchain.
@@ -167,6 +277,15 @@ private:
 	// Determine if the physical device features meet certain application expectations.
 	bool checkPhysicalDeviceSuitability(VkPhysicalDevice device);
 
+	// Determine if the physical device can run the tessellated terrain and grass pipelines.
+	bool checkPhysicalDeviceTessellationSupport(VkPhysicalDevice device);
+
+	// Determine if the physical device supports Vulkan 1.2 timeline semaphores, which pace the frames in flight.
+	bool checkPhysicalDeviceTimelineSemaphoreSupport(VkPhysicalDevice device);
+
+	// Determine if the physical device supports Vulkan 1.3 dynamic rendering, which replaces the render pass and framebuffers.
+	bool checkPhysicalDeviceDynamicRenderingSupport(VkPhysicalDevice device);
+
 	// Determine what device extensions the application can support.
 	bool checkPhysicalDeviceExtensionSupport(VkPhysicalDevice device);
 public:
@@ -181,6 +300,17 @@ public:
 	// Window.
 	GLFWwindow* window = nullptr;										// Glfw window pointer to keep track of the window for use in the swapchain.
 	VkSurfaceKHR m_SurfaceKHR = VK_NULL_HANDLE;							// A handle to the area on screen that rendering can occur, connects Vulkan and the windowing system.
+	bool headless = false;												// Render into offscreen images (swapchainData.images) instead of a swapchain, see enableHeadless.
+	VkExtent2D headlessExtent = {};										// Resolution of the offscreen images.
+	std::vector<VkDeviceMemory> offscreenImageMemory = {};				// Memory of the offscreen images, one per-frame in flight.
+	std::vector<RetiredSwapchain> retiredSwapchains = {};				// Swapchains replaced by a resize, destroyed by updateRetiredSwapchains.
+	SwapchainRecreationStats swapchainRecreationStats = {};				// Timings of recreateSwapchain, shown in ImGui and reported by --resize-test.
+	VkPresentModeKHR requestedPresentMode = VK_PRESENT_MODE_MAILBOX_KHR;	// Preferred by chooseSwapPresentMode, see setPresentMode.
+	uint32_t requestedImageCount = 0;									// Swapchain images asked for by setSwapchainImageCount, 0 for automatic.
+	float frameLimit = 0.0f;											// Frame rate cap applied by the main loop, 0 when unlimited.
+	uint64_t inputTimestampNs = 0;										// When this frame's input was polled, 0 once its present has been timed.
+	float lastInputToPresentMs = 0.0f;									// CPU time from polling input to queueing the present, and its moving average.
+	float averageInputToPresentMs = 0.0f;
 
 	// GPU features & properties.
 	VkPhysicalDeviceProperties deviceProperties = {};					// A structure describing key GPU driver information (ie., driver name, driver version), including a collection of limitations.
@@ -190,55 +320,93 @@ public:
 	VkQueue computeQueue = VK_NULL_HANDLE;								// Queues compute shader commands for general-purpose computations.
 	VkQueue graphicsQueue = VK_NULL_HANDLE;								// Queues graphics rendering commands for processing graphics shaders.
 	VkQueue presentQueue = VK_NULL_HANDLE;								// Manages the commands for presenting the swapchain images to the screen.
+	uint32_t graphicsQueueFamily = 0;									// Family of the graphics queue, also used by the compute queue without async compute.
+	uint32_t computeQueueFamily = 0;									// Family of the compute queue, see asyncCompute.
+	bool asyncCompute = true;											// Requested by setAsyncCompute, cleared by createLogicalDevice if the device has no queue to spare.
 
 	// Commands.
 	VkCommandPool commandPool = VK_NULL_HANDLE;							// A handle to the manager that allocates command buffers to increase memory efficiency.
 	std::vector<VkCommandBuffer> commandBuffers = {};					// A collection of command buffers, each buffer contains a list of GPU commands to be executed.
 	std::vector<VkCommandBuffer> computeCommandBuffers = {};			// A collection of command buffers, each buffer contains a list of GPU commands to be executed specifically for compute shaders.
+	VkCommandPool computeCommandPool = VK_NULL_HANDLE;					// Allocates the compute command buffers, for the compute queue's family.
+	std::array<VkCommandPool, static_cast<size_t>(SecondaryPass::Count)> secondaryCommandPools = {};	// One per-pass, a command pool may only be used by one thread at a time.
+	std::array<std::vector<VkCommandBuffer>, static_cast<size_t>(SecondaryPass::Count)> secondaryCommandBuffers = {};	// Per-pass, one per-frame in flight.
+	std::vector<std::future<void>> secondaryRecordingTasks = {};		// The recordings queued by startSecondaryRecording this frame.
+	std::array<SceneCommandState, kMaxFramesInFlight> recordedSceneStates = {};	// The state each scene command buffer was last recorded with.
+	uint32_t sceneCommandRecordings = 0;								// Terrain and grass recordings so far, shown in ImGui.
 
 	// Render passes and pipelines.
 	VkRenderPass renderPass = VK_NULL_HANDLE;							// Defines how rendering operations are performed and how framebuffers are used during rendering.
+	bool dynamicRendering = true;										// Requested by setDynamicRendering, cleared by createLogicalDevice if the device or the ImGui backend cannot.
+	VkPipelineRenderingCreateInfo pipelineRenderingInfo = {};			// The attachment formats the pipelines and secondary command buffers render to, in place of renderPass.
 	VkPipelineLayout modelPipelineLayout = VK_NULL_HANDLE;				// A pipeline configuration for the rendering of models/meshes.
 	VkPipelineLayout grassPipelineLayout = VK_NULL_HANDLE;				// A pipeline configuration for the rendering of grass blades.
 	VkPipelineLayout computePipelineLayout = VK_NULL_HANDLE;			// A pipeline configuration for the culling and animation of grass blades.
 	VkPipeline modelPipeline = VK_NULL_HANDLE;							// A pipeline structure for a model/mesh render pass.
 	VkPipeline grassPipeline = VK_NULL_HANDLE;							// A pipeline structure for the grass blade render pass.
-	VkPipeline computePipeline = VK_NULL_HANDLE;						// A pipeline structure for the grass animation and culling pass.
+	std::map<GrassComputeVariant, VkPipeline> computePipelineVariants;	// Pipelines for the grass animation and culling pass, one per-variant built so far.
+	VkPipelineLayout windFieldPipelineLayout = VK_NULL_HANDLE;			// A pipeline configuration for the wind field update.
+	VkPipeline windFieldPipeline = VK_NULL_HANDLE;						// A pipeline structure for the wind field update pass, run before the grass animation and culling pass.
+	VkPipelineCache pipelineCache = VK_NULL_HANDLE;						// Shared by every pipeline, loaded from and saved to disk so warm launches skip shader compilation.
+	bool loadPipelineCache = true;										// Whether createPipelineCache reads the cache on disk, see setLoadPipelineCache.
+	PipelineCacheReport pipelineCacheReport = {};						// Cold or warm start-up pipeline creation, timed by createPipelines and waitForPipelines.
+	std::chrono::steady_clock::time_point pipelineCreationStart = {};	// When createPipelines queued the first pipeline.
+
+	// Shader hot reload.
+	ShaderWatcher shaderWatcher;										// Watches the shader sources in windowed runs, see updateShaderHotReload.
+	std::set<std::string> pendingShaderChanges = {};					// Edited sources queued behind the reload in flight.
+	std::future<std::vector<ReloadedPipeline>> shaderReloadTask;		// Recompiles the edited sources and builds their pipelines on the task pool.
+	std::vector<RetiredPipeline> retiredPipelines = {};					// Pipelines replaced by a reload, destroyed once the frames using them complete.
+	std::string shaderReloadStatus;										// The outcome of the last reload, shown in Dear ImGui.
 		
 	// Synchronisation.
 	std::vector<VkSemaphore> imageAvailableSemaphores = {};				// Per-frame synchronisation used for signalling when swapchain images are available for rendering.
 	std::vector<VkSemaphore> renderFinishedSemaphores = {};				// Per-frame synchronisation used for signalling when rendering to an image is completed allowing safe image presentation to the screen.
-	std::vector<VkFence> inFlightFences = {};							// Per-frame synchronisation used for signalling when a frame's rendering has completed allowing the GPU tasks to complete.
-	std::vector<VkFence> computeInFlightFences = {};
-	std::vector<VkSemaphore> computeFinishedSemaphores = {};
+	VkSemaphore computeTimeline = VK_NULL_HANDLE;						// Timeline semaphore signalled with computeTimelineValue by each compute submit, waited on by the draw.
+	VkSemaphore graphicsTimeline = VK_NULL_HANDLE;						// Timeline semaphore signalled with graphicsTimelineValue by each graphics submit.
+	uint64_t computeTimelineValue = 0;									// The last value signalled on each queue's timeline, incremented per-submit.
+	uint64_t graphicsTimelineValue = 0;
+	std::array<uint64_t, kMaxFramesInFlight> frameComputeValues = {};	// The timeline values each frame slot last signalled, waited on before the slot is reused.
+	std::array<uint64_t, kMaxFramesInFlight> frameGraphicsValues = {};
+	uint32_t framesInFlight = kDefaultFramesInFlight;					// Frame slots in use, see setFramesInFlight.
 
 	// Descriptors.
 	VkDescriptorPool descriptorPool = VK_NULL_HANDLE;					// A handle to the manager that allocates descriptor sets to increase correct resource allocation.
 	VkDescriptorPool imguiDescriptorPool = VK_NULL_HANDLE;				// A handle to the manager that allocates descriptor sets specifically for ImGui resources necessary for rendering its interface.
 	VkDescriptorSetLayout modelDescriptorSetLayout = VK_NULL_HANDLE;	// A layout that determines what shader resources can later be bound for this pipeline. Contains UBO for models (ie plane).
 	VkDescriptorSetLayout grassDescriptorSetLayout = VK_NULL_HANDLE;	// A layout that determines what shader resources can later be bound for this pipeline. Contains SSBO for grass instance buffer.
-	VkDescriptorSet modelPipelineDescriptorSet = VK_NULL_HANDLE;		// Descriptor set (one shader resource) that is bound to shaders within the model pipeline.
-	VkDescriptorSet grassPipelineDescriptorSet;							// Descriptor set (two shader resources) that is bound to shaders within the grass pipeline. 
+	std::vector<VkDescriptorSet> modelPipelineDescriptorSets = {};		// Descriptor sets bound to shaders within the model pipeline, one per-frame for the uniform buffers.
+	std::vector<VkDescriptorSet> grassPipelineDescriptorSets = {};		// Descriptor sets bound to shaders within the grass pipeline, one per-frame so the blade state buffers ping-pong.
+	VkDescriptorSetLayout windFieldDescriptorSetLayout = VK_NULL_HANDLE;	// A layout that determines what shader resources can later be bound for this pipeline. Contains the wind field storage image.
+	VkDescriptorSet windFieldPipelineDescriptorSet = VK_NULL_HANDLE;	// Descriptor set (one shader resource) that is bound to the wind field compute shader.
 
 	// Buffers.
 	std::vector<VkBuffer> bladeInstanceStagingBuffer = {};				// A temporary holding buffer containing the blade data ready for CPU > GPU copy.
 	std::vector<VkBuffer> bladeInstanceDataBuffer;						// The shader resources containing all grass blade data.
-	VkBuffer uniformBuffer = VK_NULL_HANDLE;							// The buffer object containing, most notably, the camera's view and projection matrices.
+	std::vector<VkBuffer> uniformBuffers = {};							// The buffer objects containing, most notably, the camera's view and projection matrices, one per-frame.
 	VkBuffer quadVertexBuffer = VK_NULL_HANDLE;							// The vertex buffer for this mesh.
 	VkBuffer quadIndexBuffer = VK_NULL_HANDLE;							// The index buffer for this mesh.
 	VkBuffer bladeShapeVertexBuffer = VK_NULL_HANDLE;					// The vertex buffer for this mesh.
 	VkBuffer bladeShapeIndexBuffer = VK_NULL_HANDLE;					// The index buffer for this mesh.
-	VkBuffer numBladesBuffer = VK_NULL_HANDLE;							// A buffer for determining how many blades to draw.
+	std::vector<VkBuffer> numBladesBuffers = {};						// The indirect draws and blade counts written by culling, one per-frame.
+	std::vector<VkBuffer> visibleBladeInstanceDataBuffers = {};			// The compacted blades that survived culling, read by the grass draw. One per-frame with async compute, else one shared.
+	std::vector<VkBuffer> trampleBuffer = {};							// Per-blade trample amounts, ping-ponged per-frame like the blade state.
+	std::vector<VkBuffer> colliderBuffer = {};							// Binned sphere colliders, one host visible buffer per-frame.
 	std::vector<VkDeviceMemory> bladeInstanceStagingBufferMemory = {};	// Allocated memory for the holding buffer used to copy blade data to the GPU.
 	std::vector<VkDeviceMemory> bladeInstanceDataBufferMemory;			// Allocated memory for the shader resources.
-	VkDeviceMemory uniformBufferMemory = VK_NULL_HANDLE;				// Allocated memory for this buffer object.
+	std::vector<VkDeviceMemory> uniformBufferMemory = {};				// Allocated memory for the uniform buffers.
 	VkDeviceMemory quadVertexBufferMemory = VK_NULL_HANDLE;				// The memory corresponding to the vertex buffer.
 	VkDeviceMemory quadIndexBufferMemory = VK_NULL_HANDLE;				// The memory corresponding to the index buffer.
 	VkDeviceMemory bladeShapeVertexBufferMemory = VK_NULL_HANDLE;		// The memory corresponding to the vertex buffer.
 	VkDeviceMemory bladeShapeIndexBufferMemory = VK_NULL_HANDLE;		// The memory corresponding to the index buffer.
-	VkDeviceMemory numBladesBufferMemory = VK_NULL_HANDLE;				// The memory corresponding to the num blades buffer.
-	void* uniformBufferMapped = nullptr;								// A handle to map data to the buffer.
+	std::vector<VkDeviceMemory> numBladesBufferMemory = {};				// The memory corresponding to the num blades buffers.
+	std::vector<VkDeviceMemory> visibleBladeInstanceDataBufferMemory = {};	// The memory corresponding to the visible blades buffers.
+	std::vector<VkDeviceMemory> trampleBufferMemory = {};				// The memory corresponding to the trample buffers.
+	std::vector<VkDeviceMemory> colliderBufferMemory = {};				// The memory corresponding to the collider buffers.
+	std::vector<void*> uniformBufferMapped = {};						// Persistent mappings of the uniform buffers.
+	std::vector<void*> numBladesBufferMapped = {};						// Persistent mappings of the num blades buffers.
 	std::vector<void*> bladeInstanceDataBufferMapped;					// Handles to map data to the buffer.	
+	std::vector<void*> colliderBufferMapped = {};						// Persistent mappings of the collider buffers.
 
 	// Images.
 	VkImage heightMapImage = VK_NULL_HANDLE;							// A handle to the image that represents the height map.
@@ -247,19 +415,43 @@ public:
 	VkImageView depthImageView = VK_NULL_HANDLE;						// A handle to the actual image data for the depth stencil.
 	VkDeviceMemory heightMapImageMemory = VK_NULL_HANDLE;				// Allocated memory for this image resource.
 	VkDeviceMemory depthImageMemory = VK_NULL_HANDLE;					// Allocated memory for this image resource.
+	VkImage windFieldImage = VK_NULL_HANDLE;							// A handle to the image that stores the wind vector field, kept in VK_IMAGE_LAYOUT_GENERAL.
+	VkImageView windFieldImageView = VK_NULL_HANDLE;					// A handle to the actual image data for the wind field.
+	VkDeviceMemory windFieldImageMemory = VK_NULL_HANDLE;				// Allocated memory for this image resource.
 	
 	// Miscellaneous.
 	float lastFrameTime = 0.0f;											// Used to calculate FPS.
 	float deltaTime = 0.0f;												// Used to smooth out update logic.
 	double lastTime = 0.0f;												// Used to calculated lastFrameTime.
 	GPUData driverData = {};											// A custom collection of GPU data to be displayed easily in ImGui.
+	GrassRenderPath grassRenderPath = GrassRenderPath::Tessellated;		// Tessellated or instanced strip grass, chosen from the physical device features.
+	uint32_t bladeCapacity = kMaxBlades;								// Number of blades the blade buffers are sized for, see setBladeCapacity.
+	SceneSettings sceneSettings = {};									// Blade count, culling, and tessellation, see applySceneSettings.
 	uint32_t currentFrame = 0;											// A reference to the current frame in a double-buffered setup, helps manage which framebuffer is currently being used for rendering.
 	bool framebufferResized = false;									// A flag to determine if the swapchain should be recreated to accomodate new window dimensions.
 	int frameCount = 0;													// Determines the number of frames passed since start-up.
+	std::chrono::steady_clock::time_point startTime = {};				// Set at initialisation, the origin of getElapsedTime.
 	Camera* camera = nullptr;											// A handle to a dynamic camera that works with WASDEQ, arrow keys, LJ, and RTY. 
 	Quad quadMesh;														// One-time data structure containing vertex and index data for this mesh.
 	BaseBladeShape bladeShapeMesh;										// One-time data structure containing vertex and index data for this mesh.
 	MeshTransform groundPlane;											// A handle to the ground plane transform.
 	std::vector<GrassBladeInstanceData> localBladeInstanceBuffer = {};	// A CPU buffer of instance data per-blade, populates the staging buffer, which populates the SSBO. 
 	VkSampler heightMapSampler = VK_NULL_HANDLE;						// Sampler for use in sampling the height map to displace the terrain.
+	WindParameters windParameters = {};									// Wind direction, strength, and gusts, editable in ImGui.
+	BladeSimulationParameters simulationParameters = {};				// Gravity and wind force applied to the blades, editable in ImGui.
+	BladeSimulationParameters lastSimulationParameters = {};			// The exact parameters (including the clamped time step) pushed by the last compute dispatch.
+	int lastSimulatedFrame = -1;										// The frame slot whose state buffer holds the newest simulated blades, -1 before the first dispatch.
+	BladeSimulationValidation simulationValidation = {};				// Results of the last GPU against CPU reference comparison.
+	bool hasSimulationValidation = false;								// Whether simulationValidation holds results to display.
+	ColliderParameters colliderParameters = {};							// Which colliders push the grass, editable in ImGui.
+	GpuProfiler gpuProfiler = {};										// Timestamp queries around the compute and graphics passes, shown in ImGui.
+	std::array<uint64_t, kMaxFramesInFlight> frameSubmitTimes = {};		// CpuProfiler::now() at each frame slot's last compute submit, aligns the GPU scopes in the trace.
+	std::vector<glm::vec4> colliders = {};								// This frame's sphere colliders (XYZ centre, W radius) before binning.
+
+	// Initialisation work run on the task pool alongside device creation, see startInitialisationTasks.
+	std::future<void> bladeGenerationTask = {};							// Fills localBladeInstanceBuffer, waited on before the first upload.
+	std::future<DecodedImage> heightMapDecodeTask = {};					// The decoded height map, taken by createHeightMapImage.
+	std::map<std::string, std::shared_future<std::vector<char>>> shaderCodeTasks = {};	// SPIR-V by file name, not modified after startInitialisationTasks.
+	std::vector<std::future<VkResult>> pipelineTasks = {};				// Pipelines being built by createPipelines, see waitForPipelines.
+	TaskPool taskPool;													// Declared last so its workers finish before anything they use is destroyed.
 };
@@ -0,0 +1,78 @@
+#version 460 core
+
+// Non-tessellated grass, used on devices without tessellation shader support.
+// Each instance is one visible blade drawn as a triangle strip, gl_VertexIndex walks up the blade alternating left and right
+// with a single tip vertex at the end, so vertexCount = 2 * segments + 1.
+
+// A shader copy of the BladeInstanceData structure defined in GrassBlade.h.
+struct BladeInstanceData {
+    vec4 p0_and_width;
+    vec4 p1_and_height;
+    vec4 p2_and_direction;
+    vec4 upVec_and_stiffness;             
+};
+
+// Binding is 0 here because it's a uniform buffer object with binding 0 within the descriptor set layout.
+layout(binding = 0) uniform CameraUniformBufferObject {
+    mat4 model;
+    mat4 view;
+    mat4 proj;
+} ubo;
+
+// The blades that survived culling, written by the compute shader.
+layout(std140, binding = 2) buffer BladeInstanceDataBufferCurrentFrame {
+    BladeInstanceData blades[]; 
+} bladeInstanceDataBufferCurrentFrame;
+
+// The number of strip vertices for the level of detail being drawn.
+layout(push_constant) uniform GrassPushConstantsObject {
+    uint vertexCount;
+} grassPushConstantsObject;
+
+layout(location = 0) out vec4 outColor;
+
+void main() {
+    BladeInstanceData blade = bladeInstanceDataBufferCurrentFrame.blades[gl_InstanceIndex];
+
+    // Control points for the Bézier curve in world space.
+    vec4 P0 = blade.p0_and_width;
+    vec4 P1 = blade.p1_and_height;
+    vec4 P2 = blade.p2_and_direction;
+
+    // Equivalent of gl_TessCoord in grassTessEval.tese, u across the blade and v along it.
+    uint segments = (grassPushConstantsObject.vertexCount - 1) / 2;
+    bool isTip = gl_VertexIndex == grassPushConstantsObject.vertexCount - 1;
+    float v = min(float(gl_VertexIndex / 2) / float(segments), 1.0);
+    float u = isTip ? 0.5 : float(gl_VertexIndex & 1);
+
+    float width = P0.w;
+    float direction = P2.w;
+
+    // Matches grassTessEval.tese, the closer to 1 the smoother the tip.
+    float smoothnessFactor = 0.6; 
+
+    // De Casteljau's algorithm to get a point on the Bézier curve.
+    vec3 a = P0.xyz + v * (P1.xyz - P0.xyz);
+    vec3 b = P1.xyz + v * (P2.xyz - P1.xyz);
+    vec3 c = a + v * (b - a);
+
+    // Tangent and bitangent.
+    vec3 t0 = normalize(b - a); 
+    vec3 t1 = vec3(cos(direction), sin(direction), 0.0); // Assumes Z is up.    
+
+    // Normal and 3D shape displacement.
+    vec3 normal = normalize(cross(t0, t1));
+    vec3 displacement = (width * (0.5 - abs(u - 0.5) * (1.0 - v))) * 0.5 * normal;
+
+    vec3 c0 = (c - width * t1) + displacement;
+    vec3 c1 = (c + width * t1) + displacement;
+    
+    float t = u + 0.5 * v - u * v; 
+    vec3 position = mix(c0, c1, t * smoothnessFactor);
+
+    gl_Position = ubo.proj * ubo.view * vec4(position.xyz, 1.0);
+
+    // Same gradient as the tessellated path, black at the base and tall yellow/short green at the tip.
+    vec4 baseColor = vec4(0.0, 1.0, 0.0, 1.0);
+    outColor = mix(baseColor * v, vec4(P1.w - 0.4, P1.w, 0.0, 1.0), v);
+}
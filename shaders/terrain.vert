@@ -0,0 +1,44 @@
+#version 460 core
+
+// Non-tessellated terrain, used on devices without tessellation shader support.
+// The ground plane is subdivided on the CPU instead (see Quad::generateGrid) and displaced here per-vertex.
+
+// Binding is 0 here because it's a uniform buffer object with binding 0 within the descriptor set layout.
+layout(binding = 0) uniform CameraUniformBufferObject {
+    mat4 model;
+    mat4 view;
+    mat4 proj;
+} ubo;
+
+// A sampler to sample the height map texture.
+layout(binding = 1) uniform sampler2D heightMapSampler;
+
+layout(location = 0) in vec3 inPosition;
+layout(location = 1) in vec4 inColour; 
+layout(location = 2) in vec2 inUv;
+
+layout(location = 0) out vec4 outColor;
+
+// The terrain mapping, shared with the grass compute shader through TerrainSpecializationConstants in Buffer.h.
+layout(constant_id = 0) const float HEIGHT_MAP_SCALE = 64.0;
+layout(constant_id = 1) const float TERRAIN_SCALE = 1.5;
+layout(constant_id = 2) const float TERRAIN_UV_OFFSET = 30.0;
+layout(constant_id = 3) const float TERRAIN_UV_SIZE = 170.0;
+
+void main() {
+    const vec4 planeColour = vec4(0.120, 0.075, 0.017, 1.0);
+
+    vec4 worldPosition = ubo.model * vec4(inPosition, 1.0);
+
+    // Sample the height map with the same world to uv mapping as the grass compute shader, so the blades sit on the ground.
+    float u = ((worldPosition.x + TERRAIN_UV_OFFSET) / TERRAIN_UV_SIZE);
+    float v = 1.0 - ((worldPosition.y + TERRAIN_UV_OFFSET) / TERRAIN_UV_SIZE);
+    float height = textureLod(heightMapSampler, vec2(v, u), 0.0).r * HEIGHT_MAP_SCALE;
+
+    float terrainScale = TERRAIN_SCALE;
+    worldPosition.z = height * terrainScale;
+
+    gl_Position = ubo.proj * ubo.view * vec4(worldPosition.xyz, 1.0);
+
+    outColor = planeColour * (abs(height) + 0.01); // the ground colour but it gets lighter the higher the point is. 
+}
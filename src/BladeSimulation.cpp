@@ -0,0 +1,181 @@
+#include "BladeSimulation.h"
+
+// ===============================================================================================================================================================================
+
+#include <cmath>
+#include <cstring>
+
+// ===============================================================================================================================================================================
+
+// Same as keepPersistentLength in grassCompute.comp, restores the approximate arc length of the curve to the blade height.
+static void keepPersistentLength(const glm::vec3& v0, glm::vec3& v1, glm::vec3& v2, float height)
+{
+	glm::vec3 v01 = v1 - v0;
+	glm::vec3 v12 = v2 - v1;
+	float L1 = glm::length(v01) + glm::length(v12);
+	float L0 = glm::length(v2 - v0);
+	float L = (2.0f * L0 + L1) / 3.0f;
+
+	float ldiff = height / L;
+	v1 = v0 + v01 * ldiff;
+	v2 = v1 + v12 * ldiff;
+}
+
+// Same as gravityForce in grassCompute.comp, straight down plus a quarter of it towards the blade's front face.
+static glm::vec3 gravityForce(const GrassBladeInstanceData& blade, const BladeSimulationParameters& parameters)
+{
+	glm::vec3 widthDirection = glm::vec3(std::cos(blade.p2_direction.w), std::sin(blade.p2_direction.w), 0.0f);
+	glm::vec3 front = glm::normalize(glm::cross(widthDirection, glm::vec3(blade.up_stiffness)));
+	return glm::vec3(0.0f, 0.0f, -parameters.gravity) + 0.25f * parameters.gravity * front;
+}
+
+// Same as collide in grassCompute.comp, the translation that moves point out of the sphere.
+static glm::vec3 collide(const glm::vec3& point, const glm::vec4& collider)
+{
+	glm::vec3 toPoint = point - glm::vec3(collider);
+	float distanceToCentre = glm::length(toPoint);
+	if (distanceToCentre >= collider.w || distanceToCentre <= 0.0f) {
+		return glm::vec3(0.0f);
+	}
+
+	return toPoint / distanceToCentre * (collider.w - distanceToCentre);
+}
+
+// ===============================================================================================================================================================================
+
+GrassBladeInstanceData BladeSimulation::step(const GrassBladeInstanceData& lastState, glm::vec2 windSample, float lastTrample, const std::vector<glm::vec4>& colliders, 
+	const BladeSimulationParameters& parameters, float& trample)
+{
+	glm::vec3 v0 = glm::vec3(lastState.p0_width);
+	glm::vec3 v1 = glm::vec3(lastState.p1_height);
+	glm::vec3 v2 = glm::vec3(lastState.p2_direction);
+	glm::vec3 up = glm::vec3(lastState.up_stiffness);
+	float height = lastState.p1_height.w;
+	float stiffness = lastState.up_stiffness.w;
+	float dt = parameters.deltaTime;
+
+	glm::vec3 gravity = gravityForce(lastState, parameters);
+
+	// Recovery towards the upright rest pose, weighted by stiffness and weakened while trampled.
+	glm::vec3 restTip = v0 + up * height;
+	glm::vec3 recovery = (restTip - v2) * stiffness * (1.0f - lastTrample);
+
+	// Wind, scaled down when the blade points along the wind or is bent over.
+	glm::vec3 wind = glm::vec3(windSample * parameters.windForce, 0.0f);
+	float windLength = glm::length(wind);
+	if (windLength > 0.0f) {
+		float directionalAlignment = 1.0f - std::abs(glm::dot(wind / windLength, glm::normalize(v2 - v0)));
+		float heightRatio = glm::dot(v2 - v0, up) / height;
+		wind = wind * (directionalAlignment * heightRatio);
+	}
+
+	v2 += (gravity + recovery + wind) * dt;
+
+	// Colliders push the tip and the curve's midpoint out, the midpoint only moves a quarter as far as the tip.
+	glm::vec3 displacement = glm::vec3(0.0f);
+	for (const glm::vec4& collider : colliders) {
+		glm::vec3 midpoint = 0.25f * v0 + 0.5f * v1 + 0.25f * v2;
+		displacement += collide(v2, collider) + 4.0f * collide(midpoint, collider);
+	}
+	v2 += displacement;
+
+	// Trampling fades out over trampleRecoveryTime, and is topped up by how far the colliders pushed the blade.
+	trample = std::fmax(lastTrample - dt / parameters.trampleRecoveryTime, 0.0f);
+	trample = std::fmax(trample, std::fmin(glm::length(displacement) / (0.25f * height), 1.0f));
+
+	// State validation, see simulateBlade in grassCompute.comp.
+	v2 -= up * std::fmin(glm::dot(up, v2 - v0), 0.0f);
+	float projectedLength = glm::length(v2 - v0 - up * glm::dot(v2 - v0, up));
+	v1 = v0 + height * up * std::fmax(1.0f - projectedLength / height, 0.05f * std::fmax(projectedLength / height, 1.0f));
+	keepPersistentLength(v0, v1, v2, height);
+
+	GrassBladeInstanceData currentState = lastState;
+	currentState.p1_height = glm::vec4(v1, lastState.p1_height.w);
+	currentState.p2_direction = glm::vec4(v2, lastState.p2_direction.w);
+	return currentState;
+}
+
+GrassBladeInstanceData BladeSimulation::sway(const GrassBladeInstanceData& lastState, glm::vec2 windSample, const BladeSimulationParameters& parameters)
+{
+	glm::vec3 v0 = glm::vec3(lastState.p0_width);
+	glm::vec3 up = glm::vec3(lastState.up_stiffness);
+	float height = lastState.p1_height.w;
+	float stiffness = lastState.up_stiffness.w;
+
+	// Where recovery balances gravity and the wind.
+	glm::vec3 wind = glm::vec3(windSample * parameters.windForce, 0.0f);
+	glm::vec3 v2 = v0 + glm::normalize(up * height + (gravityForce(lastState, parameters) + wind) / stiffness) * height;
+
+	float projectedLength = glm::length(v2 - v0 - up * glm::dot(v2 - v0, up));
+	glm::vec3 v1 = v0 + height * up * std::fmax(1.0f - projectedLength / height, 0.05f * std::fmax(projectedLength / height, 1.0f));
+
+	GrassBladeInstanceData currentState = lastState;
+	currentState.p1_height = glm::vec4(v1, lastState.p1_height.w);
+	currentState.p2_direction = glm::vec4(v2, lastState.p2_direction.w);
+	return currentState;
+}
+
+glm::vec2 BladeSimulation::sampleWindField(const std::vector<glm::vec2>& windField, uint32_t resolution, glm::vec2 uv)
+{
+	// Texel centres are at (i + 0.5) / resolution, as with VK_FILTER_LINEAR.
+	float x = uv.x * resolution - 0.5f;
+	float y = uv.y * resolution - 0.5f;
+	float x0 = std::floor(x);
+	float y0 = std::floor(y);
+	float fx = x - x0;
+	float fy = y - y0;
+
+	// VK_SAMPLER_ADDRESS_MODE_REPEAT.
+	auto wrap = [resolution](float i) { 
+		int r = static_cast<int>(resolution);
+		return static_cast<uint32_t>(((static_cast<int>(i) % r) + r) % r); 
+	};
+	uint32_t ix0 = wrap(x0), ix1 = wrap(x0 + 1.0f);
+	uint32_t iy0 = wrap(y0), iy1 = wrap(y0 + 1.0f);
+
+	glm::vec2 top = glm::mix(windField[iy0 * resolution + ix0], windField[iy0 * resolution + ix1], fx);
+	glm::vec2 bottom = glm::mix(windField[iy1 * resolution + ix0], windField[iy1 * resolution + ix1], fx);
+	return glm::mix(top, bottom, fy);
+}
+
+BladeSimulationValidation BladeSimulation::validate(const std::vector<GrassBladeInstanceData>& lastStates, const std::vector<GrassBladeInstanceData>& gpuStates,
+	const std::vector<float>& lastTrample, const std::vector<float>& gpuTrample, const std::vector<glm::vec2>& windSamples, 
+	const std::vector<glm::vec4>& colliders, const BladeSimulationParameters& parameters, float tolerance)
+{
+	BladeSimulationValidation result = {};
+	result.sampled = static_cast<uint32_t>(lastStates.size());
+
+	double errorSum = 0.0;
+	for (size_t i = 0; i < lastStates.size(); ++i) {
+
+		// Culled blades are copied forward untouched, so there is nothing to compare.
+		if (std::memcmp(&lastStates[i], &gpuStates[i], sizeof(GrassBladeInstanceData)) == 0) {
+			continue;
+		}
+
+		// Same tiering as the culling pass, static blades were already skipped above as they are unchanged.
+		float tierDistance = glm::length(glm::vec2(lastStates[i].p0_width.x, lastStates[i].p0_width.y) - parameters.cameraPosition);
+
+		float referenceTrample = 0.0f;
+		GrassBladeInstanceData reference;
+		if (tierDistance < parameters.simulationDistance) {
+			reference = step(lastStates[i], windSamples[i], lastTrample[i], colliders, parameters, referenceTrample);
+		}
+		else {
+			reference = sway(lastStates[i], windSamples[i], parameters);
+			referenceTrample = std::fmax(lastTrample[i] - parameters.deltaTime / parameters.trampleRecoveryTime, 0.0f);
+		}
+		float p1Error = glm::length(glm::vec3(reference.p1_height) - glm::vec3(gpuStates[i].p1_height));
+		float p2Error = glm::length(glm::vec3(reference.p2_direction) - glm::vec3(gpuStates[i].p2_direction));
+		float trampleError = std::fabs(referenceTrample - gpuTrample[i]);
+		float error = std::fmax(std::fmax(p1Error, p2Error), trampleError);
+
+		result.compared++;
+		result.maxError = std::fmax(result.maxError, error);
+		result.mismatched += (error > tolerance) ? 1 : 0;
+		errorSum += error;
+	}
+
+	result.meanError = (result.compared > 0) ? static_cast<float>(errorSum / result.compared) : 0.0f;
+	return result;
+}
@@ -0,0 +1,184 @@
+#include "CameraPath.h"
+
+// ===============================================================================================================================================================================
+
+#include "Constants.h"
+
+#include <array>
+#include <fstream>
+#include <sstream>
+
+// ===============================================================================================================================================================================
+
+// The interpolated channels of a keyframe: position, pitch, yaw, and fov.
+using CameraChannels = std::array<float, 6>;
+
+static CameraChannels toChannels(const CameraKeyframe& keyframe)
+{
+	return { keyframe.position.x, keyframe.position.y, keyframe.position.z, keyframe.pitch, keyframe.yaw, keyframe.fov };
+}
+
+// Linear blend of a and b by how far t lies from ta towards tb.
+static CameraChannels blend(const CameraChannels& a, const CameraChannels& b, float ta, float tb, float t)
+{
+	float w = (t - ta) / (tb - ta);
+	CameraChannels result = {};
+	for (size_t i = 0; i < result.size(); ++i) {
+		result[i] = a[i] + (b[i] - a[i]) * w;
+	}
+	return result;
+}
+
+// Barry and Goldman's pyramidal form of the Catmull-Rom spline between p1 and p2, with the keyframe frames as knots.
+static CameraChannels catmullRom(const CameraChannels& p0, const CameraChannels& p1, const CameraChannels& p2, const CameraChannels& p3,
+	float t0, float t1, float t2, float t3, float t)
+{
+	CameraChannels a1 = blend(p0, p1, t0, t1, t);
+	CameraChannels a2 = blend(p1, p2, t1, t2, t);
+	CameraChannels a3 = blend(p2, p3, t2, t3, t);
+	CameraChannels b1 = blend(a1, a2, t0, t2, t);
+	CameraChannels b2 = blend(a2, a3, t1, t3, t);
+	return blend(b1, b2, t1, t2, t);
+}
+
+// ===============================================================================================================================================================================
+
+bool CameraPath::load(const std::string& fileName)
+{
+	std::ifstream file(fileName);
+	if (!file.is_open()) {
+		return false;
+	}
+
+	keyframes.clear();
+	std::string line;
+	while (std::getline(file, line)) {
+		if (line.empty() || line[0] == '#') {
+			continue;
+		}
+
+		CameraKeyframe keyframe = {};
+		std::istringstream stream(line);
+		if (!(stream >> keyframe.frame >> keyframe.position.x >> keyframe.position.y >> keyframe.position.z >> keyframe.pitch >> keyframe.yaw >> keyframe.fov)) {
+			keyframes.clear();
+			return false;
+		}
+		if (!keyframes.empty() && keyframe.frame <= keyframes.back().frame) {
+			keyframes.clear();
+			return false;
+		}
+		keyframes.push_back(keyframe);
+	}
+
+	return !keyframes.empty();
+}
+
+bool CameraPath::save(const std::string& fileName) const
+{
+	std::ofstream file(fileName);
+	if (!file.is_open()) {
+		return false;
+	}
+
+	file << "# frame x y z pitch yaw fov\n";
+	for (const CameraKeyframe& keyframe : keyframes) {
+		file << keyframe.frame << " " << keyframe.position.x << " " << keyframe.position.y << " " << keyframe.position.z << " "
+			<< keyframe.pitch << " " << keyframe.yaw << " " << keyframe.fov << "\n";
+	}
+
+	return true;
+}
+
+CameraPath CameraPath::createDefaultFlythrough()
+{
+	Defaults defaults;
+
+	// Skims the meadow at blade height through the near, sway, and static simulation tiers, then returns to the Defaults pose. Yaw keeps
+	// increasing through the loop, the final -130 + 360 degrees faces the same way as the start.
+	const CameraKeyframe poses[] = {
+		{ 0, defaults.position, defaults.pitch, defaults.yaw, defaults.fov },
+		{ 0, glm::vec3(10.0f, 25.0f, 3.0f), 84.0f, -90.0f, defaults.fov },
+		{ 0, glm::vec3(60.0f, 20.0f, 3.0f), 84.0f, -45.0f, defaults.fov },
+		{ 0, glm::vec3(90.0f, 60.0f, 6.0f), 86.0f, 45.0f, defaults.fov },
+		{ 0, glm::vec3(50.0f, 95.0f, 4.0f), 85.0f, 110.0f, defaults.fov },
+		{ 0, defaults.position, defaults.pitch, defaults.yaw + 360.0f, defaults.fov },
+	};
+
+	CameraPath path = {};
+	uint32_t frame = 0;
+	for (CameraKeyframe pose : poses) {
+		pose.frame = frame;
+		path.keyframes.push_back(pose);
+		frame += kCameraPathSegmentFrames;
+	}
+
+	return path;
+}
+
+void CameraPath::addKeyframe(const CameraKeyframe& keyframe)
+{
+	if (!keyframes.empty() && keyframe.frame <= keyframes.back().frame) {
+		return;
+	}
+	keyframes.push_back(keyframe);
+}
+
+uint32_t CameraPath::apply(uint32_t frame, Camera& camera) const
+{
+	if (keyframes.empty()) {
+		return 0;
+	}
+
+	uint32_t pathFrame = keyframes.front().frame + frame % (getLength() - keyframes.front().frame + 1);
+
+	// Find the segment [i, i + 1] holding the frame, clamped to the last keyframe.
+	size_t i = 0;
+	while (i + 1 < keyframes.size() && keyframes[i + 1].frame <= pathFrame) {
+		++i;
+	}
+
+	CameraChannels channels = toChannels(keyframes[i]);
+	if (i + 1 < keyframes.size()) {
+		// Mirror the neighbours of the end segments so the spline does not need keyframes beyond the path.
+		const CameraKeyframe& k1 = keyframes[i];
+		const CameraKeyframe& k2 = keyframes[i + 1];
+		CameraChannels p1 = toChannels(k1);
+		CameraChannels p2 = toChannels(k2);
+		float t1 = static_cast<float>(k1.frame);
+		float t2 = static_cast<float>(k2.frame);
+
+		CameraChannels p0 = {}, p3 = {};
+		float t0 = 0.0f, t3 = 0.0f;
+		if (i > 0) {
+			p0 = toChannels(keyframes[i - 1]);
+			t0 = static_cast<float>(keyframes[i - 1].frame);
+		}
+		else {
+			for (size_t c = 0; c < p0.size(); ++c) {
+				p0[c] = 2.0f * p1[c] - p2[c];
+			}
+			t0 = 2.0f * t1 - t2;
+		}
+		if (i + 2 < keyframes.size()) {
+			p3 = toChannels(keyframes[i + 2]);
+			t3 = static_cast<float>(keyframes[i + 2].frame);
+		}
+		else {
+			for (size_t c = 0; c < p3.size(); ++c) {
+				p3[c] = 2.0f * p2[c] - p1[c];
+			}
+			t3 = 2.0f * t2 - t1;
+		}
+
+		channels = catmullRom(p0, p1, p2, p3, t0, t1, t2, t3, static_cast<float>(pathFrame));
+	}
+
+	camera.position = glm::vec3(channels[0], channels[1], channels[2]);
+	camera.pitch = channels[3];
+	camera.yaw = channels[4];
+	camera.fov = channels[5];
+	camera.velocity = glm::vec3(0.0f);
+	camera.sensitivity = glm::vec2(0.0f);
+
+	return pathFrame;
+}
@@ -0,0 +1,70 @@
+#include "ColliderGrid.h"
+
+// ===============================================================================================================================================================================
+
+#include <algorithm>
+#include <cmath>
+
+// ===============================================================================================================================================================================
+
+// Cell coordinate along one axis, clamped to the grid as the culling pass clamps blade roots.
+static uint32_t cellCoordinate(float position, float cellSize)
+{
+	int cell = static_cast<int>(std::floor((position - kColliderGridOrigin) / cellSize));
+	return static_cast<uint32_t>(std::clamp(cell, 0, static_cast<int>(kColliderGridResolution) - 1));
+}
+
+// ===============================================================================================================================================================================
+
+uint32_t ColliderGrid::build(const std::vector<glm::vec4>& colliders, ColliderBufferObject& buffer)
+{
+	buffer.gridOrigin = glm::vec2(kColliderGridOrigin, kColliderGridOrigin);
+	buffer.cellSize = kColliderGridWorldSize / kColliderGridResolution;
+	buffer.gridResolution = kColliderGridResolution;
+	buffer.numColliders = static_cast<uint32_t>(std::min<size_t>(colliders.size(), kMaxColliders));
+
+	std::fill(std::begin(buffer.cellCount), std::end(buffer.cellCount), 0u);
+
+	// Cell rectangle covered by each collider, the tip of a blade can be up to its height away from the root.
+	const float reach = kGrassMaxHeight * 1.5f;
+	std::vector<glm::uvec4> cellRanges(buffer.numColliders);
+	for (uint32_t i = 0; i < buffer.numColliders; ++i) {
+		const glm::vec4& collider = colliders[i];
+		buffer.colliders[i] = collider;
+
+		float extent = collider.w + reach;
+		cellRanges[i] = glm::uvec4(cellCoordinate(collider.x - extent, buffer.cellSize), cellCoordinate(collider.y - extent, buffer.cellSize),
+			cellCoordinate(collider.x + extent, buffer.cellSize), cellCoordinate(collider.y + extent, buffer.cellSize));
+
+		for (uint32_t y = cellRanges[i].y; y <= cellRanges[i].w; ++y) {
+			for (uint32_t x = cellRanges[i].x; x <= cellRanges[i].z; ++x) {
+				buffer.cellCount[y * kColliderGridResolution + x]++;
+			}
+		}
+	}
+
+	// Prefix sum the counts into start offsets, cells that would overflow the reference list are emptied.
+	uint32_t numReferences = 0;
+	for (uint32_t cell = 0; cell < kColliderGridCells; ++cell) {
+		if (numReferences + buffer.cellCount[cell] > kMaxColliderReferences) {
+			buffer.cellCount[cell] = 0;
+		}
+		buffer.cellStart[cell] = numReferences;
+		numReferences += buffer.cellCount[cell];
+	}
+
+	// Fill in collider order so each cell lists its colliders in ascending index, the same order the CPU reference tests them in.
+	std::vector<uint32_t> cellFill(kColliderGridCells, 0);
+	for (uint32_t i = 0; i < buffer.numColliders; ++i) {
+		for (uint32_t y = cellRanges[i].y; y <= cellRanges[i].w; ++y) {
+			for (uint32_t x = cellRanges[i].x; x <= cellRanges[i].z; ++x) {
+				uint32_t cell = y * kColliderGridResolution + x;
+				if (cellFill[cell] < buffer.cellCount[cell]) {
+					buffer.colliderIndices[buffer.cellStart[cell] + cellFill[cell]++] = i;
+				}
+			}
+		}
+	}
+
+	return buffer.numColliders;
+}
@@ -0,0 +1,245 @@
+#include "CpuProfiler.h"
+
+// ===============================================================================================================================================================================
+
+#include "Constants.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+
+// ===============================================================================================================================================================================
+
+static_assert((kCpuProfilerRingSize & (kCpuProfilerRingSize - 1)) == 0, "kCpuProfilerRingSize must be a power of two.");
+
+// Writes a Chrome trace timestamp, microseconds with nanosecond precision.
+static void writeMicroseconds(std::ofstream& file, uint64_t nanoseconds)
+{
+	file << nanoseconds / 1000 << "." << std::setw(3) << std::setfill('0') << nanoseconds % 1000;
+}
+
+// Zone names are string literals, but escape them anyway so a stray quote cannot break the JSON.
+static void writeString(std::ofstream& file, const std::string& text)
+{
+	file << "\"";
+	for (char c : text) {
+		if (c == '"' || c == '\\') {
+			file << '\\';
+		}
+		file << c;
+	}
+	file << "\"";
+}
+
+// ===============================================================================================================================================================================
+
+thread_local CpuProfiler::ThreadBuffer* CpuProfiler::currentThreadBuffer = nullptr;
+
+CpuProfiler& CpuProfiler::get()
+{
+	static CpuProfiler profiler;
+	return profiler;
+}
+
+uint64_t CpuProfiler::now()
+{
+	static const std::chrono::steady_clock::time_point origin = std::chrono::steady_clock::now();
+	return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - origin).count());
+}
+
+CpuProfiler::ThreadBuffer& CpuProfiler::getThreadBuffer()
+{
+	if (currentThreadBuffer == nullptr) {
+		std::unique_ptr<ThreadBuffer> buffer = std::make_unique<ThreadBuffer>();
+
+		std::lock_guard<std::mutex> lock(threadsMutex);
+		buffer->threadId = static_cast<uint32_t>(threads.size());
+		buffer->name = "Thread " + std::to_string(buffer->threadId);
+		currentThreadBuffer = buffer.get();
+		threads.push_back(std::move(buffer));
+	}
+	return *currentThreadBuffer;
+}
+
+void CpuProfiler::setThreadName(const char* name)
+{
+	ThreadBuffer& buffer = getThreadBuffer();
+	std::lock_guard<std::mutex> lock(threadsMutex);
+	buffer.name = name;
+}
+
+void CpuProfiler::recordZone(const char* name, uint64_t beginNs, uint64_t endNs, uint32_t depth)
+{
+	ThreadBuffer& buffer = getThreadBuffer();
+	uint64_t head = buffer.head.load(std::memory_order_relaxed);
+	if (head == 0) {
+		buffer.events = std::make_unique<ZoneSlot[]>(kCpuProfilerRingSize); // Readers skip buffers whose head is still 0, so this cannot race with them.
+	}
+
+	// Mark the slot as being written before touching the fields, the release fence keeps the field stores after the mark.
+	ZoneSlot& slot = buffer.events[head & (kCpuProfilerRingSize - 1)];
+	slot.sequence.store(2 * head + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	slot.name.store(name, std::memory_order_relaxed);
+	slot.beginNs.store(beginNs, std::memory_order_relaxed);
+	slot.endNs.store(endNs, std::memory_order_relaxed);
+	slot.depth.store(depth, std::memory_order_relaxed);
+	slot.sequence.store(2 * head + 2, std::memory_order_release);
+
+	buffer.head.store(head + 1, std::memory_order_release);
+}
+
+void CpuProfiler::addGpuFrame(const GpuFrameEvents& frame)
+{
+	if (!isEnabled()) {
+		return;
+	}
+
+	if (gpuFrames.size() < kCpuProfilerGpuFrames) {
+		gpuFrames.push_back(frame);
+	}
+	else {
+		gpuFrames[gpuFramesHead % kCpuProfilerGpuFrames] = frame;
+	}
+	++gpuFramesHead;
+}
+
+std::vector<CpuThreadZones> CpuProfiler::collectZones(uint64_t sinceNs) const
+{
+	std::vector<CpuThreadZones> result = {};
+
+	std::lock_guard<std::mutex> lock(threadsMutex);
+	for (const std::unique_ptr<ThreadBuffer>& buffer : threads) {
+		CpuThreadZones thread = {};
+		thread.name = buffer->name;
+		thread.threadId = buffer->threadId;
+
+		// Copy the newest ring's worth of zones. A slot is kept only if its sequence says it held zone i, finished, both before and after its
+		// fields were read, so zones the owning thread overwrote or was writing during the copy are left out. The acquire fence keeps the
+		// field loads before the second sequence load.
+		uint64_t head = buffer->head.load(std::memory_order_acquire);
+		uint64_t first = (head > kCpuProfilerRingSize) ? head - kCpuProfilerRingSize : 0;
+		for (uint64_t i = first; i < head; ++i) {
+			const ZoneSlot& slot = buffer->events[i & (kCpuProfilerRingSize - 1)];
+			if (slot.sequence.load(std::memory_order_acquire) != 2 * i + 2) {
+				continue;
+			}
+			CpuZoneEvent event = {};
+			event.name = slot.name.load(std::memory_order_relaxed);
+			event.beginNs = slot.beginNs.load(std::memory_order_relaxed);
+			event.endNs = slot.endNs.load(std::memory_order_relaxed);
+			event.depth = slot.depth.load(std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_acquire);
+			if (slot.sequence.load(std::memory_order_relaxed) != 2 * i + 2) {
+				continue;
+			}
+
+			if (event.beginNs >= sinceNs) {
+				thread.zones.push_back(event);
+			}
+		}
+
+		result.push_back(std::move(thread));
+	}
+
+	return result;
+}
+
+bool CpuProfiler::exportChromeTrace(const std::string& fileName, uint64_t sinceNs) const
+{
+	std::ofstream file(fileName);
+	if (!file.is_open()) {
+		return false;
+	}
+
+	file << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+	file << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"CPU\"}},\n";
+	file << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":2,\"args\":{\"name\":\"GPU\"}},\n";
+	file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":2,\"tid\":0,\"args\":{\"name\":\"Graphics queue\"}},\n";
+	file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":2,\"tid\":1,\"args\":{\"name\":\"Compute queue\"}}";
+
+	for (const CpuThreadZones& thread : collectZones(sinceNs)) {
+		file << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << thread.threadId << ",\"args\":{\"name\":";
+		writeString(file, thread.name);
+		file << "}}";
+
+		for (const CpuZoneEvent& event : thread.zones) {
+			file << ",\n{\"name\":";
+			writeString(file, event.name);
+			file << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << thread.threadId << ",\"ts\":";
+			writeMicroseconds(file, event.beginNs);
+			file << ",\"dur\":";
+			writeMicroseconds(file, event.endNs - event.beginNs);
+			file << "}";
+		}
+	}
+
+	// GPU timestamps are on the device's clock. Without calibrated timestamps the two clocks are aligned by the constraint that no frame's
+	// GPU work starts before it was submitted: the offset is the smallest that satisfies it for every frame, so the frame with the least
+	// queueing latency starts exactly at its submit and the rest keep their real spacing.
+	bool hasOffset = false;
+	int64_t offset = 0;
+	for (const GpuFrameEvents& frame : gpuFrames) {
+		if (frame.submitNs < sinceNs) {
+			continue;
+		}
+		for (const GpuScopeTimestamps& scope : frame.scopes) {
+			if (scope.valid) {
+				int64_t frameOffset = static_cast<int64_t>(frame.submitNs) - static_cast<int64_t>(scope.beginNs);
+				offset = hasOffset ? std::max(offset, frameOffset) : frameOffset;
+				hasOffset = true;
+			}
+		}
+	}
+
+	for (const GpuFrameEvents& frame : gpuFrames) {
+		if (frame.submitNs < sinceNs) {
+			continue;
+		}
+		for (uint32_t i = 0; i < static_cast<uint32_t>(GpuScope::Count); ++i) {
+			const GpuScopeTimestamps& scope = frame.scopes[i];
+			if (!scope.valid) {
+				continue;
+			}
+			// One track per-queue, so culling that overlaps the previous frame's draws is visible.
+			file << ",\n{\"name\":";
+			writeString(file, getGpuScopeName(static_cast<GpuScope>(i)));
+			file << ",\"ph\":\"X\",\"pid\":2,\"tid\":" << (isGpuComputeScope(static_cast<GpuScope>(i)) ? 1 : 0) << ",\"ts\":";
+			writeMicroseconds(file, static_cast<uint64_t>(std::max<int64_t>(static_cast<int64_t>(scope.beginNs) + offset, 0)));
+			file << ",\"dur\":";
+			writeMicroseconds(file, scope.endNs - scope.beginNs);
+			file << "}";
+		}
+	}
+
+	file << "\n]}\n";
+	return true;
+}
+
+// ===============================================================================================================================================================================
+
+CpuProfileZone::CpuProfileZone(const char* name)
+	: name(name)
+{
+	CpuProfiler& profiler = CpuProfiler::get();
+	if (!profiler.isEnabled()) {
+		return;
+	}
+
+	active = true;
+	profiler.getThreadBuffer().depth++;
+	beginNs = CpuProfiler::now();
+}
+
+CpuProfileZone::~CpuProfileZone()
+{
+	if (!active) {
+		return;
+	}
+
+	uint64_t endNs = CpuProfiler::now();
+	CpuProfiler& profiler = CpuProfiler::get();
+	uint32_t depth = --profiler.getThreadBuffer().depth;
+	profiler.recordZone(name, beginNs, endNs, depth);
+}
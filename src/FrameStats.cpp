@@ -0,0 +1,185 @@
+#include "FrameStats.h"
+
+// ===============================================================================================================================================================================
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <iomanip>
+
+// ===============================================================================================================================================================================
+
+// Nearest-rank percentile of an unsorted copy.
+static double percentile(std::vector<double> values, double fraction)
+{
+	if (values.empty()) {
+		return 0.0;
+	}
+
+	size_t rank = static_cast<size_t>(std::ceil(fraction * values.size()));
+	rank = std::clamp<size_t>(rank, 1, values.size()) - 1;
+	std::nth_element(values.begin(), values.begin() + rank, values.end());
+	return values[rank];
+}
+
+// Writes the metadata that does not vary between the configurations of a sweep.
+static void writeRunMetadata(std::ofstream& file, const FrameStatsMetadata& metadata)
+{
+	file << "# build: " << metadata.build << "\n";
+	file << "# device: " << metadata.device << "\n";
+	file << "# resolution: " << metadata.width << "x" << metadata.height << "\n";
+	file << "# presentMode: " << metadata.presentMode << "\n";
+	file << "# swapchainImages: " << metadata.swapchainImages << "\n";
+	file << "# fpsLimit: " << metadata.fpsLimit << "\n";
+	file << "# framesInFlight: " << metadata.framesInFlight << "\n";
+	file << "# asyncCompute: " << (metadata.asyncCompute ? "on" : "off") << "\n";
+	file << "# rendering: " << (metadata.dynamicRendering ? "dynamic" : "renderPass") << "\n";
+	file << "# cameraPath: " << metadata.cameraPath << "\n";
+	file << "# warmupFrames: " << metadata.warmupFrames << "\n";
+	file << "# captureFrames: " << metadata.captureFrames << "\n";
+}
+
+// ===============================================================================================================================================================================
+
+std::string getGpuScopeColumnName(GpuScope scope)
+{
+	std::string name = getGpuScopeName(scope);
+	name.erase(std::remove_if(name.begin(), name.end(), [](char c) { return !std::isalnum(static_cast<unsigned char>(c)); }), name.end());
+	if (!name.empty()) {
+		name[0] = static_cast<char>(std::toupper(static_cast<unsigned char>(name[0])));
+	}
+	return "gpu" + name + "Ms";
+}
+
+bool FrameStatsRecorder::open(const std::string& fileName, const FrameStatsMetadata& metadata)
+{
+	file.open(fileName);
+	if (!file.is_open()) {
+		return false;
+	}
+
+	frameTimes.clear();
+	frameTimes.reserve(metadata.captureFrames);
+	numFrames = 0;
+	mean = 0.0;
+	m2 = 0.0;
+	max = 0.0;
+	gpuTotals = {};
+	visibleTotal = 0.0;
+	computeOverlapTotal = 0.0;
+	inputToPresentTotal = 0.0;
+
+	writeRunMetadata(file, metadata);
+	file << "# blades: " << metadata.numBlades << "\n";
+	file << "# culling: " << (metadata.frustumCulling ? "on" : "off") << "\n";
+	file << "# maxTessellationLevel: " << metadata.maxTessellationLevel << "\n";
+	file << "# computeWorkgroupSize: " << metadata.computeWorkgroupSize << "\n";
+	file << "# windField: " << (metadata.windField ? "on" : "off") << "\n";
+
+	file << "frame,cpuMs";
+	for (uint32_t i = 0; i < static_cast<uint32_t>(GpuScope::Count); ++i) {
+		file << "," << getGpuScopeColumnName(static_cast<GpuScope>(i));
+	}
+	file << ",gpuComputeOverlapMs,inputToPresentMs,numVisible,cameraX,cameraY,cameraZ,cameraPitch,cameraYaw,pathFrame\n";
+	file << std::fixed << std::setprecision(4);
+
+	return true;
+}
+
+void FrameStatsRecorder::record(const FrameStatsSample& sample)
+{
+	file << numFrames << "," << sample.cpuMs;
+	for (float gpuMs : sample.gpuMs) {
+		file << "," << gpuMs;
+	}
+	file << "," << sample.gpuComputeOverlapMs << "," << sample.inputToPresentMs << "," << sample.numVisible << "," << sample.cameraPosition.x << "," << sample.cameraPosition.y << "," << sample.cameraPosition.z << ","
+		<< sample.cameraPitch << "," << sample.cameraYaw << "," << sample.pathFrame << "\n";
+
+	++numFrames;
+	double delta = sample.cpuMs - mean;
+	mean += delta / static_cast<double>(numFrames);
+	m2 += delta * (sample.cpuMs - mean);
+	max = std::max(max, sample.cpuMs);
+	frameTimes.push_back(sample.cpuMs);
+	for (size_t i = 0; i < gpuTotals.size(); ++i) {
+		gpuTotals[i] += sample.gpuMs[i];
+	}
+	visibleTotal += sample.numVisible;
+	computeOverlapTotal += sample.gpuComputeOverlapMs;
+	inputToPresentTotal += sample.inputToPresentMs;
+}
+
+void FrameStatsRecorder::close()
+{
+	if (!file.is_open()) {
+		return;
+	}
+
+	FrameStatsSummary summary = getSummary();
+	file << "# frames: " << summary.numFrames << "\n";
+	file << "# meanMs: " << summary.mean << "\n";
+	file << "# medianMs: " << summary.median << "\n";
+	file << "# p95Ms: " << summary.p95 << "\n";
+	file << "# p99Ms: " << summary.p99 << "\n";
+	file << "# maxMs: " << summary.max << "\n";
+	file << "# varianceMs2: " << summary.variance << "\n";
+	file << "# meanInputToPresentMs: " << summary.meanInputToPresent << "\n";
+	file.close();
+}
+
+FrameStatsSummary FrameStatsRecorder::getSummary() const
+{
+	FrameStatsSummary summary = {};
+	summary.numFrames = numFrames;
+	summary.mean = mean;
+	summary.max = max;
+	summary.variance = (numFrames > 1) ? m2 / static_cast<double>(numFrames - 1) : 0.0;
+	summary.median = percentile(frameTimes, 0.5);
+	summary.p95 = percentile(frameTimes, 0.95);
+	summary.p99 = percentile(frameTimes, 0.99);
+	if (numFrames > 0) {
+		for (size_t i = 0; i < gpuTotals.size(); ++i) {
+			summary.gpuMean[i] = gpuTotals[i] / static_cast<double>(numFrames);
+		}
+		summary.meanVisible = visibleTotal / static_cast<double>(numFrames);
+		summary.meanComputeOverlap = computeOverlapTotal / static_cast<double>(numFrames);
+		summary.meanInputToPresent = inputToPresentTotal / static_cast<double>(numFrames);
+	}
+	return summary;
+}
+
+// ===============================================================================================================================================================================
+
+bool SweepResultsWriter::open(const std::string& fileName, const FrameStatsMetadata& metadata)
+{
+	file.open(fileName);
+	if (!file.is_open()) {
+		return false;
+	}
+
+	writeRunMetadata(file, metadata);
+
+	file << "blades,culling,maxTessellationLevel,workgroupSize,windField,frames,meanMs,medianMs,p95Ms,p99Ms,maxMs,varianceMs2,meanVisible";
+	for (uint32_t i = 0; i < static_cast<uint32_t>(GpuScope::Count); ++i) {
+		file << ",mean" << getGpuScopeColumnName(static_cast<GpuScope>(i));
+	}
+	file << ",meanGpuComputeOverlapMs,meanInputToPresentMs\n";
+	file << std::fixed << std::setprecision(4);
+
+	return true;
+}
+
+void SweepResultsWriter::write(const FrameStatsMetadata& metadata, const FrameStatsSummary& summary)
+{
+	file << metadata.numBlades << "," << (metadata.frustumCulling ? "on" : "off") << "," << metadata.maxTessellationLevel << "," << metadata.computeWorkgroupSize << ","
+		<< (metadata.windField ? "on" : "off") << "," << summary.numFrames << ","
+		<< summary.mean << "," << summary.median << "," << summary.p95 << "," << summary.p99 << "," << summary.max << "," << summary.variance << ","
+		<< summary.meanVisible;
+	for (double gpuMean : summary.gpuMean) {
+		file << "," << gpuMean;
+	}
+	file << "," << summary.meanComputeOverlap << "," << summary.meanInputToPresent << "\n";
+
+	// Flushed per-configuration, a sweep can run for a long time.
+	file.flush();
+}
@@ -0,0 +1,467 @@
+#include "GpuProfiler.h"
+
+// ===============================================================================================================================================================================
+
+#include "Constants.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+// ===============================================================================================================================================================================
+
+static constexpr uint32_t kNumGpuScopes = static_cast<uint32_t>(GpuScope::Count);
+static constexpr uint32_t kNumGpuStatisticsScopes = static_cast<uint32_t>(GpuStatisticsScope::Count);
+
+const char* getGpuScopeName(GpuScope scope)
+{
+	switch (scope) {
+	case GpuScope::WindField: return "Wind field";
+	case GpuScope::Culling: return "Simulation & culling";
+	case GpuScope::Terrain: return "Terrain";
+	case GpuScope::Grass: return "Grass";
+	case GpuScope::ImGui: return "ImGui";
+	default: return "Unknown";
+	}
+}
+
+const char* getGpuStatisticsScopeName(GpuStatisticsScope scope)
+{
+	switch (scope) {
+	case GpuStatisticsScope::Culling: return "Simulation & culling";
+	case GpuStatisticsScope::Terrain: return "Terrain";
+	case GpuStatisticsScope::Grass: return "Grass";
+	default: return "Unknown";
+	}
+}
+
+bool isGpuComputeScope(GpuScope scope)
+{
+	return scope == GpuScope::WindField || scope == GpuScope::Culling;
+}
+
+bool isGpuComputeStatisticsScope(GpuStatisticsScope scope)
+{
+	return scope == GpuStatisticsScope::Culling;
+}
+
+// Appends a sample to a ring buffer of kGpuProfilerHistory samples.
+static void pushHistory(std::vector<float>& history, uint32_t& head, float sample)
+{
+	if (history.size() < kGpuProfilerHistory) {
+		history.push_back(sample);
+	}
+	else {
+		history[head] = sample;
+	}
+	head = (head + 1) % kGpuProfilerHistory;
+}
+
+static GpuScopeStatistics summariseHistory(const std::vector<float>& history, uint32_t head)
+{
+	GpuScopeStatistics statistics = {};
+	if (history.empty()) {
+		return statistics;
+	}
+
+	statistics.numSamples = static_cast<uint32_t>(history.size());
+	statistics.last = history[(head + kGpuProfilerHistory - 1) % kGpuProfilerHistory % history.size()];
+
+	double sum = 0.0;
+	for (float sample : history) {
+		sum += sample;
+	}
+	statistics.average = static_cast<float>(sum / history.size());
+
+	// Nearest-rank percentile.
+	std::vector<float> sorted = history;
+	size_t rank = static_cast<size_t>(std::ceil(0.99 * sorted.size())) - 1;
+	std::nth_element(sorted.begin(), sorted.begin() + rank, sorted.end());
+	statistics.p99 = sorted[rank];
+
+	return statistics;
+}
+
+// ===============================================================================================================================================================================
+
+VkResult GpuProfiler::create(VkPhysicalDevice physicalDevice, VkDevice device, uint32_t graphicsQueueFamily, uint32_t computeQueueFamily, uint32_t framesInFlight,
+	bool tessellation)
+{
+	this->device = device;
+
+	VkResult ret = createStatisticsPools(physicalDevice, framesInFlight, tessellation);
+	if (ret != VK_SUCCESS) {
+		return ret;
+	}
+
+	VkPhysicalDeviceProperties properties = {};
+	vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+
+	uint32_t queueFamilyCount = 0;
+	vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, nullptr);
+	std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+	vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, queueFamilies.data());
+
+	// Timestamps are optional, without them the profiler stays disabled rather than failing initialisation.
+	uint32_t graphicsValidBits = queueFamilies[graphicsQueueFamily].timestampValidBits;
+	uint32_t computeValidBits = queueFamilies[computeQueueFamily].timestampValidBits;
+	if (graphicsValidBits == 0 || computeValidBits == 0 || properties.limits.timestampPeriod == 0.0f) {
+		enabled = false;
+		return VK_SUCCESS;
+	}
+
+	timestampPeriod = properties.limits.timestampPeriod;
+	graphicsTimestampMask = (graphicsValidBits >= 64) ? ~0ull : ((1ull << graphicsValidBits) - 1ull);
+	computeTimestampMask = (computeValidBits >= 64) ? ~0ull : ((1ull << computeValidBits) - 1ull);
+
+	VkQueryPoolCreateInfo queryPoolInfo = {};
+	queryPoolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+	queryPoolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+	queryPoolInfo.queryCount = kNumGpuScopes * 2;
+
+	queryPools.resize(framesInFlight);
+	recordedScopes.assign(framesInFlight, {});
+	for (uint32_t i = 0; i < framesInFlight; ++i) {
+		for (VkQueryPool& queryPool : queryPools[i]) {
+			if (vkCreateQueryPool(device, &queryPoolInfo, nullptr, &queryPool) != VK_SUCCESS) {
+				throw std::runtime_error("failed to create timestamp query pool!");
+				return VK_ERROR_INITIALIZATION_FAILED;
+			}
+		}
+	}
+
+	for (std::vector<float>& scopeHistory : history) {
+		scopeHistory.reserve(kGpuProfilerHistory);
+	}
+	overlapHistory.reserve(kGpuProfilerHistory);
+
+	enabled = true;
+	return VK_SUCCESS;
+}
+
+VkResult GpuProfiler::createStatisticsPools(VkPhysicalDevice physicalDevice, uint32_t framesInFlight, bool tessellation)
+{
+	// Pipeline statistics are optional as well, createLogicalDevice enables the feature whenever it is supported.
+	VkPhysicalDeviceFeatures features = {};
+	vkGetPhysicalDeviceFeatures(physicalDevice, &features);
+	if (features.pipelineStatisticsQuery == VK_FALSE) {
+		statisticsEnabled = false;
+		return VK_SUCCESS;
+	}
+
+	// The tessellation counters may only be requested when the tessellation feature is enabled.
+	VkQueryPipelineStatisticFlags graphicsFlags = VK_QUERY_PIPELINE_STATISTIC_VERTEX_SHADER_INVOCATIONS_BIT |
+		VK_QUERY_PIPELINE_STATISTIC_CLIPPING_INVOCATIONS_BIT | VK_QUERY_PIPELINE_STATISTIC_CLIPPING_PRIMITIVES_BIT |
+		VK_QUERY_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS_BIT;
+	if (tessellation) {
+		graphicsFlags |= VK_QUERY_PIPELINE_STATISTIC_TESSELLATION_CONTROL_SHADER_PATCHES_BIT |
+			VK_QUERY_PIPELINE_STATISTIC_TESSELLATION_EVALUATION_SHADER_INVOCATIONS_BIT;
+	}
+	for (uint32_t scope = 0; scope < kNumGpuStatisticsScopes; ++scope) {
+		statisticsFlags[scope] = isGpuComputeStatisticsScope(static_cast<GpuStatisticsScope>(scope))
+			? static_cast<VkQueryPipelineStatisticFlags>(VK_QUERY_PIPELINE_STATISTIC_COMPUTE_SHADER_INVOCATIONS_BIT) : graphicsFlags;
+	}
+
+	VkQueryPoolCreateInfo queryPoolInfo = {};
+	queryPoolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+	queryPoolInfo.queryType = VK_QUERY_TYPE_PIPELINE_STATISTICS;
+	queryPoolInfo.queryCount = 1;
+
+	statisticsPools.resize(framesInFlight);
+	recordedStatistics.assign(framesInFlight, {});
+	for (uint32_t i = 0; i < framesInFlight; ++i) {
+		for (uint32_t scope = 0; scope < kNumGpuStatisticsScopes; ++scope) {
+			queryPoolInfo.pipelineStatistics = statisticsFlags[scope];
+			if (vkCreateQueryPool(device, &queryPoolInfo, nullptr, &statisticsPools[i][scope]) != VK_SUCCESS) {
+				throw std::runtime_error("failed to create pipeline statistics query pool!");
+				return VK_ERROR_INITIALIZATION_FAILED;
+			}
+		}
+	}
+
+	statisticsEnabled = true;
+	return VK_SUCCESS;
+}
+
+void GpuProfiler::destroy()
+{
+	for (const std::array<VkQueryPool, 2>& framePools : queryPools) {
+		for (VkQueryPool queryPool : framePools) {
+			vkDestroyQueryPool(device, queryPool, nullptr);
+		}
+	}
+	for (const std::array<VkQueryPool, kNumGpuStatisticsScopes>& framePools : statisticsPools) {
+		for (VkQueryPool queryPool : framePools) {
+			vkDestroyQueryPool(device, queryPool, nullptr);
+		}
+	}
+	queryPools.clear();
+	statisticsPools.clear();
+	enabled = false;
+	statisticsEnabled = false;
+}
+
+void GpuProfiler::beginFrame(VkCommandBuffer commandBuffer, uint32_t frameIndex)
+{
+	if (enabled) {
+		resolveFrame(frameIndex);
+		resolveComputeOverlap();
+
+		vkCmdResetQueryPool(commandBuffer, queryPools[frameIndex][kComputePool], 0, kNumGpuScopes * 2);
+		recordedScopes[frameIndex].fill(false);
+	}
+
+	if (statisticsEnabled) {
+		resolveStatistics(frameIndex);
+
+		for (uint32_t scope = 0; scope < kNumGpuStatisticsScopes; ++scope) {
+			if (isGpuComputeStatisticsScope(static_cast<GpuStatisticsScope>(scope))) {
+				vkCmdResetQueryPool(commandBuffer, statisticsPools[frameIndex][scope], 0, 1);
+			}
+		}
+		recordedStatistics[frameIndex].fill(false);
+	}
+}
+
+void GpuProfiler::beginGraphicsFrame(VkCommandBuffer commandBuffer, uint32_t frameIndex)
+{
+	if (enabled) {
+		vkCmdResetQueryPool(commandBuffer, queryPools[frameIndex][kGraphicsPool], 0, kNumGpuScopes * 2);
+	}
+
+	if (statisticsEnabled) {
+		for (uint32_t scope = 0; scope < kNumGpuStatisticsScopes; ++scope) {
+			if (!isGpuComputeStatisticsScope(static_cast<GpuStatisticsScope>(scope))) {
+				vkCmdResetQueryPool(commandBuffer, statisticsPools[frameIndex][scope], 0, 1);
+			}
+		}
+	}
+}
+
+void GpuProfiler::beginScope(VkCommandBuffer commandBuffer, uint32_t frameIndex, GpuScope scope)
+{
+	if (!enabled) {
+		return;
+	}
+
+	vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, queryPools[frameIndex][getPoolIndex(scope)], static_cast<uint32_t>(scope) * 2);
+}
+
+void GpuProfiler::endScope(VkCommandBuffer commandBuffer, uint32_t frameIndex, GpuScope scope)
+{
+	if (!enabled) {
+		return;
+	}
+
+	vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, queryPools[frameIndex][getPoolIndex(scope)], static_cast<uint32_t>(scope) * 2 + 1);
+	recordedScopes[frameIndex][static_cast<size_t>(scope)] = true;
+}
+
+void GpuProfiler::beginStatistics(VkCommandBuffer commandBuffer, uint32_t frameIndex, GpuStatisticsScope scope)
+{
+	if (!statisticsEnabled) {
+		return;
+	}
+
+	vkCmdBeginQuery(commandBuffer, statisticsPools[frameIndex][static_cast<size_t>(scope)], 0, 0);
+}
+
+void GpuProfiler::endStatistics(VkCommandBuffer commandBuffer, uint32_t frameIndex, GpuStatisticsScope scope)
+{
+	if (!statisticsEnabled) {
+		return;
+	}
+
+	vkCmdEndQuery(commandBuffer, statisticsPools[frameIndex][static_cast<size_t>(scope)], 0);
+	recordedStatistics[frameIndex][static_cast<size_t>(scope)] = true;
+}
+
+void GpuProfiler::markScope(uint32_t frameIndex, GpuScope scope)
+{
+	if (enabled) {
+		recordedScopes[frameIndex][static_cast<size_t>(scope)] = true;
+	}
+}
+
+void GpuProfiler::markStatistics(uint32_t frameIndex, GpuStatisticsScope scope)
+{
+	if (statisticsEnabled) {
+		recordedStatistics[frameIndex][static_cast<size_t>(scope)] = true;
+	}
+}
+
+void GpuProfiler::clearGraphicsScopes(uint32_t frameIndex)
+{
+	if (enabled) {
+		for (uint32_t scope = 0; scope < kNumGpuScopes; ++scope) {
+			if (!isGpuComputeScope(static_cast<GpuScope>(scope))) {
+				recordedScopes[frameIndex][scope] = false;
+			}
+		}
+	}
+
+	if (statisticsEnabled) {
+		for (uint32_t scope = 0; scope < kNumGpuStatisticsScopes; ++scope) {
+			if (!isGpuComputeStatisticsScope(static_cast<GpuStatisticsScope>(scope))) {
+				recordedStatistics[frameIndex][scope] = false;
+			}
+		}
+	}
+}
+
+void GpuProfiler::resolveFrame(uint32_t frameIndex)
+{
+	previousTimestamps = lastTimestamps;
+
+	for (uint32_t scope = 0; scope < kNumGpuScopes; ++scope) {
+		lastTimestamps[scope].valid = false;
+
+		if (!recordedScopes[frameIndex][scope]) {
+			continue;
+		}
+
+		// Begin and end, each followed by its availability. No VK_QUERY_RESULT_WAIT_BIT, results that are not ready yet are dropped.
+		uint32_t poolIndex = getPoolIndex(static_cast<GpuScope>(scope));
+		uint64_t results[4] = {};
+		VkResult ret = vkGetQueryPoolResults(device, queryPools[frameIndex][poolIndex], scope * 2, 2, sizeof(results), results, sizeof(uint64_t) * 2,
+			VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+		if (ret != VK_SUCCESS || results[1] == 0 || results[3] == 0) {
+			continue;
+		}
+
+		uint64_t timestampMask = (poolIndex == kComputePool) ? computeTimestampMask : graphicsTimestampMask;
+		uint64_t begin = results[0] & timestampMask;
+		uint64_t end = results[2] & timestampMask;
+		uint64_t ticks = (end - begin) & timestampMask; // Handles the counter wrapping within the valid bits.
+
+		lastTimestamps[scope].beginNs = static_cast<uint64_t>(begin * timestampPeriod);
+		lastTimestamps[scope].endNs = lastTimestamps[scope].beginNs + static_cast<uint64_t>(ticks * timestampPeriod);
+		lastTimestamps[scope].valid = true;
+
+		float milliseconds = static_cast<float>(ticks * timestampPeriod * 1e-6);
+		pushHistory(history[scope], historyHead[scope], milliseconds);
+	}
+}
+
+void GpuProfiler::resolveComputeOverlap()
+{
+	// The span of one queue's scopes in a frame, from the first begin to the last end.
+	auto getSpan = [](const std::array<GpuScopeTimestamps, kNumGpuScopes>& timestamps, bool compute, uint64_t& beginNs, uint64_t& endNs) {
+		bool found = false;
+		for (uint32_t scope = 0; scope < kNumGpuScopes; ++scope) {
+			const GpuScopeTimestamps& timestamp = timestamps[scope];
+			if (!timestamp.valid || isGpuComputeScope(static_cast<GpuScope>(scope)) != compute) {
+				continue;
+			}
+			beginNs = found ? std::min(beginNs, timestamp.beginNs) : timestamp.beginNs;
+			endNs = found ? std::max(endNs, timestamp.endNs) : timestamp.endNs;
+			found = true;
+		}
+		return found;
+	};
+
+	// Frames are resolved in order, so previousTimestamps holds the frame whose rasterisation this frame's culling could overlap.
+	uint64_t computeBegin = 0, computeEnd = 0, graphicsBegin = 0, graphicsEnd = 0;
+	if (!getSpan(lastTimestamps, true, computeBegin, computeEnd) || !getSpan(previousTimestamps, false, graphicsBegin, graphicsEnd)) {
+		return;
+	}
+
+	uint64_t overlapBegin = std::max(computeBegin, graphicsBegin);
+	uint64_t overlapEnd = std::min(computeEnd, graphicsEnd);
+	float milliseconds = (overlapEnd > overlapBegin) ? static_cast<float>((overlapEnd - overlapBegin) * 1e-6) : 0.0f;
+	pushHistory(overlapHistory, overlapHead, milliseconds);
+}
+
+GpuScopeStatistics GpuProfiler::getStatistics(GpuScope scope) const
+{
+	return summariseHistory(history[static_cast<size_t>(scope)], historyHead[static_cast<size_t>(scope)]);
+}
+
+GpuScopeStatistics GpuProfiler::getComputeOverlapStatistics() const
+{
+	return summariseHistory(overlapHistory, overlapHead);
+}
+
+void GpuProfiler::resolveStatistics(uint32_t frameIndex)
+{
+	static constexpr VkQueryPipelineStatisticFlagBits kCounterOrder[] = {
+		VK_QUERY_PIPELINE_STATISTIC_VERTEX_SHADER_INVOCATIONS_BIT,
+		VK_QUERY_PIPELINE_STATISTIC_CLIPPING_INVOCATIONS_BIT,
+		VK_QUERY_PIPELINE_STATISTIC_CLIPPING_PRIMITIVES_BIT,
+		VK_QUERY_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS_BIT,
+		VK_QUERY_PIPELINE_STATISTIC_TESSELLATION_CONTROL_SHADER_PATCHES_BIT,
+		VK_QUERY_PIPELINE_STATISTIC_TESSELLATION_EVALUATION_SHADER_INVOCATIONS_BIT,
+		VK_QUERY_PIPELINE_STATISTIC_COMPUTE_SHADER_INVOCATIONS_BIT
+	};
+
+	for (uint32_t scope = 0; scope < kNumGpuStatisticsScopes; ++scope) {
+		if (!recordedStatistics[frameIndex][scope]) {
+			continue;
+		}
+
+		// One value per enabled counter in ascending bit order (the order of kCounterOrder), followed by the availability.
+		uint64_t results[8] = {};
+		uint32_t numCounters = 0;
+		for (VkQueryPipelineStatisticFlagBits counter : kCounterOrder) {
+			numCounters += (statisticsFlags[scope] & counter) ? 1 : 0;
+		}
+
+		VkResult ret = vkGetQueryPoolResults(device, statisticsPools[frameIndex][scope], 0, 1, sizeof(results), results, sizeof(results),
+			VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+		if (ret != VK_SUCCESS || results[numCounters] == 0) {
+			continue;
+		}
+
+		uint64_t counters[7] = {};
+		uint32_t next = 0;
+		for (uint32_t i = 0; i < 7; ++i) {
+			if (statisticsFlags[scope] & kCounterOrder[i]) {
+				counters[i] = results[next++];
+			}
+		}
+
+		PipelineStatistics& statistics = lastStatistics[scope];
+		statistics.vertexShaderInvocations = counters[0];
+		statistics.clippingInvocations = counters[1];
+		statistics.clippingPrimitives = counters[2];
+		statistics.fragmentShaderInvocations = counters[3];
+		statistics.tessellationControlPatches = counters[4];
+		statistics.tessellationEvaluationInvocations = counters[5];
+		statistics.computeShaderInvocations = counters[6];
+
+		PipelineStatistics& totals = statisticsTotals[scope];
+		totals.vertexShaderInvocations += statistics.vertexShaderInvocations;
+		totals.tessellationControlPatches += statistics.tessellationControlPatches;
+		totals.tessellationEvaluationInvocations += statistics.tessellationEvaluationInvocations;
+		totals.clippingInvocations += statistics.clippingInvocations;
+		totals.clippingPrimitives += statistics.clippingPrimitives;
+		totals.fragmentShaderInvocations += statistics.fragmentShaderInvocations;
+		totals.computeShaderInvocations += statistics.computeShaderInvocations;
+		++numStatisticsTotals[scope];
+	}
+}
+
+PipelineStatistics GpuProfiler::getAveragePipelineStatistics(GpuStatisticsScope scope) const
+{
+	PipelineStatistics average = {};
+	uint64_t count = numStatisticsTotals[static_cast<size_t>(scope)];
+	if (count == 0) {
+		return average;
+	}
+
+	const PipelineStatistics& totals = statisticsTotals[static_cast<size_t>(scope)];
+	average.vertexShaderInvocations = totals.vertexShaderInvocations / count;
+	average.tessellationControlPatches = totals.tessellationControlPatches / count;
+	average.tessellationEvaluationInvocations = totals.tessellationEvaluationInvocations / count;
+	average.clippingInvocations = totals.clippingInvocations / count;
+	average.clippingPrimitives = totals.clippingPrimitives / count;
+	average.fragmentShaderInvocations = totals.fragmentShaderInvocations / count;
+	average.computeShaderInvocations = totals.computeShaderInvocations / count;
+	return average;
+}
+
+void GpuProfiler::resetPipelineStatisticsTotals()
+{
+	statisticsTotals = {};
+	numStatisticsTotals = {};
+}
@@ -51,3 +51,40 @@ MeshTransform BaseBladeShape::generateShape()
 
 	return meshData;
 }
+
+
+// ===============================================================================================================================================================================
+
+MeshTransform Quad::generateGrid(glm::vec3 position, uint32_t resolution)
+{
+	vertices.clear();
+	indices.clear();
+
+	// Same [-1, 1] extents and uv layout as generateQuad, split into resolution x resolution quads.
+	for (uint32_t y = 0; y <= resolution; ++y) {
+		for (uint32_t x = 0; x <= resolution; ++x) {
+			float u = x / (float)resolution;
+			float v = y / (float)resolution;
+			vertices.push_back({ { -1.0f + 2.0f * u, -1.0f + 2.0f * v, 0.0f }, { 1.0f, 1.0f, 1.0f, 1.0f }, { u, 1.0f - v } });
+		}
+	}
+
+	for (uint32_t y = 0; y < resolution; ++y) {
+		for (uint32_t x = 0; x < resolution; ++x) {
+			uint16_t bottomLeft = static_cast<uint16_t>(y * (resolution + 1) + x);
+			uint16_t bottomRight = bottomLeft + 1;
+			uint16_t topLeft = static_cast<uint16_t>(bottomLeft + resolution + 1);
+			uint16_t topRight = topLeft + 1;
+			indices.insert(indices.end(), { bottomLeft, bottomRight, topRight, topRight, topLeft, bottomLeft });
+		}
+	}
+
+	MeshTransform meshData = {};
+	meshData.position = position;
+	meshData.scale = glm::vec3(1.0f);
+
+	vertexCount = vertices.size();
+	indexCount = indices.size();
+
+	return meshData;
+}
@@ -0,0 +1,56 @@
+#include "Paths.h"
+
+// ===============================================================================================================================================================================
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#elif defined(__APPLE__)
+#include <mach-o/dyld.h>
+#include <cstdint>
+#endif
+
+#include <system_error>
+#include <vector>
+
+// ===============================================================================================================================================================================
+
+std::filesystem::path getExecutableDirectory()
+{
+	static const std::filesystem::path directory = []() {
+		std::filesystem::path executable = {};
+		std::error_code error;
+#if defined(_WIN32)
+		std::vector<wchar_t> buffer(MAX_PATH);
+		DWORD length = 0;
+		while ((length = GetModuleFileNameW(nullptr, buffer.data(), static_cast<DWORD>(buffer.size()))) == buffer.size()) {
+			buffer.resize(buffer.size() * 2); // Truncated, retry with a larger buffer.
+		}
+		if (length > 0) {
+			executable = std::filesystem::path(std::wstring(buffer.data(), length));
+		}
+#elif defined(__APPLE__)
+		uint32_t size = 0;
+		_NSGetExecutablePath(nullptr, &size);
+		std::vector<char> buffer(size);
+		if (_NSGetExecutablePath(buffer.data(), &size) == 0) {
+			executable = std::filesystem::path(buffer.data());
+		}
+#else
+		executable = std::filesystem::read_symlink("/proc/self/exe", error);
+#endif
+		if (executable.empty()) {
+			return std::filesystem::current_path();
+		}
+
+		std::filesystem::path canonical = std::filesystem::weakly_canonical(executable, error);
+		return (error ? executable : canonical).parent_path();
+	}();
+	return directory;
+}
+
+std::string getShaderPath(const std::string& fileName)
+{
+	return (getExecutableDirectory() / "shaders" / fileName).string();
+}
@@ -0,0 +1,178 @@
+#include "ShaderWatcher.h"
+
+// ===============================================================================================================================================================================
+
+#include "Constants.h"
+#include "CpuProfiler.h"
+#include "Paths.h"
+
+#if defined(__linux__)
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+#include <chrono>
+#include <cstdlib>
+#include <stdexcept>
+#include <system_error>
+
+// ===============================================================================================================================================================================
+
+bool ShaderWatcher::start(const std::filesystem::path& directory)
+{
+	stop();
+
+	std::error_code error;
+	if (!std::filesystem::is_directory(directory, error)) {
+		return false;
+	}
+	this->directory = directory;
+
+#if defined(__linux__)
+	// Editors either write the file in place (close after write) or write a temporary and rename it over the source (moved to).
+	inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if (inotifyFd < 0) {
+		return false;
+	}
+	if (inotify_add_watch(inotifyFd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+		close(inotifyFd);
+		inotifyFd = -1;
+		return false;
+	}
+#else
+	// Record the current write times, so only later writes count as changes.
+	writeTimes.clear();
+	for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator(directory, error)) {
+		writeTimes[entry.path().filename().string()] = entry.last_write_time(error);
+	}
+#endif
+
+	stopping = false;
+	thread = std::thread(&ShaderWatcher::run, this);
+	return true;
+}
+
+void ShaderWatcher::stop()
+{
+	if (!thread.joinable()) {
+		return;
+	}
+
+	stopping = true;
+	thread.join();
+
+#if defined(__linux__)
+	close(inotifyFd);
+	inotifyFd = -1;
+#endif
+}
+
+std::vector<std::string> ShaderWatcher::takeChanges()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	std::vector<std::string> result(changes.begin(), changes.end());
+	changes.clear();
+	return result;
+}
+
+void ShaderWatcher::addChange(const std::string& fileName)
+{
+	if (!isShaderSource(fileName)) {
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock(mutex);
+	changes.insert(fileName);
+}
+
+void ShaderWatcher::run()
+{
+	CpuProfiler::get().setThreadName("Shader watcher");
+
+	while (!stopping) {
+#if defined(__linux__)
+		// Wake at least every kShaderWatcherPollMs to notice a stop.
+		pollfd descriptor = { inotifyFd, POLLIN, 0 };
+		if (poll(&descriptor, 1, static_cast<int>(kShaderWatcherPollMs)) <= 0) {
+			continue;
+		}
+
+		alignas(inotify_event) char buffer[4096];
+		ssize_t length = 0;
+		while ((length = read(inotifyFd, buffer, sizeof(buffer))) > 0) {
+			for (char* event = buffer; event < buffer + length; ) {
+				const inotify_event* header = reinterpret_cast<const inotify_event*>(event);
+				if (header->len > 0) {
+					addChange(header->name);
+				}
+				event += sizeof(inotify_event) + header->len;
+			}
+		}
+#else
+		// Without a portable change notification, poll the write times. A file caught mid-write fails to compile and is picked up again by
+		// the editor's next write.
+		std::this_thread::sleep_for(std::chrono::milliseconds(kShaderWatcherPollMs));
+
+		std::error_code error;
+		for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator(directory, error)) {
+			std::string fileName = entry.path().filename().string();
+			std::filesystem::file_time_type writeTime = entry.last_write_time(error);
+			if (error) {
+				continue;
+			}
+
+			auto previous = writeTimes.find(fileName);
+			if (previous == writeTimes.end() || previous->second != writeTime) {
+				writeTimes[fileName] = writeTime;
+				addChange(fileName);
+			}
+		}
+#endif
+	}
+}
+
+// ===============================================================================================================================================================================
+
+bool isShaderSource(const std::string& fileName)
+{
+	std::string extension = std::filesystem::path(fileName).extension().string();
+	return extension == ".vert" || extension == ".tesc" || extension == ".tese" || extension == ".comp" || extension == ".frag";
+}
+
+std::filesystem::path getShaderSourceDirectory()
+{
+#if defined(SHADER_SOURCE_DIR)
+	return std::filesystem::path(SHADER_SOURCE_DIR);
+#else
+	return {};
+#endif
+}
+
+void compileShader(const std::string& fileName)
+{
+	CPU_PROFILE_ZONE("compileShader");
+
+#if defined(SHADER_COMPILER)
+	std::string source = (getShaderSourceDirectory() / fileName).string();
+	std::string output = getShaderPath(fileName + ".spv");
+	std::string temporary = output + ".tmp";
+
+	std::string command = "\"" SHADER_COMPILER "\" " SHADER_COMPILER_FLAGS " -o \"" + temporary + "\" \"" + source + "\"";
+#if defined(_WIN32)
+	command = "\"" + command + "\""; // cmd.exe strips the outer quotes of a command starting with one.
+#endif
+
+	int exitCode = std::system(command.c_str());
+	std::error_code error;
+	if (exitCode != 0) {
+		std::filesystem::remove(temporary, error);
+		throw std::runtime_error("failed to compile " + fileName + ", see the compiler output!");
+	}
+
+	// Replace the previous SPIR-V in one step, so a reader never sees a partial file.
+	std::filesystem::rename(temporary, output);
+#else
+	throw std::runtime_error("cannot compile " + fileName + ", the build did not define a shader compiler!");
+#endif
+}
@@ -0,0 +1,60 @@
+#include "TaskPool.h"
+
+// ===============================================================================================================================================================================
+
+#include "Constants.h"
+#include "CpuProfiler.h"
+
+#include <algorithm>
+#include <string>
+
+// ===============================================================================================================================================================================
+
+TaskPool::TaskPool(uint32_t numThreads)
+{
+	if (numThreads == 0) {
+		uint32_t hardwareThreads = std::thread::hardware_concurrency();
+		numThreads = std::max(hardwareThreads > 1 ? hardwareThreads - 1 : 1, kTaskPoolMinThreads);
+	}
+
+	workers.reserve(numThreads);
+	for (uint32_t i = 0; i < numThreads; ++i) {
+		workers.emplace_back(&TaskPool::runWorker, this, i);
+	}
+}
+
+TaskPool::~TaskPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	condition.notify_all();
+
+	for (std::thread& worker : workers) {
+		worker.join();
+	}
+}
+
+void TaskPool::runWorker(uint32_t index)
+{
+	// Names are copied by the profiler.
+	std::string name = "Worker " + std::to_string(index);
+	CpuProfiler::get().setThreadName(name.c_str());
+
+	while (true) {
+		std::function<void()> task;
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			condition.wait(lock, [this]() { return stopping || !tasks.empty(); });
+			if (tasks.empty()) {
+				return; // Stopping with nothing left to run.
+			}
+			task = std::move(tasks.front());
+			tasks.pop_front();
+		}
+
+		// packaged_task captures exceptions into the future, so a failing task cannot take down the worker.
+		task();
+	}
+}
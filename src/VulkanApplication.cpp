@@ -5,18 +5,31 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtx/quaternion.hpp>
+#include <glm/gtc/packing.hpp>
 
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb_image.h>
 
 #include <stdexcept>
+#include <exception>
+#include <fstream>
+#include <iterator>
 #include <set>
+#include <algorithm>
+#include <cstddef>
 #include <cstdint> 
 
 #include "Utility.h"
+#include "CpuProfiler.h"
+#include "Paths.h"
+#include "ShaderWatcher.h"
 
 // ===============================================================================================================================================================================
 
+// The grass draws read their commands straight from the num blades buffer.
+static_assert(offsetof(NumBladesBufferObject, numNearVisible) == offsetof(VkDrawIndirectCommand, instanceCount), "the near draw must match VkDrawIndirectCommand.");
+static_assert(offsetof(NumBladesBufferObject, farVertexCount) == sizeof(VkDrawIndirectCommand), "the far draw must follow the near draw.");
+
 // Validation layers method of outputting notes, warnings, or errors.
 static VKAPI_ATTR VkBool32 VKAPI_CALL debugCallback( VkDebugUtilsMessageSeverityFlagBitsEXT messageSeverity, 
     VkDebugUtilsMessageTypeFlagsEXT messageType, const VkDebugUtilsMessengerCallbackDataEXT* pCallbackData, void* pUserData) 
@@ -25,6 +38,26 @@ static VKAPI_ATTR VkBool32 VKAPI_CALL debugCallback( VkDebugUtilsMessageSeverity
     return VK_FALSE;
 }
 
+// The ImGui backend can draw inside vkCmdBeginRendering from the version that takes a VkPipelineRenderingCreateInfo, older backends keep
+// windowed runs on the render pass.
+#if defined(IMGUI_IMPL_VULKAN_HAS_DYNAMIC_RENDERING) && IMGUI_VERSION_NUM >= 19090
+static constexpr bool kImGuiDynamicRendering = true;
+#else
+static constexpr bool kImGuiDynamicRendering = false;
+#endif
+
+// Present mode names for ImGui and the benchmark captures.
+static const char* getPresentModeName(VkPresentModeKHR presentMode)
+{
+    switch (presentMode) {
+    case VK_PRESENT_MODE_IMMEDIATE_KHR: return "IMMEDIATE";
+    case VK_PRESENT_MODE_MAILBOX_KHR: return "MAILBOX";
+    case VK_PRESENT_MODE_FIFO_KHR: return "FIFO";
+    case VK_PRESENT_MODE_FIFO_RELAXED_KHR: return "FIFO_RELAXED";
+    default: return "UNKNOWN";
+    }
+}
+
 static bool checkValidationLayerSupport() {
     uint32_t layerCount = 0;
     vkEnumerateInstanceLayerProperties(&layerCount, nullptr);
@@ -46,10 +79,12 @@ static bool checkValidationLayerSupport() {
     return true;
 }
 
-static std::vector<const char*> getGlfwRequiredExtensions() {
+static std::vector<const char*> getGlfwRequiredExtensions(bool headless) {
     uint32_t glfwExtensionCount = 0;
-    const char** glfwExtensions;
-    glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
+    const char** glfwExtensions = nullptr;
+    if (!headless) { // Headless runs never initialise glfw, and need no surface extensions.
+        glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
+    }
     std::vector<const char*> extensions(glfwExtensions, glfwExtensions + glfwExtensionCount);
     if (kEnableValidationLayers) {
         extensions.push_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
@@ -64,6 +99,141 @@ static std::vector<const char*> getGlfwRequiredExtensions() {
 // Device extensions.
 static const std::vector<const char*> kDeviceExtensions = { VK_KHR_SWAPCHAIN_EXTENSION_NAME };
 
+// Every SPIR-V file a pipeline may load, read ahead on the task pool before the render path is known.
+static const std::vector<std::string> kShaderFiles = {
+    "mesh.vert.spv", "terrain.vert.spv", "terrainTessControl.tesc.spv", "terrainTessEval.tese.spv", "basicShader.frag.spv", "grassCompute.comp.spv",
+    "windField.comp.spv", "grass.vert.spv", "grassTessControl.tesc.spv", "grassTessEval.tese.spv", "grassStrip.vert.spv"
+};
+
+// The SPIR-V files a pipeline is built from on the tessellated or instanced strip path, matching the create*Pipeline functions. A shader hot
+// reload rebuilds every pipeline using an edited file.
+static std::vector<std::string> getPipelineShaderFiles(ReloadablePipeline pipeline, bool tessellated) {
+    switch (pipeline) {
+    case ReloadablePipeline::Model:
+        if (tessellated) return { "mesh.vert.spv", "terrainTessControl.tesc.spv", "terrainTessEval.tese.spv", "basicShader.frag.spv" };
+        return { "terrain.vert.spv", "basicShader.frag.spv" };
+    case ReloadablePipeline::Compute: return { "grassCompute.comp.spv" };
+    case ReloadablePipeline::WindField: return { "windField.comp.spv" };
+    case ReloadablePipeline::Grass:
+        if (tessellated) return { "grass.vert.spv", "grassTessControl.tesc.spv", "grassTessEval.tese.spv", "basicShader.frag.spv" };
+        return { "grassStrip.vert.spv", "basicShader.frag.spv" };
+    default: return {};
+    }
+}
+
+// The pipeline cache on disk, and the header written in front of the driver's cache data.
+static const char* kPipelineCacheFile = "../assets/PipelineCache.bin";
+static constexpr uint32_t kPipelineCacheMagic = 0x31484350; // "PCH1"
+
+// Identifies the device and driver that produced the cache data. The driver validates its own data as well, but not every driver survives data
+// from another driver version, so anything that does not match exactly is discarded before the driver sees it.
+struct PipelineCacheFileHeader {
+    uint32_t magic = kPipelineCacheMagic;
+    uint32_t dataSize = 0;
+    uint32_t dataHash = 0;
+    uint32_t vendorID = 0;
+    uint32_t deviceID = 0;
+    uint32_t driverVersion = 0;
+    uint8_t driverUUID[VK_UUID_SIZE] = {};
+    uint8_t pipelineCacheUUID[VK_UUID_SIZE] = {};
+};
+
+// FNV-1a, enough to catch a truncated or partially written cache.
+static uint32_t hashPipelineCacheData(const char* data, size_t size) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < size; ++i) {
+        hash = (hash ^ static_cast<uint8_t>(data[i])) * 16777619u;
+    }
+    return hash;
+}
+
+static PipelineCacheFileHeader getPipelineCacheFileHeader(VkPhysicalDevice physicalDevice) {
+    VkPhysicalDeviceIDProperties idProperties = {};
+    idProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_ID_PROPERTIES;
+    VkPhysicalDeviceProperties2 properties = {};
+    properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+    properties.pNext = &idProperties;
+    vkGetPhysicalDeviceProperties2(physicalDevice, &properties);
+
+    PipelineCacheFileHeader header = {};
+    header.vendorID = properties.properties.vendorID;
+    header.deviceID = properties.properties.deviceID;
+    header.driverVersion = properties.properties.driverVersion;
+    memcpy(header.driverUUID, idProperties.driverUUID, VK_UUID_SIZE);
+    memcpy(header.pipelineCacheUUID, properties.properties.pipelineCacheUUID, VK_UUID_SIZE);
+    return header;
+}
+
+// Checks a cache file read from disk against the current device and driver. Returns why it cannot be used, or nullptr if it can.
+static const char* validatePipelineCacheFile(const std::vector<char>& contents, const PipelineCacheFileHeader& expected) {
+    PipelineCacheFileHeader header = {};
+    if (contents.size() < sizeof(header)) {
+        return "file too small";
+    }
+    memcpy(&header, contents.data(), sizeof(header));
+
+    if (header.magic != kPipelineCacheMagic) {
+        return "not a pipeline cache";
+    }
+    if (header.vendorID != expected.vendorID || header.deviceID != expected.deviceID) {
+        return "saved on another device";
+    }
+    if (header.driverVersion != expected.driverVersion || memcmp(header.driverUUID, expected.driverUUID, VK_UUID_SIZE) != 0) {
+        return "saved by another driver";
+    }
+    if (header.dataSize != contents.size() - sizeof(header) || header.dataHash != hashPipelineCacheData(contents.data() + sizeof(header), header.dataSize)) {
+        return "truncated or corrupt";
+    }
+
+    // The driver's own header, which the data must start with.
+    VkPipelineCacheHeaderVersionOne vulkanHeader = {};
+    if (header.dataSize < sizeof(vulkanHeader)) {
+        return "truncated or corrupt";
+    }
+    memcpy(&vulkanHeader, contents.data() + sizeof(header), sizeof(vulkanHeader));
+    if (vulkanHeader.headerVersion != VK_PIPELINE_CACHE_HEADER_VERSION_ONE || vulkanHeader.vendorID != expected.vendorID
+        || vulkanHeader.deviceID != expected.deviceID || memcmp(vulkanHeader.pipelineCacheUUID, expected.pipelineCacheUUID, VK_UUID_SIZE) != 0) {
+        return "incompatible cache data";
+    }
+
+    return nullptr;
+}
+
+// The range blade roots are scattered over on both axes, the ground plane's bounds without its rotation.
+static glm::vec2 getMeadowBounds() {
+    glm::vec2 offset = glm::vec2(-150.0f, 20.0f);         // Scale 120| -150, 20
+    return glm::vec2(MEADOW_SCALE_X + offset.x,           // -30.0f x | ranges [-30, +140]
+        MEADOW_SCALE_Y + offset.y);                       // 140.0f y | ranges [-30, +140]
+}
+
+// Decodes an image file to RGBA8. Only touches its own memory, so it can run on any thread.
+static DecodedImage decodeImage(const std::string& fileName) {
+    CPU_PROFILE_ZONE("decodeImage");
+
+    int texWidth, texHeight, texChannels;
+    stbi_uc* pixels = stbi_load(fileName.c_str(), &texWidth, &texHeight, &texChannels, STBI_rgb_alpha);
+    if (!pixels) {
+        throw std::runtime_error("failed to load texture image!");
+    }
+
+    DecodedImage image = {};
+    image.width = texWidth;
+    image.height = texHeight;
+    image.pixels.assign(pixels, pixels + static_cast<size_t>(texWidth) * texHeight * 4);
+    stbi_image_free(pixels);
+    return image;
+}
+
+// Map entries for a block of 4 byte specialization constants, constant_id i at offset 4 * i. Entries for ids a stage does not declare are
+// ignored, so the terrain stages can share one block.
+static std::vector<VkSpecializationMapEntry> getSpecializationMapEntries(size_t dataSize) {
+    std::vector<VkSpecializationMapEntry> mapEntries(dataSize / 4);
+    for (uint32_t i = 0; i < mapEntries.size(); ++i) {
+        mapEntries[i] = { i, i * 4u, 4u };
+    }
+    return mapEntries;
+}
+
 // ===============================================================================================================================================================================
 
 VkShaderModule VulkanApplication::createShaderModule(const std::vector<char>& code)
@@ -82,6 +252,21 @@ VkShaderModule VulkanApplication::createShaderModule(const std::vector<char>& co
 
 VkResult VulkanApplication::initialiseApplication()
 {
+    CPU_PROFILE_ZONE("initialiseApplication");
+
+    startTime = std::chrono::steady_clock::now();
+
+    // Fill the blade buffers unless a smaller count was requested, see setBladeCapacity.
+    if (sceneSettings.numBlades == 0) {
+        sceneSettings.numBlades = bladeCapacity;
+    }
+    if (sceneSettings.numBlades > bladeCapacity) {
+        throw std::runtime_error("blade count exceeds the blade capacity.");
+    }
+
+    // Blade generation, the height map decode, and shader reads only need the settings above, so they overlap everything up to their first use.
+    startInitialisationTasks();
+
     VkResult ret = createDefaultCamera();
     if (ret != VK_SUCCESS) throw std::runtime_error("Could not create camera.");
 
@@ -91,8 +276,10 @@ VkResult VulkanApplication::initialiseApplication()
     ret = createDebugMessenger();
     if (ret != VK_SUCCESS) throw std::runtime_error("Could not create debug messenger.");
 
-    ret = createGlfwSurface();
-    if (ret != VK_SUCCESS) throw std::runtime_error("Could not create surface.");
+    if (!headless) {
+        ret = createGlfwSurface();
+        if (ret != VK_SUCCESS) throw std::runtime_error("Could not create surface.");
+    }
 
     ret = createPhysicalDevice();
     if (ret != VK_SUCCESS) throw std::runtime_error("Could not create physical device.");
@@ -100,7 +287,7 @@ VkResult VulkanApplication::initialiseApplication()
     ret = createLogicalDevice();
     if (ret != VK_SUCCESS) throw std::runtime_error("Could not create logical device.");
 
-    ret = createSwapchain();
+    ret = headless ? createOffscreenTargets() : createSwapchain();
     if (ret != VK_SUCCESS) throw std::runtime_error("Could not create swapchain.");
 
     ret = createSwapchainImageViews();
@@ -112,6 +299,9 @@ VkResult VulkanApplication::initialiseApplication()
     ret = createDescriptorSetLayouts();
     if (ret != VK_SUCCESS) throw std::runtime_error("Could not create descriptor layout.");
 
+    ret = createPipelineCache();
+    if (ret != VK_SUCCESS) throw std::runtime_error("Could not create pipeline cache.");
+
     ret = createPipelines();
     if (ret != VK_SUCCESS) throw std::runtime_error("Could not create model | grass pipeline.");
 
@@ -124,9 +314,11 @@ VkResult VulkanApplication::initialiseApplication()
     ret = createCommandPool();
     if (ret != VK_SUCCESS) throw std::runtime_error("Could not create command pool.");
 
-    createMeshObjects();
+    ret = gpuProfiler.create(m_PhysicalDevice, m_LogicalDevice, graphicsQueueFamily, computeQueueFamily, framesInFlight,
+        grassRenderPath == GrassRenderPath::Tessellated);
+    if (ret != VK_SUCCESS) throw std::runtime_error("Could not create GPU profiler.");
 
-    populateBladeInstanceBuffer();
+    createMeshObjects();
 
     ret = createTextureResources();
     if (ret != VK_SUCCESS) throw std::runtime_error("Could not create image | sampler resources.");
@@ -143,6 +335,9 @@ VkResult VulkanApplication::initialiseApplication()
     ret = createUniformBuffers();
     if (ret != VK_SUCCESS) throw std::runtime_error("Could not create uniform buffer.");
 
+    ret = createColliderBuffers();
+    if (ret != VK_SUCCESS) throw std::runtime_error("Could not create collider buffer.");
+
     ret = createDescriptorPool();
     if (ret != VK_SUCCESS) throw std::runtime_error("Could not create descriptor pool.");
 
@@ -151,54 +346,127 @@ VkResult VulkanApplication::initialiseApplication()
     ret = createDescriptorSets();
     if (ret != VK_SUCCESS) throw std::runtime_error("Could not create descriptor sets.");
 
+    {
+        CPU_PROFILE_ZONE("Wait for blade generation");
+        bladeGenerationTask.get();
+    }
+
     createBladeInstanceStagingBuffer();
 
+    ret = waitForPipelines();
+    if (ret != VK_SUCCESS) throw std::runtime_error("Could not create model | grass pipeline.");
+
     ret = createCommandBuffers();
     if (ret != VK_SUCCESS) throw std::runtime_error("Could not create command buffer.");
 
     ret = createSynchronizationObjects();
     if (ret != VK_SUCCESS) throw std::runtime_error("Could not create semaphores | fences.");
 
-    ret = createImGuiImplementation();
-    if (ret != VK_SUCCESS) throw std::runtime_error("Could not create imgui implementation.");
+    if (!headless) {
+        ret = createImGuiImplementation();
+        if (ret != VK_SUCCESS) throw std::runtime_error("Could not create imgui implementation.");
+
+        // Hot reload needs the sources the build compiled, so it is off for executables moved away from their source tree.
+        if (shaderWatcher.start(getShaderSourceDirectory())) {
+            shaderReloadStatus = "watching " + shaderWatcher.getDirectory().string();
+        }
+        else {
+            shaderReloadStatus = "off, the shader sources were not found";
+        }
+    }
 
     return ret;
 }
 
 void VulkanApplication::render()
 {
+    CPU_PROFILE_ZONE("render");
+
+    // A minimised window has no extent to render at. Block until its next event instead of spinning, but return to the main loop so it
+    // keeps handling input and closing.
+    if (!headless) {
+        int width = 0, height = 0;
+        glfwGetFramebufferSize(window, &width, &height);
+        if (width == 0 || height == 0) {
+            glfwWaitEvents();
+            return;
+        }
+    }
+
+    // Frame boundary, nothing is being recorded so reloaded pipelines can be swapped in.
+    updateShaderHotReload();
+
+    // The only point the CPU waits on the GPU, and only once the ring of frames in flight is full.
+    waitForFrameSlot();
+    updateRetiredSwapchains();
+
     // Compute pipeline stage:
 
-    // Re-sync and reset.
-    vkWaitForFences(m_LogicalDevice, 1, &computeInFlightFences[currentFrame], VK_TRUE, UINT64_MAX);
-    vkResetFences(m_LogicalDevice, 1, &computeInFlightFences[currentFrame]);
     vkResetCommandBuffer(computeCommandBuffers[currentFrame], 0);
 
+    // The compute pass that last read this frame's collider buffer has finished, so it can be rebuilt.
+    updateColliderBuffer(currentFrame);
+
+    // Update camera data buffer, read by the culling pass as well as the draws.
+    updateUniformBuffer(currentFrame);
+
+    // The blade counts this frame slot culled framesInFlight frames ago, before recording resets them.
+    retrieveNumVisibleBlades();
+
     // Record command buffer.
     recordComputeCommandBuffer(computeCommandBuffers[currentFrame]);
 
+    // The draws are recorded on the task pool while the compute pass is submitted and the image acquired, recordCommandBuffer waits for them.
+    startSecondaryRecording();
+
+    // Recording resolved the GPU scopes this frame slot recorded framesInFlight frames ago, pair them with that frame's submit time for
+    // the CPU profiler's trace.
+    CpuProfiler::get().addGpuFrame({ frameSubmitTimes[currentFrame], gpuProfiler.getLastTimestamps() });
+    frameSubmitTimes[currentFrame] = CpuProfiler::now();
+
+    uint64_t computeSignalValue = ++computeTimelineValue;
+    VkTimelineSemaphoreSubmitInfo computeTimelineInfo = {};
+    computeTimelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+    computeTimelineInfo.signalSemaphoreValueCount = 1;
+    computeTimelineInfo.pSignalSemaphoreValues = &computeSignalValue;
+
     VkSubmitInfo computeSubmitInfo = {};
     computeSubmitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    computeSubmitInfo.pNext = &computeTimelineInfo;
     computeSubmitInfo.commandBufferCount = 1;
     computeSubmitInfo.pCommandBuffers = &computeCommandBuffers[currentFrame];
     computeSubmitInfo.signalSemaphoreCount = 1;
-    computeSubmitInfo.pSignalSemaphores = &computeFinishedSemaphores[currentFrame];
-    if (vkQueueSubmit(computeQueue, 1, &computeSubmitInfo, computeInFlightFences[currentFrame]) != VK_SUCCESS) {
+    computeSubmitInfo.pSignalSemaphores = &computeTimeline;
+    if (vkQueueSubmit(computeQueue, 1, &computeSubmitInfo, VK_NULL_HANDLE) != VK_SUCCESS) {
         throw std::runtime_error("failed to submit compute command buffer!");
     }
+    frameComputeValues[currentFrame] = computeSignalValue;
 
     // Graphics render stage:
 
-    // Sync between stages.
-    vkWaitForFences(m_LogicalDevice, 1, &inFlightFences[currentFrame], VK_TRUE, UINT64_MAX); 
+    // Headless runs render into their own offscreen image per-frame in flight, with nothing to acquire or present.
+    if (headless) {
+        vkResetCommandBuffer(commandBuffers[currentFrame], 0);
+        recordCommandBuffer(commandBuffers[currentFrame], currentFrame);
+        submitGraphicsCommandBuffer(VK_NULL_HANDLE, VK_NULL_HANDLE);
 
-    // Update camera data buffer.
-    updateUniformBuffer(currentFrame);
+        currentFrame = (currentFrame + 1) % framesInFlight;
+        frameCount++;
+        return;
+    }
 
     // Swap to next swapchain image.
     uint32_t imageIndex;
-    VkResult ret = vkAcquireNextImageKHR(m_LogicalDevice, swapchainData.handle, UINT64_MAX, imageAvailableSemaphores[currentFrame], VK_NULL_HANDLE, &imageIndex);
+    VkResult ret = VK_SUCCESS;
+    {
+        CPU_PROFILE_ZONE("Acquire swapchain image");
+        ret = vkAcquireNextImageKHR(m_LogicalDevice, swapchainData.handle, UINT64_MAX, imageAvailableSemaphores[currentFrame], VK_NULL_HANDLE, &imageIndex);
+    }
     if (ret == VK_ERROR_OUT_OF_DATE_KHR) {
+        // The compute submit above is on the timeline, so the slot waits for it when it is next used rather than leaving a semaphore signalled.
+        // The secondary command buffers recorded for the frame are never executed, so their scopes are not resolved either.
+        waitForSecondaryRecording();
+        gpuProfiler.clearGraphicsScopes(currentFrame);
         recreateSwapchain();
         return;
     }
@@ -206,25 +474,9 @@ void VulkanApplication::render()
         throw std::runtime_error("failed to acquire swap chain image!");
     }
 
-    // Re-sync and reset.
-    vkResetFences(m_LogicalDevice, 1, &inFlightFences[currentFrame]);
     vkResetCommandBuffer(commandBuffers[currentFrame], 0);
     recordCommandBuffer(commandBuffers[currentFrame], imageIndex);
-
-    std::array<VkSemaphore, 2> waitSemaphores = { computeFinishedSemaphores[currentFrame], imageAvailableSemaphores[currentFrame] };
-    std::array<VkPipelineStageFlags, 2> waitStages = { VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
-    VkSubmitInfo graphicsSubmitInfo = {};
-    graphicsSubmitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-    graphicsSubmitInfo.waitSemaphoreCount = static_cast<uint32_t>(waitSemaphores.size());
-    graphicsSubmitInfo.pWaitSemaphores = waitSemaphores.data();
-    graphicsSubmitInfo.pWaitDstStageMask = waitStages.data();
-    graphicsSubmitInfo.commandBufferCount = 1;
-    graphicsSubmitInfo.pCommandBuffers = &commandBuffers[currentFrame];
-    graphicsSubmitInfo.signalSemaphoreCount = 1;
-    graphicsSubmitInfo.pSignalSemaphores = &renderFinishedSemaphores[currentFrame]; // Signal this so present can wait for this.
-    if (vkQueueSubmit(graphicsQueue, 1, &graphicsSubmitInfo, inFlightFences[currentFrame]) != VK_SUCCESS) {
-        throw std::runtime_error("failed to submit draw command buffer!");
-    }
+    submitGraphicsCommandBuffer(imageAvailableSemaphores[currentFrame], renderFinishedSemaphores[currentFrame]);
 
     VkSwapchainKHR swapChains[] = { swapchainData.handle };
     VkPresentInfoKHR presentInfo = {};
@@ -235,7 +487,18 @@ void VulkanApplication::render()
     presentInfo.pSwapchains = swapChains;
     presentInfo.pImageIndices = &imageIndex;
     presentInfo.pResults = nullptr; 
-    ret = vkQueuePresentKHR(presentQueue, &presentInfo); // Send all image data to the screen, this will render this frame and begin the vertex shader.
+    {
+        CPU_PROFILE_ZONE("Present");
+        ret = vkQueuePresentKHR(presentQueue, &presentInfo); // Send all image data to the screen, this will render this frame and begin the vertex shader.
+    }
+
+    // CPU latency from polling this frame's input to queueing its present. The compositor and scan-out come after, and would need a present
+    // timing extension to measure.
+    if (inputTimestampNs != 0) {
+        lastInputToPresentMs = static_cast<float>((CpuProfiler::now() - inputTimestampNs) * 1e-6);
+        averageInputToPresentMs = (averageInputToPresentMs > 0.0f) ? averageInputToPresentMs + (lastInputToPresentMs - averageInputToPresentMs) * kLatencySmoothing : lastInputToPresentMs;
+        inputTimestampNs = 0;
+    }
 
     // Re-initialise swapchain if necessary.
     if (ret == VK_ERROR_OUT_OF_DATE_KHR || ret == VK_SUBOPTIMAL_KHR || framebufferResized) {
@@ -246,13 +509,68 @@ void VulkanApplication::render()
         throw std::runtime_error("failed to present swap chain image!");
     }
 
-    // Frame complete, increment frame and wrap if it goes beyond max frames in flight.
-    currentFrame = (currentFrame + 1) % kMaxFramesInFlight;
+    // Frame complete, increment frame and wrap if it goes beyond the frames in flight.
+    currentFrame = (currentFrame + 1) % framesInFlight;
     frameCount++;
 }
 
+void VulkanApplication::waitForFrameSlot()
+{
+    CPU_PROFILE_ZONE("Wait for frame slot");
+
+    // Both values are 0 until the slot's first frame, which every timeline starts at.
+    std::array<VkSemaphore, 2> semaphores = { computeTimeline, graphicsTimeline };
+    std::array<uint64_t, 2> values = { frameComputeValues[currentFrame], frameGraphicsValues[currentFrame] };
+
+    VkSemaphoreWaitInfo waitInfo = {};
+    waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+    waitInfo.semaphoreCount = static_cast<uint32_t>(semaphores.size());
+    waitInfo.pSemaphores = semaphores.data();
+    waitInfo.pValues = values.data();
+    if (vkWaitSemaphores(m_LogicalDevice, &waitInfo, UINT64_MAX) != VK_SUCCESS) {
+        throw std::runtime_error("failed to wait for a frame slot!");
+    }
+}
+
+void VulkanApplication::submitGraphicsCommandBuffer(VkSemaphore imageAvailable, VkSemaphore renderFinished)
+{
+    // The draws wait for this frame's compute pass from the indirect draw reads on, the first stage that uses its results. Binary semaphore
+    // values are ignored, but the value arrays must still match the semaphore counts.
+    uint64_t graphicsSignalValue = ++graphicsTimelineValue;
+    std::array<VkSemaphore, 2> waitSemaphores = { computeTimeline, imageAvailable };
+    std::array<uint64_t, 2> waitValues = { frameComputeValues[currentFrame], 0 };
+    std::array<VkPipelineStageFlags, 2> waitStages = { VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
+    std::array<VkSemaphore, 2> signalSemaphores = { graphicsTimeline, renderFinished }; // Signal the binary semaphore so present can wait for this.
+    std::array<uint64_t, 2> signalValues = { graphicsSignalValue, 0 };
+    uint32_t semaphoreCount = (imageAvailable != VK_NULL_HANDLE) ? 2 : 1;
+
+    VkTimelineSemaphoreSubmitInfo timelineInfo = {};
+    timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+    timelineInfo.waitSemaphoreValueCount = semaphoreCount;
+    timelineInfo.pWaitSemaphoreValues = waitValues.data();
+    timelineInfo.signalSemaphoreValueCount = semaphoreCount;
+    timelineInfo.pSignalSemaphoreValues = signalValues.data();
+
+    VkSubmitInfo graphicsSubmitInfo = {};
+    graphicsSubmitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    graphicsSubmitInfo.pNext = &timelineInfo;
+    graphicsSubmitInfo.waitSemaphoreCount = semaphoreCount;
+    graphicsSubmitInfo.pWaitSemaphores = waitSemaphores.data();
+    graphicsSubmitInfo.pWaitDstStageMask = waitStages.data();
+    graphicsSubmitInfo.commandBufferCount = 1;
+    graphicsSubmitInfo.pCommandBuffers = &commandBuffers[currentFrame];
+    graphicsSubmitInfo.signalSemaphoreCount = semaphoreCount;
+    graphicsSubmitInfo.pSignalSemaphores = signalSemaphores.data();
+    if (vkQueueSubmit(graphicsQueue, 1, &graphicsSubmitInfo, VK_NULL_HANDLE) != VK_SUCCESS) {
+        throw std::runtime_error("failed to submit draw command buffer!");
+    }
+    frameGraphicsValues[currentFrame] = graphicsSignalValue;
+}
+
 void VulkanApplication::updateUniformBuffer(uint32_t currentFrame)
 {
+    CPU_PROFILE_ZONE("updateUniformBuffer");
+
     static auto startTime = std::chrono::high_resolution_clock::now();
     auto currentTime = std::chrono::high_resolution_clock::now();
     float time = std::chrono::duration<float, std::chrono::seconds::period>(currentTime - startTime).count();
@@ -278,16 +596,42 @@ void VulkanApplication::updateUniformBuffer(uint32_t currentFrame)
     ubo.view = camera->getViewMatrix();
     ubo.proj = projectionMatrix;
 
-    // Copy the contents of the ubo structure into a mapped memory location effectively updating the uniform buffer with the most recent data.
-    void* data;
-    vkMapMemory(m_LogicalDevice, uniformBufferMemory, 0, sizeof(ubo), 0, &data);
-    memcpy(data, &ubo, sizeof(ubo));
-    vkUnmapMemory(m_LogicalDevice, uniformBufferMemory);
+    // Copy the contents of the ubo structure into this frame's persistently mapped uniform buffer, the frames in flight keep reading their own.
+    memcpy(uniformBufferMapped[currentFrame], &ubo, sizeof(ubo));
+}
+
+void VulkanApplication::updateColliderBuffer(uint32_t currentFrame)
+{
+    CPU_PROFILE_ZONE("updateColliderBuffer");
+
+    colliders.clear();
+
+    // A ball resting on the ground below the camera, so the grass can be walked through.
+    if (colliderParameters.cameraCollider) {
+        float radius = colliderParameters.cameraColliderRadius;
+        colliders.push_back(glm::vec4(camera->position.x, camera->position.y, radius, radius));
+    }
+
+    // Balls spread over several rings around the middle of the meadow, alternating direction per-ring.
+    const glm::vec2 meadowCentre = glm::vec2(kColliderGridOrigin + kColliderGridWorldSize * 0.5f);
+    const uint32_t numRings = 8;
+    float elapsed = static_cast<float>(getElapsedTime());
+    for (int i = 0; i < colliderParameters.numOrbitingColliders; ++i) {
+        uint32_t ring = i % numRings;
+        float ringRadius = kColliderGridWorldSize * 0.05f * (ring + 1);
+        float direction = (ring % 2 == 0) ? 1.0f : -1.0f;
+        float angle = direction * elapsed * colliderParameters.orbitSpeed + glm::radians(360.0f) * i / colliderParameters.numOrbitingColliders;
+        float radius = colliderParameters.orbitingColliderRadius;
+        colliders.push_back(glm::vec4(meadowCentre + ringRadius * glm::vec2(cos(angle), sin(angle)), radius, radius));
+    }
+
+    ColliderGrid::build(colliders, *static_cast<ColliderBufferObject*>(colliderBufferMapped[currentFrame]));
 }
 
 VkResult VulkanApplication::createInstance() {   
+    CPU_PROFILE_ZONE("createInstance");
 
-    auto extensions = getGlfwRequiredExtensions();
+    auto extensions = getGlfwRequiredExtensions(headless);
 
     if (kEnableValidationLayers && !checkValidationLayerSupport()) {
         throw std::runtime_error("validation layers requested, but not available!");
@@ -334,6 +678,8 @@ VkResult VulkanApplication::createInstance() {
 
 VkResult VulkanApplication::createDebugMessenger()
 {
+    CPU_PROFILE_ZONE("createDebugMessenger");
+
     // If the validation layers aren't enabled, we don't want to return an error but m_DebugMessenger will be VK_NULL_HANDLE.
     if (!kEnableValidationLayers) return VK_SUCCESS;
 
@@ -350,6 +696,8 @@ VkResult VulkanApplication::createDebugMessenger()
 
 VkResult VulkanApplication::createPhysicalDevice()
 {
+    CPU_PROFILE_ZONE("createPhysicalDevice");
+
     uint32_t deviceCount = 0;
     vkEnumeratePhysicalDevices(m_VkInstance, &deviceCount, nullptr);
     if (deviceCount <= 0) {
@@ -359,25 +707,24 @@ VkResult VulkanApplication::createPhysicalDevice()
 
     std::vector<VkPhysicalDevice> devices(deviceCount);
     vkEnumeratePhysicalDevices(m_VkInstance, &deviceCount, devices.data());
+
+    // Prefer a discrete GPU that can tessellate, then any device that can tessellate, then any device that can at least draw the instanced strip path.
+    int bestScore = -1;
     for (const auto& device : devices) {
-        if (checkPhysicalDeviceSuitability(device)) {
-            m_PhysicalDevice = device;
-            break;
+        if (!checkPhysicalDeviceSuitability(device)) {
+            continue;
         }
-    }
 
-    // Initialise driver data to display in ImGui.
-    for (int i = 0; i < deviceCount; ++i) {
-        VkPhysicalDeviceProperties deviceProperties = {};
-        memset(&deviceProperties, 0, sizeof(deviceProperties));
-        vkGetPhysicalDeviceProperties(devices[i], &deviceProperties);
-        driverData.name = deviceProperties.deviceName;
-        driverData.version = deviceProperties.driverVersion;
-        driverData.versionMajor = (deviceProperties.driverVersion >> 22) & 0X3FF;
-        driverData.versionMinor = (deviceProperties.driverVersion >> 12) & 0X3FF;
-        driverData.apiMajor = (deviceProperties.apiVersion >> 22) & 0X3FF;
-        driverData.apiMinor = (deviceProperties.apiVersion >> 12) & 0X3FF;
-        driverData.apiPatch = deviceProperties.apiVersion & 0X3FF;
+        VkPhysicalDeviceProperties properties = {};
+        vkGetPhysicalDeviceProperties(device, &properties);
+
+        int score = 0;
+        score += checkPhysicalDeviceTessellationSupport(device) ? 2 : 0;
+        score += (properties.deviceType == VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU) ? 1 : 0;
+        if (score > bestScore) {
+            bestScore = score;
+            m_PhysicalDevice = device;
+        }
     }
 
     if (m_PhysicalDevice == VK_NULL_HANDLE) {
@@ -385,43 +732,82 @@ VkResult VulkanApplication::createPhysicalDevice()
         return VK_ERROR_INCOMPATIBLE_DRIVER;
     }
 
+    vkGetPhysicalDeviceProperties(m_PhysicalDevice, &deviceProperties);
+    vkGetPhysicalDeviceFeatures(m_PhysicalDevice, &deviceFeatures);
+
+    // Devices without tessellation draw the grass as instanced triangle strips and the terrain as a pre-subdivided grid.
+    bool useTessellation = checkPhysicalDeviceTessellationSupport(m_PhysicalDevice) && !kForceInstancedStripFallback;
+    grassRenderPath = useTessellation ? GrassRenderPath::Tessellated : GrassRenderPath::InstancedStrip;
+
+    // Initialise driver data to display in ImGui.
+    driverData.name = deviceProperties.deviceName;
+    driverData.version = deviceProperties.driverVersion;
+    driverData.versionMajor = (deviceProperties.driverVersion >> 22) & 0X3FF;
+    driverData.versionMinor = (deviceProperties.driverVersion >> 12) & 0X3FF;
+    driverData.apiMajor = (deviceProperties.apiVersion >> 22) & 0X3FF;
+    driverData.apiMinor = (deviceProperties.apiVersion >> 12) & 0X3FF;
+    driverData.apiPatch = deviceProperties.apiVersion & 0X3FF;
+
     return VK_SUCCESS;
 }
 
 VkResult VulkanApplication::createLogicalDevice()
 {
-    float queuePriority = 1.0f;
+    CPU_PROFILE_ZONE("createLogicalDevice");
+
+    float queuePriorities[] = { 1.0f, 1.0f };
 
     QueueFamilyIndices indices = findQueueFamilies(m_PhysicalDevice, m_SurfaceKHR);
+    asyncCompute = asyncCompute && indices.asyncComputeFamily.has_value();
+    graphicsQueueFamily = indices.graphicsAndComputeFamily.value();
+    computeQueueFamily = asyncCompute ? indices.asyncComputeFamily.value() : graphicsQueueFamily;
+    uint32_t computeQueueIndex = asyncCompute ? indices.asyncComputeQueueIndex : 0;
+    dynamicRendering = dynamicRendering && checkPhysicalDeviceDynamicRenderingSupport(m_PhysicalDevice) && (headless || kImGuiDynamicRendering);
+
     std::vector<VkDeviceQueueCreateInfo> queueCreateInfos;
     std::set<uint32_t> uniqueQueueFamilies = { 
         indices.graphicsAndComputeFamily.value(), 
-        indices.presentFamily.value() 
+        indices.presentFamily.value(),
+        computeQueueFamily
     };
 
     for (uint32_t queueFamily : uniqueQueueFamilies) {
         VkDeviceQueueCreateInfo queueCreateInfo{};
         queueCreateInfo.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
         queueCreateInfo.queueFamilyIndex = queueFamily;
-        queueCreateInfo.queueCount = 1;
-        queueCreateInfo.pQueuePriorities = &queuePriority;
+        queueCreateInfo.queueCount = (queueFamily == computeQueueFamily) ? computeQueueIndex + 1 : 1; // A second graphics queue for async compute.
+        queueCreateInfo.pQueuePriorities = queuePriorities;
         queueCreateInfos.push_back(queueCreateInfo);
     }
 
-    VkPhysicalDeviceFeatures deviceFeatures = {};
-    deviceFeatures.fillModeNonSolid = VK_TRUE; // Enable Vulkan to use VK_POLYGON_MODE_POINT or LINE.
-    deviceFeatures.samplerAnisotropy = VK_TRUE; // Enable Vulkan to support anisotropic filtering.
-    deviceFeatures.tessellationShader = VK_TRUE; // Enable Vulkan to be able to link and execute tessellation shaders.
-    deviceFeatures.shaderTessellationAndGeometryPointSize = VK_TRUE; // Enable Vulkan to allow the use of gl_PointSize within tessellation shaders.
-    deviceFeatures.multiDrawIndirect = VK_TRUE; // Enable Vulkan to allow the use of indirect draw commands.
+    // Only enable what the device supports, the instanced strip path does not need any of the tessellation features.
+    bool useTessellation = grassRenderPath == GrassRenderPath::Tessellated;
+    VkPhysicalDeviceFeatures enabledFeatures = {};
+    enabledFeatures.fillModeNonSolid = deviceFeatures.fillModeNonSolid; // Enable Vulkan to use VK_POLYGON_MODE_POINT or LINE.
+    enabledFeatures.samplerAnisotropy = deviceFeatures.samplerAnisotropy; // Enable Vulkan to support anisotropic filtering.
+    enabledFeatures.tessellationShader = useTessellation ? VK_TRUE : VK_FALSE; // Enable Vulkan to be able to link and execute tessellation shaders.
+    enabledFeatures.shaderTessellationAndGeometryPointSize = useTessellation ? VK_TRUE : VK_FALSE; // Enable Vulkan to allow the use of gl_PointSize within tessellation shaders.
+    enabledFeatures.multiDrawIndirect = deviceFeatures.multiDrawIndirect; // Enable Vulkan to allow the use of indirect draw commands.
+    enabledFeatures.pipelineStatisticsQuery = deviceFeatures.pipelineStatisticsQuery; // Enable Vulkan to count shader invocations and primitives per-pass.
+
+    // Frame pacing waits on one timeline semaphore per queue, required by checkPhysicalDeviceSuitability.
+    VkPhysicalDeviceVulkan12Features enabledVulkan12Features = {};
+    enabledVulkan12Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+    enabledVulkan12Features.timelineSemaphore = VK_TRUE;
+
+    VkPhysicalDeviceVulkan13Features enabledVulkan13Features = {};
+    enabledVulkan13Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES;
+    enabledVulkan13Features.dynamicRendering = VK_TRUE;
+    enabledVulkan12Features.pNext = dynamicRendering ? &enabledVulkan13Features : nullptr;
 
     VkDeviceCreateInfo createInfo = {};
     createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+    createInfo.pNext = &enabledVulkan12Features;
     createInfo.queueCreateInfoCount = static_cast<uint32_t>(queueCreateInfos.size());
     createInfo.pQueueCreateInfos = queueCreateInfos.data();
-    createInfo.pEnabledFeatures = &deviceFeatures;
-    createInfo.enabledExtensionCount = static_cast<uint32_t>(kDeviceExtensions.size());
-    createInfo.ppEnabledExtensionNames = kDeviceExtensions.data();
+    createInfo.pEnabledFeatures = &enabledFeatures;
+    createInfo.enabledExtensionCount = headless ? 0 : static_cast<uint32_t>(kDeviceExtensions.size());
+    createInfo.ppEnabledExtensionNames = headless ? nullptr : kDeviceExtensions.data();
 
     if (kEnableValidationLayers) {
         createInfo.enabledLayerCount = static_cast<uint32_t>(kValidationLayers.size());
@@ -437,7 +823,7 @@ VkResult VulkanApplication::createLogicalDevice()
     }
 
     vkGetDeviceQueue(m_LogicalDevice, indices.graphicsAndComputeFamily.value(), 0, &graphicsQueue); 
-    vkGetDeviceQueue(m_LogicalDevice, indices.graphicsAndComputeFamily.value(), 0, &computeQueue); 
+    vkGetDeviceQueue(m_LogicalDevice, computeQueueFamily, computeQueueIndex, &computeQueue); 
     vkGetDeviceQueue(m_LogicalDevice, indices.presentFamily.value(), 0, &presentQueue);
 
     return VK_SUCCESS;
@@ -445,6 +831,8 @@ VkResult VulkanApplication::createLogicalDevice()
 
 VkResult VulkanApplication::createGlfwSurface()
 {
+    CPU_PROFILE_ZONE("createGlfwSurface");
+
     if (glfwCreateWindowSurface(m_VkInstance, window, nullptr, &m_SurfaceKHR) != VK_SUCCESS) {
         throw std::runtime_error("failed to create glfw window surface!");
         return VK_ERROR_INITIALIZATION_FAILED;
@@ -455,12 +843,14 @@ VkResult VulkanApplication::createGlfwSurface()
 
 VkResult VulkanApplication::createSwapchain()
 {
+    CPU_PROFILE_ZONE("createSwapchain");
+
     SwapChain swapChainSupport = checkSwapchainSupport(m_PhysicalDevice);
 
     VkSurfaceFormatKHR surfaceFormat = chooseSwapchainSurfaceFormat(swapChainSupport.formats);
     VkPresentModeKHR presentMode = chooseSwapPresentMode(swapChainSupport.presentModes);
     VkExtent2D extent = chooseSwapExtent(window, swapChainSupport.capabilities);
-    uint32_t imageCount = swapChainSupport.capabilities.minImageCount + 1;
+    uint32_t imageCount = (requestedImageCount > 0) ? std::max(requestedImageCount, swapChainSupport.capabilities.minImageCount) : swapChainSupport.capabilities.minImageCount + 1;
     if (swapChainSupport.capabilities.maxImageCount > 0 && imageCount > swapChainSupport.capabilities.maxImageCount) {
         imageCount = swapChainSupport.capabilities.maxImageCount;
     }
@@ -491,7 +881,7 @@ VkResult VulkanApplication::createSwapchain()
     createInfo.compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
     createInfo.presentMode = presentMode;
     createInfo.clipped = VK_TRUE;
-    createInfo.oldSwapchain = VK_NULL_HANDLE;
+    createInfo.oldSwapchain = swapchainData.handle; // The swapchain being replaced on a resize, lets the driver reuse its resources.
 
     if (vkCreateSwapchainKHR(m_LogicalDevice, &createInfo, nullptr, &swapchainData.handle) != VK_SUCCESS) {
         throw std::runtime_error("failed to create swap chain!");
@@ -503,23 +893,73 @@ VkResult VulkanApplication::createSwapchain()
     vkGetSwapchainImagesKHR(m_LogicalDevice, swapchainData.handle, &imageCount, swapchainData.images.data());
     swapchainData.imageFormat = surfaceFormat.format;
     swapchainData.extents = extent;
+    swapchainData.presentMode = presentMode;
+    swapchainData.capabilities = swapChainSupport.capabilities;
+    swapchainData.presentModes = swapChainSupport.presentModes;
+
+    return VK_SUCCESS;
+}
+
+VkResult VulkanApplication::createOffscreenTargets()
+{
+    CPU_PROFILE_ZONE("createOffscreenTargets");
+
+    // One colour image per-frame in flight stands in for the swapchain images, so the image views, render pass, and framebuffers are
+    // created exactly as they are for a window. The images end each frame in TRANSFER_SRC_OPTIMAL, ready to be read back.
+    swapchainData.imageFormat = VK_FORMAT_R8G8B8A8_UNORM;
+    swapchainData.extents = headlessExtent;
+    swapchainData.images.resize(framesInFlight);
+    offscreenImageMemory.resize(framesInFlight);
+
+    for (size_t i = 0; i < framesInFlight; i++) {
+        ImageCreateInfo offscreenImageInfo = {};
+        offscreenImageInfo.width = headlessExtent.width;
+        offscreenImageInfo.height = headlessExtent.height;
+        offscreenImageInfo.mipLevels = 1;
+        offscreenImageInfo.numSamples = VK_SAMPLE_COUNT_1_BIT;
+        offscreenImageInfo.format = swapchainData.imageFormat;
+        offscreenImageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+        offscreenImageInfo.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+        offscreenImageInfo.properties = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+        offscreenImageInfo.pImage = &swapchainData.images[i];
+        offscreenImageInfo.pImageMemory = &offscreenImageMemory[i];
+
+        VkResult ret = createImage(offscreenImageInfo);
+        if (ret != VK_SUCCESS) {
+            throw std::runtime_error("bad offscreen image creation.");
+            return ret;
+        }
+    }
 
     return VK_SUCCESS;
 }
 
 VkResult VulkanApplication::recreateSwapchain()
 {
+    CPU_PROFILE_ZONE("recreateSwapchain");
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    // Minimised, render() skips frames until the window is restored and the next present recreates it.
     int width = 0, height = 0;
     glfwGetFramebufferSize(window, &width, &height);
-    while (width == 0 || height == 0) {
-        glfwGetFramebufferSize(window, &width, &height);
-        glfwWaitEvents();
+    if (width == 0 || height == 0) {
+        framebufferResized = true;
+        return VK_SUCCESS;
     }
 
-    vkDeviceWaitIdle(m_LogicalDevice);
-
-    swapchainData.cleanupSwapchain(m_LogicalDevice);
-
+    // Frames still in flight keep rendering to and presenting the old images, so rather than idling the device they are retired along with
+    // the depth attachment of their framebuffers. The last frame that used them was submitted with graphicsTimelineValue. Presentation has
+    // no completion signal without VK_EXT_swapchain_maintenance1, so its release of the old images is assumed once framesInFlight more
+    // frames have completed.
+    RetiredSwapchain retired = {};
+    retired.swapchain = swapchainData;
+    retired.depthImage = depthImage;
+    retired.depthImageView = depthImageView;
+    retired.depthImageMemory = depthImageMemory;
+    retired.graphicsValue = graphicsTimelineValue + framesInFlight;
+
+    // Passes the current handle as oldSwapchain, then replaces it.
     VkResult ret = createSwapchain();
     if (ret != VK_SUCCESS) {
         throw std::runtime_error("bad swapchain.");
@@ -538,17 +978,45 @@ VkResult VulkanApplication::recreateSwapchain()
         return ret;
     }
 
+    // Skipped with dynamic rendering, which attaches the new image views directly.
     ret = createFrameBuffers(); 
     if (ret != VK_SUCCESS) {
         throw std::runtime_error("bad frame buffers.");
         return ret; 
     }
 
+    retiredSwapchains.push_back(retired);
+
+    double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    swapchainRecreationStats.count++;
+    swapchainRecreationStats.lastMs = milliseconds;
+    swapchainRecreationStats.totalMs += milliseconds;
+    swapchainRecreationStats.maxMs = std::max(swapchainRecreationStats.maxMs, milliseconds);
+
     return ret;
 }
 
+void VulkanApplication::updateRetiredSwapchains()
+{
+    if (retiredSwapchains.empty()) {
+        return;
+    }
+
+    uint64_t completedGraphics = 0;
+    vkGetSemaphoreCounterValue(m_LogicalDevice, graphicsTimeline, &completedGraphics);
+    std::erase_if(retiredSwapchains, [&](RetiredSwapchain& retired) {
+        if (completedGraphics < retired.graphicsValue) {
+            return false;
+        }
+        retired.destroy(m_LogicalDevice);
+        return true;
+    });
+}
+
 VkResult VulkanApplication::createSwapchainImageViews()
 {
+    CPU_PROFILE_ZONE("createSwapchainImageViews");
+
     swapchainData.imageViews.resize(swapchainData.images.size());
 
     for (size_t i = 0; i < swapchainData.images.size(); i++) {
@@ -577,6 +1045,20 @@ VkResult VulkanApplication::createSwapchainImageViews()
 
 VkResult VulkanApplication::createRenderPass()
 {
+    CPU_PROFILE_ZONE("createRenderPass");
+
+    // Dynamic rendering only needs the attachment formats up front, the layout transitions the render pass would make are barriers in
+    // recordCommandBuffer. The stencil aspect of a combined depth format is never attached, so it is left undefined.
+    pipelineRenderingInfo = {};
+    pipelineRenderingInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO;
+    pipelineRenderingInfo.colorAttachmentCount = 1;
+    pipelineRenderingInfo.pColorAttachmentFormats = &swapchainData.imageFormat;
+    pipelineRenderingInfo.depthAttachmentFormat = findDepthFormat();
+    pipelineRenderingInfo.stencilAttachmentFormat = VK_FORMAT_UNDEFINED;
+    if (dynamicRendering) {
+        return VK_SUCCESS;
+    }
+
     VkAttachmentDescription colorAttachment = {};
     colorAttachment.format = swapchainData.imageFormat;
     colorAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
@@ -585,14 +1067,14 @@ VkResult VulkanApplication::createRenderPass()
     colorAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
     colorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
     colorAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-    colorAttachment.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+    colorAttachment.finalLayout = headless ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
 
     VkAttachmentReference colorAttachmentRef = {};
     colorAttachmentRef.attachment = 0;
     colorAttachmentRef.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
 
     VkAttachmentDescription depthAttachment = {};
-    depthAttachment.format = findDepthFormat();
+    depthAttachment.format = pipelineRenderingInfo.depthAttachmentFormat;
     depthAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
     depthAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
     depthAttachment.storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
@@ -640,6 +1122,8 @@ VkResult VulkanApplication::createRenderPass()
 
 VkResult VulkanApplication::createDescriptorSetLayouts()
 {
+    CPU_PROFILE_ZONE("createDescriptorSetLayouts");
+
     // Define the type of descriptor/shader resources you will want.
 
     //
@@ -664,58 +1148,342 @@ VkResult VulkanApplication::createDescriptorSetLayouts()
         return ret;
     }
 
+    //
+    // Create a descriptor set layout for the wind field as a storage image.
+    //
+
+    ret = createWindFieldDescriptorSetLayout();
+    if (ret != VK_SUCCESS) {
+        throw std::runtime_error("could not create wind field descriptor set layout.");
+        return ret;
+    }
+
     return ret;
 }
 
+void VulkanApplication::startInitialisationTasks()
+{
+    CPU_PROFILE_ZONE("startInitialisationTasks");
+
+    // Queued first so the pipeline tasks that read them are always behind them in the queue: by the time a worker picks up a pipeline, every
+    // read has been started by another worker, and waiting on it cannot starve the pool.
+    for (const std::string& fileName : kShaderFiles) {
+        shaderCodeTasks[fileName] = taskPool.submit([fileName]() {
+            CPU_PROFILE_ZONE("readShaderFile");
+            return Utils::readFile(getShaderPath(fileName));
+        }).share();
+    }
+
+    heightMapDecodeTask = taskPool.submit([]() { return decodeImage("../assets/RollingHillsHeightMap.png"); });
+
+    // Utils::getRandomFloat is not thread-safe, nothing else draws random numbers until this is waited on.
+    bladeGenerationTask = taskPool.submit([this]() { populateBladeInstanceBuffer(); });
+}
+
+std::vector<char> VulkanApplication::getShaderCode(const std::string& fileName) const
+{
+    auto task = shaderCodeTasks.find(fileName);
+    if (task == shaderCodeTasks.end()) {
+        return Utils::readFile(getShaderPath(fileName));
+    }
+
+    // Each thread waits through its own copy of the shared future, which is what makes concurrent waits safe.
+    std::shared_future<std::vector<char>> code = task->second;
+    return code.get();
+}
+
+VkResult VulkanApplication::createPipelineCache()
+{
+    CPU_PROFILE_ZONE("createPipelineCache");
+
+    // Load the cache saved by the last run when it came from this device and driver, otherwise start from an empty one.
+    std::vector<char> contents = {};
+    pipelineCacheReport = {};
+    if (!loadPipelineCache) {
+        pipelineCacheReport.status = "not loaded, cold start requested";
+    }
+    else {
+        std::ifstream file(kPipelineCacheFile, std::ios::binary);
+        if (!file.is_open()) {
+            pipelineCacheReport.status = "no cache on disk";
+        }
+        else {
+            contents.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+            const char* rejection = validatePipelineCacheFile(contents, getPipelineCacheFileHeader(m_PhysicalDevice));
+            if (rejection) {
+                pipelineCacheReport.status = std::string("rejected, ") + rejection;
+                contents.clear();
+            }
+        }
+    }
+
+    VkPipelineCacheCreateInfo createInfo = {};
+    createInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+    if (!contents.empty()) {
+        createInfo.initialDataSize = contents.size() - sizeof(PipelineCacheFileHeader);
+        createInfo.pInitialData = contents.data() + sizeof(PipelineCacheFileHeader);
+    }
+
+    // The driver may still refuse data that passed the checks above, in which case fall back to a cold, empty cache.
+    if (createInfo.initialDataSize > 0 && vkCreatePipelineCache(m_LogicalDevice, &createInfo, nullptr, &pipelineCache) == VK_SUCCESS) {
+        pipelineCacheReport.warm = true;
+        pipelineCacheReport.loadedBytes = createInfo.initialDataSize;
+        pipelineCacheReport.status = "loaded";
+        return VK_SUCCESS;
+    }
+    if (createInfo.initialDataSize > 0) {
+        pipelineCacheReport.status = "rejected by the driver";
+    }
+
+    createInfo.initialDataSize = 0;
+    createInfo.pInitialData = nullptr;
+    if (vkCreatePipelineCache(m_LogicalDevice, &createInfo, nullptr, &pipelineCache) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create pipeline cache!");
+        return VK_ERROR_INITIALIZATION_FAILED;
+    }
+
+    return VK_SUCCESS;
+}
+
+void VulkanApplication::savePipelineCache()
+{
+    CPU_PROFILE_ZONE("savePipelineCache");
+
+    size_t dataSize = 0;
+    if (pipelineCache == VK_NULL_HANDLE || vkGetPipelineCacheData(m_LogicalDevice, pipelineCache, &dataSize, nullptr) != VK_SUCCESS || dataSize == 0) {
+        return;
+    }
+
+    std::vector<char> contents(sizeof(PipelineCacheFileHeader) + dataSize);
+    if (vkGetPipelineCacheData(m_LogicalDevice, pipelineCache, &dataSize, contents.data() + sizeof(PipelineCacheFileHeader)) != VK_SUCCESS) {
+        return;
+    }
+
+    PipelineCacheFileHeader header = getPipelineCacheFileHeader(m_PhysicalDevice);
+    header.dataSize = static_cast<uint32_t>(dataSize);
+    header.dataHash = hashPipelineCacheData(contents.data() + sizeof(PipelineCacheFileHeader), dataSize);
+    memcpy(contents.data(), &header, sizeof(header));
+
+    // A failed write only costs the next launch a cold start, and the hash rejects a partially written file.
+    std::ofstream file(kPipelineCacheFile, std::ios::binary | std::ios::trunc);
+    file.write(contents.data(), static_cast<std::streamsize>(sizeof(PipelineCacheFileHeader) + dataSize));
+}
+
 VkResult VulkanApplication::createPipelines()
 {
+    CPU_PROFILE_ZONE("createPipelines");
+
+    // Pipeline creation only reads the device, render pass, and descriptor set layouts, so each pipeline is built on its own worker while the
+    // main thread carries on creating buffers and images. The driver compiles the shaders here, the slowest part of initialisation.
+    bool useTessellation = grassRenderPath == GrassRenderPath::Tessellated;
+    pipelineCreationStart = std::chrono::steady_clock::now();
+    pipelineTasks.clear();
+    pipelineTasks.push_back(taskPool.submit([this, useTessellation]() { return useTessellation ? createMeshPipeline(modelPipeline) : createMeshGridPipeline(modelPipeline); }));
+    pipelineTasks.push_back(taskPool.submit([this]() { return createComputePipeline(); }));
+    pipelineTasks.push_back(taskPool.submit([this]() { return createWindFieldPipeline(windFieldPipeline); }));
+    pipelineTasks.push_back(taskPool.submit([this, useTessellation]() { return useTessellation ? createGrassPipeline(grassPipeline) : createGrassStripPipeline(grassPipeline); }));
+
+    return VK_SUCCESS;
+}
+
+VkResult VulkanApplication::waitForPipelines()
+{
+    CPU_PROFILE_ZONE("Wait for pipelines");
+
+    // Wait for every task before reporting a failure, so none is left writing a pipeline handle while the application unwinds.
     VkResult ret = VK_SUCCESS;
-     
-    ret = createMeshPipeline();
-    if (ret != VK_SUCCESS) {
-        throw std::runtime_error("could not create model pipeline.");
-        return ret;
+    std::exception_ptr exception = nullptr;
+    for (std::future<VkResult>& task : pipelineTasks) {
+        try {
+            VkResult taskResult = task.get();
+            if (ret == VK_SUCCESS) {
+                ret = taskResult;
+            }
+        }
+        catch (...) {
+            if (!exception) {
+                exception = std::current_exception();
+            }
+        }
     }
+    pipelineTasks.clear();
+    shaderCodeTasks.clear(); // Pipelines built from here on (compute variants, hot reloads) read the current SPIR-V from disk.
+    pipelineCacheReport.creationMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - pipelineCreationStart).count();
 
-    ret = createComputePipeline();
-    if (ret != VK_SUCCESS) {
-        throw std::runtime_error("could not create compute pipeline.");
-        return ret;
+    if (exception) {
+        std::rethrow_exception(exception);
     }
-
-    ret = createGrassPipeline();
     if (ret != VK_SUCCESS) {
-        throw std::runtime_error("could not create grass pipeline.");
+        throw std::runtime_error("could not create model | grass pipeline.");
         return ret;
     }
 
     return ret;
 }
  
-VkResult VulkanApplication::createMeshPipeline()
+void VulkanApplication::updateShaderHotReload()
 {
-    // Read SPIR-V files.
-    auto meshVertexShaderCode = Utils::readFile("../shaders/mesh.vert.spv"); 
-    auto terrainTessellationControlShaderCode = Utils::readFile("../shaders/terrainTessControl.tesc.spv");
-    auto terrainTessellationEvalShaderCode = Utils::readFile("../shaders/terrainTessEval.tese.spv");
-    auto fragmentShaderCode = Utils::readFile("../shaders/basicShader.frag.spv");
+    CPU_PROFILE_ZONE("updateShaderHotReload");
 
-    // Load shader modules.
-    VkShaderModule meshVertexShaderModule = createShaderModule(meshVertexShaderCode); 
-    VkShaderModule tessellationControlShaderModule = createShaderModule(terrainTessellationControlShaderCode);
-    VkShaderModule tessellationEvaluationShaderModule = createShaderModule(terrainTessellationEvalShaderCode);
-    VkShaderModule fragmentShaderModule = createShaderModule(fragmentShaderCode);
+    // A retired pipeline is free once both timelines have passed the last submits that could have been recorded with it.
+    uint64_t completedCompute = 0, completedGraphics = 0;
+    if (!retiredPipelines.empty()) {
+        vkGetSemaphoreCounterValue(m_LogicalDevice, computeTimeline, &completedCompute);
+        vkGetSemaphoreCounterValue(m_LogicalDevice, graphicsTimeline, &completedGraphics);
+    }
+    std::erase_if(retiredPipelines, [&](const RetiredPipeline& retired) {
+        if (completedCompute < retired.computeValue || completedGraphics < retired.graphicsValue) {
+            return false;
+        }
+        vkDestroyPipeline(m_LogicalDevice, retired.handle, nullptr);
+        return true;
+    });
 
-    // Configure how the vertex shader will execute within the pipeline.
-    VkPipelineShaderStageCreateInfo meshVertexShaderStageInfo = {}; 
-    meshVertexShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO; 
-    meshVertexShaderStageInfo.stage = VK_SHADER_STAGE_VERTEX_BIT; 
-    meshVertexShaderStageInfo.module = meshVertexShaderModule; 
-    meshVertexShaderStageInfo.pName = "main"; 
+    if (!shaderWatcher.isWatching()) {
+        return;
+    }
 
-    // Configure the same for the tessellation control shader.
-    VkPipelineShaderStageCreateInfo tessellationControlShaderStageInfo = {};
-    tessellationControlShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    for (const std::string& fileName : shaderWatcher.takeChanges()) {
+        pendingShaderChanges.insert(fileName);
+    }
+
+    // Swap in the pipelines of a finished reload. The frames in flight keep the ones they were recorded with, which are retired rather than
+    // destroyed, so nothing waits on the device.
+    if (shaderReloadTask.valid()) {
+        if (shaderReloadTask.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+            return;
+        }
+
+        try {
+            std::vector<ReloadedPipeline> reloaded = shaderReloadTask.get();
+            for (const ReloadedPipeline& pipeline : reloaded) {
+                VkPipeline* current = nullptr;
+                switch (pipeline.pipeline) {
+                case ReloadablePipeline::Model: current = &modelPipeline; break;
+                case ReloadablePipeline::WindField: current = &windFieldPipeline; break;
+                case ReloadablePipeline::Grass: current = &grassPipeline; break;
+                default: break;
+                }
+
+                if (current != nullptr) {
+                    retiredPipelines.push_back({ *current, computeTimelineValue, graphicsTimelineValue });
+                    *current = pipeline.handle;
+                }
+                else {
+                    // Every compute variant was built from the old shader, the others are rebuilt when they are next selected.
+                    for (const auto& [variant, handle] : computePipelineVariants) {
+                        retiredPipelines.push_back({ handle, computeTimelineValue, graphicsTimelineValue });
+                    }
+                    computePipelineVariants.clear();
+                    computePipelineVariants[pipeline.variant] = pipeline.handle;
+                }
+            }
+            shaderReloadStatus = "reloaded " + std::to_string(reloaded.size()) + " pipeline(s) on frame " + std::to_string(frameCount);
+        }
+        catch (const std::exception& exception) {
+            shaderReloadStatus = exception.what();
+            std::cerr << "Shader hot reload: " << exception.what() << std::endl;
+        }
+    }
+
+    if (pendingShaderChanges.empty()) {
+        return;
+    }
+
+    std::vector<std::string> sources(pendingShaderChanges.begin(), pendingShaderChanges.end());
+    pendingShaderChanges.clear();
+    bool tessellated = grassRenderPath == GrassRenderPath::Tessellated;
+    GrassComputeVariant variant = getComputeVariant();
+
+    shaderReloadTask = taskPool.submit([this, sources, tessellated, variant]() {
+        CPU_PROFILE_ZONE("Shader hot reload");
+
+        // Pipelines are only rebuilt from shaders that compiled, a compile error keeps the running pipeline until the source is fixed.
+        std::set<ReloadablePipeline> affected = {};
+        std::string errors;
+        for (const std::string& source : sources) {
+            try {
+                compileShader(source);
+            }
+            catch (const std::exception& exception) {
+                errors += std::string(errors.empty() ? "" : " ") + exception.what();
+                continue;
+            }
+
+            for (uint32_t i = 0; i < static_cast<uint32_t>(ReloadablePipeline::Count); ++i) {
+                std::vector<std::string> files = getPipelineShaderFiles(static_cast<ReloadablePipeline>(i), tessellated);
+                if (std::find(files.begin(), files.end(), source + ".spv") != files.end()) {
+                    affected.insert(static_cast<ReloadablePipeline>(i));
+                }
+            }
+        }
+
+        std::vector<ReloadedPipeline> reloaded = {};
+        try {
+            for (ReloadablePipeline pipeline : affected) {
+                ReloadedPipeline result = { pipeline, VK_NULL_HANDLE, variant };
+                switch (pipeline) {
+                case ReloadablePipeline::Model: tessellated ? createMeshPipeline(result.handle) : createMeshGridPipeline(result.handle); break;
+                case ReloadablePipeline::Compute: result.handle = createComputePipelineVariant(variant); break;
+                case ReloadablePipeline::WindField: createWindFieldPipeline(result.handle); break;
+                case ReloadablePipeline::Grass: tessellated ? createGrassPipeline(result.handle) : createGrassStripPipeline(result.handle); break;
+                default: break;
+                }
+                reloaded.push_back(result);
+            }
+        }
+        catch (...) {
+            for (const ReloadedPipeline& result : reloaded) {
+                vkDestroyPipeline(m_LogicalDevice, result.handle, nullptr);
+            }
+            throw;
+        }
+
+        if (!errors.empty()) {
+            if (reloaded.empty()) {
+                throw std::runtime_error(errors);
+            }
+            std::cerr << "Shader hot reload: " << errors << std::endl;
+        }
+        return reloaded;
+    });
+}
+
+VkResult VulkanApplication::createMeshPipeline(VkPipeline& pipeline)
+{
+    CPU_PROFILE_ZONE("createMeshPipeline");
+
+    // Read SPIR-V files.
+    auto meshVertexShaderCode = getShaderCode("mesh.vert.spv"); 
+    auto terrainTessellationControlShaderCode = getShaderCode("terrainTessControl.tesc.spv");
+    auto terrainTessellationEvalShaderCode = getShaderCode("terrainTessEval.tese.spv");
+    auto fragmentShaderCode = getShaderCode("basicShader.frag.spv");
+
+    // Load shader modules.
+    VkShaderModule meshVertexShaderModule = createShaderModule(meshVertexShaderCode); 
+    VkShaderModule tessellationControlShaderModule = createShaderModule(terrainTessellationControlShaderCode);
+    VkShaderModule tessellationEvaluationShaderModule = createShaderModule(terrainTessellationEvalShaderCode);
+    VkShaderModule fragmentShaderModule = createShaderModule(fragmentShaderCode);
+
+    // The terrain mapping, shared with the grass compute shader so the blades sit on the terrain.
+    TerrainSpecializationConstants terrainConstants = {};
+    std::vector<VkSpecializationMapEntry> terrainMapEntries = getSpecializationMapEntries(sizeof(terrainConstants));
+    VkSpecializationInfo terrainSpecializationInfo = {};
+    terrainSpecializationInfo.mapEntryCount = static_cast<uint32_t>(terrainMapEntries.size());
+    terrainSpecializationInfo.pMapEntries = terrainMapEntries.data();
+    terrainSpecializationInfo.dataSize = sizeof(terrainConstants);
+    terrainSpecializationInfo.pData = &terrainConstants;
+
+    // Configure how the vertex shader will execute within the pipeline.
+    VkPipelineShaderStageCreateInfo meshVertexShaderStageInfo = {}; 
+    meshVertexShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO; 
+    meshVertexShaderStageInfo.stage = VK_SHADER_STAGE_VERTEX_BIT; 
+    meshVertexShaderStageInfo.module = meshVertexShaderModule; 
+    meshVertexShaderStageInfo.pName = "main"; 
+
+    // Configure the same for the tessellation control shader.
+    VkPipelineShaderStageCreateInfo tessellationControlShaderStageInfo = {};
+    tessellationControlShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
     tessellationControlShaderStageInfo.stage = VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT;
     tessellationControlShaderStageInfo.module = tessellationControlShaderModule;
     tessellationControlShaderStageInfo.pName = "main";
@@ -726,6 +1494,7 @@ VkResult VulkanApplication::createMeshPipeline()
     tessellationEvaluationShaderStageInfo.stage = VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT;
     tessellationEvaluationShaderStageInfo.module = tessellationEvaluationShaderModule;
     tessellationEvaluationShaderStageInfo.pName = "main";
+    tessellationEvaluationShaderStageInfo.pSpecializationInfo = &terrainSpecializationInfo;
 
     // Configure the same for the fragment shader.
     VkPipelineShaderStageCreateInfo fragmentShaderStageInfo = {}; 
@@ -820,7 +1589,8 @@ VkResult VulkanApplication::createMeshPipeline()
     modelPipelineLayoutInfo.pSetLayouts = &modelDescriptorSetLayout;
 
     // Create the layout/blueprint for how the graphics pipeline will be created.
-    if (vkCreatePipelineLayout(m_LogicalDevice, &modelPipelineLayoutInfo, nullptr, &modelPipelineLayout) != VK_SUCCESS) {
+    // The layout does not depend on the shaders, so a hot reload keeps the one created at start-up.
+    if (modelPipelineLayout == VK_NULL_HANDLE && vkCreatePipelineLayout(m_LogicalDevice, &modelPipelineLayoutInfo, nullptr, &modelPipelineLayout) != VK_SUCCESS) {
         throw std::runtime_error("failed to create pipeline layout!");
         return VK_ERROR_INITIALIZATION_FAILED;
     }
@@ -828,6 +1598,7 @@ VkResult VulkanApplication::createMeshPipeline()
     // Encapsulate all aspects of the pipeline layout, enabling a pipeline creation optimised for specific rendering tasks (in this case, regular graphics).
     VkGraphicsPipelineCreateInfo modelPipelineCreateInfo = {}; 
     modelPipelineCreateInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO; 
+    modelPipelineCreateInfo.pNext = dynamicRendering ? &pipelineRenderingInfo : nullptr; // renderPass is null with dynamic rendering.
     modelPipelineCreateInfo.stageCount = sizeof(shaderStages) / sizeof(shaderStages[0]); // Get the size of shader stages array. 
     modelPipelineCreateInfo.pStages = shaderStages; 
     modelPipelineCreateInfo.pVertexInputState = &vertexInputInfo; 
@@ -844,9 +1615,7 @@ VkResult VulkanApplication::createMeshPipeline()
     modelPipelineCreateInfo.subpass = 0; 
     modelPipelineCreateInfo.basePipelineHandle = VK_NULL_HANDLE; 
 
-    VkResult a = vkCreateGraphicsPipelines(m_LogicalDevice, VK_NULL_HANDLE, 1, &modelPipelineCreateInfo, nullptr, &modelPipeline);
-
-    if (vkCreateGraphicsPipelines(m_LogicalDevice, VK_NULL_HANDLE, 1, &modelPipelineCreateInfo, nullptr, &modelPipeline) != VK_SUCCESS) {
+    if (vkCreateGraphicsPipelines(m_LogicalDevice, pipelineCache, 1, &modelPipelineCreateInfo, nullptr, &pipeline) != VK_SUCCESS) {
         throw std::runtime_error("failed to create graphics pipeline!"); 
         return VK_ERROR_INITIALIZATION_FAILED; 
     }
@@ -860,16 +1629,160 @@ VkResult VulkanApplication::createMeshPipeline()
     return VK_SUCCESS;
 }
 
-VkResult VulkanApplication::createComputePipeline()
+VkResult VulkanApplication::createMeshGridPipeline(VkPipeline& pipeline)
 {
-    auto grassComputeShaderCode = Utils::readFile("../shaders/grassCompute.comp.spv");
-    VkShaderModule grassComputeShaderModule = createShaderModule(grassComputeShaderCode);
+    CPU_PROFILE_ZONE("createMeshGridPipeline");
 
-    VkPipelineShaderStageCreateInfo computeShaderStageInfo = {};
-    computeShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-    computeShaderStageInfo.stage = VK_SHADER_STAGE_COMPUTE_BIT;
-    computeShaderStageInfo.module = grassComputeShaderModule;
-    computeShaderStageInfo.pName = "main";
+    // Read SPIR-V files.
+    auto terrainVertexShaderCode = getShaderCode("terrain.vert.spv");
+    auto fragmentShaderCode = getShaderCode("basicShader.frag.spv");
+
+    // Load shader modules.
+    VkShaderModule terrainVertexShaderModule = createShaderModule(terrainVertexShaderCode);
+    VkShaderModule fragmentShaderModule = createShaderModule(fragmentShaderCode);
+
+    // The terrain mapping, shared with the grass compute shader so the blades sit on the terrain.
+    TerrainSpecializationConstants terrainConstants = {};
+    std::vector<VkSpecializationMapEntry> terrainMapEntries = getSpecializationMapEntries(sizeof(terrainConstants));
+    VkSpecializationInfo terrainSpecializationInfo = {};
+    terrainSpecializationInfo.mapEntryCount = static_cast<uint32_t>(terrainMapEntries.size());
+    terrainSpecializationInfo.pMapEntries = terrainMapEntries.data();
+    terrainSpecializationInfo.dataSize = sizeof(terrainConstants);
+    terrainSpecializationInfo.pData = &terrainConstants;
+
+    // Configure how the vertex shader will execute within the pipeline, the height map displacement happens here instead of in a tessellation evaluation shader.
+    VkPipelineShaderStageCreateInfo terrainVertexShaderStageInfo = {};
+    terrainVertexShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    terrainVertexShaderStageInfo.stage = VK_SHADER_STAGE_VERTEX_BIT;
+    terrainVertexShaderStageInfo.module = terrainVertexShaderModule;
+    terrainVertexShaderStageInfo.pName = "main";
+    terrainVertexShaderStageInfo.pSpecializationInfo = &terrainSpecializationInfo;
+
+    // Configure the same for the fragment shader.
+    VkPipelineShaderStageCreateInfo fragmentShaderStageInfo = {};
+    fragmentShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    fragmentShaderStageInfo.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
+    fragmentShaderStageInfo.module = fragmentShaderModule;
+    fragmentShaderStageInfo.pName = "main";
+
+    // Connect all shader stages for this pipeline.
+    VkPipelineShaderStageCreateInfo shaderStages[] = { terrainVertexShaderStageInfo, fragmentShaderStageInfo };
+
+    // Configure how vertex data is structured and passed from a vertex buffer into a pipeline stage.
+    VkVertexInputBindingDescription bindingDescription = Vertex::getBindingDescription();
+    VkPipelineVertexInputStateCreateInfo vertexInputInfo = {};
+    vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+    vertexInputInfo.vertexBindingDescriptionCount = 1;
+    vertexInputInfo.pVertexBindingDescriptions = &bindingDescription;
+    vertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(Vertex::getAttributeDescriptions().size());
+    vertexInputInfo.pVertexAttributeDescriptions = Vertex::getAttributeDescriptions().data();
+
+    // The grid is already subdivided on the CPU (see Quad::generateGrid), so this is a regular indexed triangle list.
+    VkPipelineInputAssemblyStateCreateInfo inputAssembly = {};
+    inputAssembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+    inputAssembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+    inputAssembly.primitiveRestartEnable = VK_FALSE;
+
+    // Specify the structures that may change at runtime.
+    std::vector<VkDynamicState> dynamicStates = { VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR };
+    VkPipelineDynamicStateCreateInfo dynamicState = {};
+    dynamicState.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+    dynamicState.dynamicStateCount = static_cast<uint32_t>(dynamicStates.size());
+    dynamicState.pDynamicStates = dynamicStates.data();
+
+    // Configures the viewports and scissors to determine the regions of the framebuffer to render to.
+    VkPipelineViewportStateCreateInfo viewportState{};
+    viewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+    viewportState.viewportCount = 1;
+    viewportState.scissorCount = 1;
+
+    // Configures settings for how primitives are transformed into fragments/pixels.
+    // The winding of the displaced grid differs from the tessellated patches, so don't cull either face of the terrain.
+    VkPipelineRasterizationStateCreateInfo rasterizer = {};
+    rasterizer.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+    rasterizer.depthClampEnable = VK_FALSE;
+    rasterizer.rasterizerDiscardEnable = VK_FALSE;
+    rasterizer.polygonMode = VK_POLYGON_MODE_FILL;
+    rasterizer.lineWidth = 1.0f;
+    rasterizer.cullMode = VK_CULL_MODE_NONE;
+    rasterizer.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+    rasterizer.depthBiasEnable = VK_FALSE;
+
+    // Configure settings for how multisampling performs, reducing aliasing and jagged edges in the rendered image.
+    VkPipelineMultisampleStateCreateInfo multisampling = {};
+    multisampling.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+    multisampling.sampleShadingEnable = VK_FALSE;
+    multisampling.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+    multisampling.minSampleShading = 0;
+
+    VkPipelineDepthStencilStateCreateInfo depthStencil = {};
+    depthStencil.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+    depthStencil.depthTestEnable = VK_TRUE;
+    depthStencil.depthWriteEnable = VK_TRUE;
+    depthStencil.depthCompareOp = VK_COMPARE_OP_LESS;
+    depthStencil.depthBoundsTestEnable = VK_FALSE;
+    depthStencil.stencilTestEnable = VK_FALSE;
+
+    // Enables blending settings for colour attachments, allowing transparency and masking effects.
+    VkPipelineColorBlendAttachmentState colorBlendAttachment = {};
+    colorBlendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+    colorBlendAttachment.blendEnable = VK_FALSE;
+
+    // Configure how blending is applied for individual attachments and logic-based colour operations.
+    VkPipelineColorBlendStateCreateInfo colorBlending = {};
+    colorBlending.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+    colorBlending.logicOpEnable = VK_FALSE;
+    colorBlending.attachmentCount = 1;
+    colorBlending.pAttachments = &colorBlendAttachment;
+
+    // Same descriptor set layout as the tessellated terrain, the vertex stage is already given access to the height map sampler.
+    VkPipelineLayoutCreateInfo modelPipelineLayoutInfo = {};
+    modelPipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    modelPipelineLayoutInfo.setLayoutCount = 1;
+    modelPipelineLayoutInfo.pSetLayouts = &modelDescriptorSetLayout;
+
+    // Create the layout/blueprint for how the graphics pipeline will be created.
+    // The layout does not depend on the shaders, so a hot reload keeps the one created at start-up.
+    if (modelPipelineLayout == VK_NULL_HANDLE && vkCreatePipelineLayout(m_LogicalDevice, &modelPipelineLayoutInfo, nullptr, &modelPipelineLayout) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create pipeline layout!");
+        return VK_ERROR_INITIALIZATION_FAILED;
+    }
+
+    // Encapsulate all aspects of the pipeline layout, note there is no tessellation state for this pipeline.
+    VkGraphicsPipelineCreateInfo modelPipelineCreateInfo = {};
+    modelPipelineCreateInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+    modelPipelineCreateInfo.pNext = dynamicRendering ? &pipelineRenderingInfo : nullptr; // renderPass is null with dynamic rendering.
+    modelPipelineCreateInfo.stageCount = sizeof(shaderStages) / sizeof(shaderStages[0]); // Get the size of shader stages array. 
+    modelPipelineCreateInfo.pStages = shaderStages;
+    modelPipelineCreateInfo.pVertexInputState = &vertexInputInfo;
+    modelPipelineCreateInfo.pInputAssemblyState = &inputAssembly;
+    modelPipelineCreateInfo.pTessellationState = nullptr;
+    modelPipelineCreateInfo.pViewportState = &viewportState;
+    modelPipelineCreateInfo.pRasterizationState = &rasterizer;
+    modelPipelineCreateInfo.pMultisampleState = &multisampling;
+    modelPipelineCreateInfo.pDepthStencilState = &depthStencil;
+    modelPipelineCreateInfo.pColorBlendState = &colorBlending;
+    modelPipelineCreateInfo.pDynamicState = &dynamicState;
+    modelPipelineCreateInfo.layout = modelPipelineLayout;
+    modelPipelineCreateInfo.renderPass = renderPass;
+    modelPipelineCreateInfo.subpass = 0;
+    modelPipelineCreateInfo.basePipelineHandle = VK_NULL_HANDLE;
+
+    if (vkCreateGraphicsPipelines(m_LogicalDevice, pipelineCache, 1, &modelPipelineCreateInfo, nullptr, &pipeline) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create graphics pipeline!");
+        return VK_ERROR_INITIALIZATION_FAILED;
+    }
+
+    // The pipeline retains a reference to previously created shader modules, so we no longer need local references.
+    vkDestroyShaderModule(m_LogicalDevice, fragmentShaderModule, nullptr);
+    vkDestroyShaderModule(m_LogicalDevice, terrainVertexShaderModule, nullptr);
+
+    return VK_SUCCESS;
+}
+
+VkResult VulkanApplication::createComputePipeline()
+{
+    CPU_PROFILE_ZONE("createComputePipeline");
 
     VkPushConstantRange pushConstantRange = {};
     pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
@@ -891,6 +1804,67 @@ VkResult VulkanApplication::createComputePipeline()
         return VK_ERROR_INITIALIZATION_FAILED;
     }
 
+    // Build the start-up variant now so the first frame does not stall on it, the rest are built when the settings first select them.
+    getComputePipeline(getComputeVariant());
+
+    return VK_SUCCESS; 
+}
+
+GrassComputeVariant VulkanApplication::getComputeVariant() const
+{
+    GrassComputeVariant variant = {};
+    variant.frustumCulling = sceneSettings.frustumCulling;
+    variant.wind = windParameters.enabled;
+    variant.windField = windParameters.enabled && sceneSettings.windField; // Normalised so the variants that compile to the same shader are shared.
+    variant.workgroupSize = sceneSettings.computeWorkgroupSize;
+    return variant;
+}
+
+VkPipeline VulkanApplication::getComputePipeline(const GrassComputeVariant& variant)
+{
+    auto cached = computePipelineVariants.find(variant);
+    if (cached != computePipelineVariants.end()) {
+        return cached->second;
+    }
+
+    VkPipeline pipeline = createComputePipelineVariant(variant);
+    computePipelineVariants[variant] = pipeline;
+    return pipeline;
+}
+
+VkPipeline VulkanApplication::createComputePipelineVariant(const GrassComputeVariant& variant)
+{
+    CPU_PROFILE_ZONE("createComputePipelineVariant");
+
+    const VkPhysicalDeviceLimits& limits = deviceProperties.limits;
+    if (variant.workgroupSize == 0 || (variant.workgroupSize & (variant.workgroupSize - 1)) != 0 || 
+        variant.workgroupSize > limits.maxComputeWorkGroupSize[0] || variant.workgroupSize > limits.maxComputeWorkGroupInvocations) {
+        throw std::runtime_error("grass compute workgroup size " + std::to_string(variant.workgroupSize) + " is not a power of two within the device limits!");
+    }
+
+    auto grassComputeShaderCode = getShaderCode("grassCompute.comp.spv");
+    VkShaderModule grassComputeShaderModule = createShaderModule(grassComputeShaderCode);
+
+    GrassComputeSpecializationConstants constants = {};
+    constants.workgroupSize = variant.workgroupSize;
+    constants.frustumCulling = variant.frustumCulling ? VK_TRUE : VK_FALSE;
+    constants.wind = variant.wind ? VK_TRUE : VK_FALSE;
+    constants.windField = variant.windField ? VK_TRUE : VK_FALSE;
+
+    std::vector<VkSpecializationMapEntry> mapEntries = getSpecializationMapEntries(sizeof(constants));
+    VkSpecializationInfo specializationInfo = {};
+    specializationInfo.mapEntryCount = static_cast<uint32_t>(mapEntries.size());
+    specializationInfo.pMapEntries = mapEntries.data();
+    specializationInfo.dataSize = sizeof(constants);
+    specializationInfo.pData = &constants;
+
+    VkPipelineShaderStageCreateInfo computeShaderStageInfo = {};
+    computeShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    computeShaderStageInfo.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+    computeShaderStageInfo.module = grassComputeShaderModule;
+    computeShaderStageInfo.pName = "main";
+    computeShaderStageInfo.pSpecializationInfo = &specializationInfo;
+
     VkComputePipelineCreateInfo computePipelineCreateInfo = {};
     computePipelineCreateInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
     computePipelineCreateInfo.pNext = nullptr;
@@ -900,23 +1874,79 @@ VkResult VulkanApplication::createComputePipeline()
     computePipelineCreateInfo.basePipelineHandle = 0;
     computePipelineCreateInfo.basePipelineIndex = 0;
 
-    if (vkCreateComputePipelines(m_LogicalDevice, VK_NULL_HANDLE, 1, &computePipelineCreateInfo, nullptr, &computePipeline) != VK_SUCCESS) {
+    VkPipeline pipeline = VK_NULL_HANDLE;
+    VkResult result = vkCreateComputePipelines(m_LogicalDevice, pipelineCache, 1, &computePipelineCreateInfo, nullptr, &pipeline);
+    vkDestroyShaderModule(m_LogicalDevice, grassComputeShaderModule, nullptr);
+    if (result != VK_SUCCESS) {
         throw std::runtime_error("failed to create compute pipeline!");
+        return VK_NULL_HANDLE;
+    }
+
+    return pipeline;
+}
+
+VkResult VulkanApplication::createWindFieldPipeline(VkPipeline& pipeline)
+{
+    CPU_PROFILE_ZONE("createWindFieldPipeline");
+
+    auto windFieldShaderCode = getShaderCode("windField.comp.spv");
+    VkShaderModule windFieldShaderModule = createShaderModule(windFieldShaderCode);
+
+    VkPipelineShaderStageCreateInfo computeShaderStageInfo = {};
+    computeShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    computeShaderStageInfo.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+    computeShaderStageInfo.module = windFieldShaderModule;
+    computeShaderStageInfo.pName = "main";
+
+    VkPushConstantRange pushConstantRange = {};
+    pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    pushConstantRange.offset = 0;
+    pushConstantRange.size = sizeof(WindPushConstantsObject);
+
+    VkPipelineLayoutCreateInfo windFieldPipelineLayoutInfo = {};
+    windFieldPipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    windFieldPipelineLayoutInfo.pNext = nullptr;
+    windFieldPipelineLayoutInfo.flags = 0;
+    windFieldPipelineLayoutInfo.pushConstantRangeCount = 1;
+    windFieldPipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+    windFieldPipelineLayoutInfo.setLayoutCount = 1;
+    windFieldPipelineLayoutInfo.pSetLayouts = &windFieldDescriptorSetLayout;
+
+    // Create the layout/blueprint for how the wind field pipeline will be created.
+    // The layout does not depend on the shaders, so a hot reload keeps the one created at start-up.
+    if (windFieldPipelineLayout == VK_NULL_HANDLE && vkCreatePipelineLayout(m_LogicalDevice, &windFieldPipelineLayoutInfo, nullptr, &windFieldPipelineLayout) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create wind field pipeline layout!");
         return VK_ERROR_INITIALIZATION_FAILED;
     }
 
-    vkDestroyShaderModule(m_LogicalDevice, grassComputeShaderModule, nullptr);
+    VkComputePipelineCreateInfo computePipelineCreateInfo = {};
+    computePipelineCreateInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    computePipelineCreateInfo.pNext = nullptr;
+    computePipelineCreateInfo.flags = 0;
+    computePipelineCreateInfo.layout = windFieldPipelineLayout;
+    computePipelineCreateInfo.stage = computeShaderStageInfo;
+    computePipelineCreateInfo.basePipelineHandle = 0;
+    computePipelineCreateInfo.basePipelineIndex = 0;
 
-    return VK_SUCCESS; 
+    if (vkCreateComputePipelines(m_LogicalDevice, pipelineCache, 1, &computePipelineCreateInfo, nullptr, &pipeline) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create wind field pipeline!");
+        return VK_ERROR_INITIALIZATION_FAILED;
+    }
+
+    vkDestroyShaderModule(m_LogicalDevice, windFieldShaderModule, nullptr);
+
+    return VK_SUCCESS;
 }
 
-VkResult VulkanApplication::createGrassPipeline()
+VkResult VulkanApplication::createGrassPipeline(VkPipeline& pipeline)
 {
+    CPU_PROFILE_ZONE("createGrassPipeline");
+
     // Read SPIR-V files.
-    auto grassVertexShaderCode = Utils::readFile("../shaders/grass.vert.spv");
-    auto fragmentShaderCode = Utils::readFile("../shaders/basicShader.frag.spv");
-    auto tessellationControlShaderCode = Utils::readFile("../shaders/grassTessControl.tesc.spv");
-    auto tessellationEvalShaderCode = Utils::readFile("../shaders/grassTessEval.tese.spv");
+    auto grassVertexShaderCode = getShaderCode("grass.vert.spv");
+    auto fragmentShaderCode = getShaderCode("basicShader.frag.spv");
+    auto tessellationControlShaderCode = getShaderCode("grassTessControl.tesc.spv");
+    auto tessellationEvalShaderCode = getShaderCode("grassTessEval.tese.spv");
 
     // Load shader modules.
     VkShaderModule grassVertexShaderModule = createShaderModule(grassVertexShaderCode);
@@ -1036,16 +2066,23 @@ VkResult VulkanApplication::createGrassPipeline()
     colorBlending.attachmentCount = 1;
     colorBlending.pAttachments = &colorBlendAttachment;
 
+    // The tessellation levels are pushed before the draws, so benchmark sweeps can change them without rebuilding the pipeline.
+    VkPushConstantRange pushConstantRange = {};
+    pushConstantRange.stageFlags = VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT;
+    pushConstantRange.offset = 0;
+    pushConstantRange.size = sizeof(GrassPushConstantsObject);
+
     // Configure how Vulkan understands to bind resources to shaders, ensuring they can efficiently access required resources.
     VkPipelineLayoutCreateInfo grassPipelineLayoutInfo = {};
     grassPipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-    grassPipelineLayoutInfo.pushConstantRangeCount = 0;
-    grassPipelineLayoutInfo.pPushConstantRanges = nullptr;
+    grassPipelineLayoutInfo.pushConstantRangeCount = 1;
+    grassPipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
     grassPipelineLayoutInfo.setLayoutCount = 1;
     grassPipelineLayoutInfo.pSetLayouts = &grassDescriptorSetLayout;
 
     // Create the layout/blueprint for how the graphics pipeline will be created.
-    if (vkCreatePipelineLayout(m_LogicalDevice, &grassPipelineLayoutInfo, nullptr, &grassPipelineLayout) != VK_SUCCESS) {
+    // The layout does not depend on the shaders, so a hot reload keeps the one created at start-up.
+    if (grassPipelineLayout == VK_NULL_HANDLE && vkCreatePipelineLayout(m_LogicalDevice, &grassPipelineLayoutInfo, nullptr, &grassPipelineLayout) != VK_SUCCESS) {
         throw std::runtime_error("failed to create pipeline layout!");
         return VK_ERROR_INITIALIZATION_FAILED;
     }
@@ -1053,6 +2090,7 @@ VkResult VulkanApplication::createGrassPipeline()
     // Encapsulate all aspects of the pipeline layout, enabling a pipeline creation optimised for specific rendering tasks (in this case, regular graphics).
     VkGraphicsPipelineCreateInfo grassPipelineCreateInfo = {};
     grassPipelineCreateInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+    grassPipelineCreateInfo.pNext = dynamicRendering ? &pipelineRenderingInfo : nullptr; // renderPass is null with dynamic rendering.
     grassPipelineCreateInfo.stageCount = sizeof(shaderStages) / sizeof(shaderStages[0]); // Get the size of shader stages array. 
     grassPipelineCreateInfo.pStages = shaderStages;
     grassPipelineCreateInfo.pVertexInputState = &vertexInputInfo;
@@ -1069,7 +2107,7 @@ VkResult VulkanApplication::createGrassPipeline()
     grassPipelineCreateInfo.subpass = 0;
     grassPipelineCreateInfo.basePipelineHandle = VK_NULL_HANDLE;
     
-    if (vkCreateGraphicsPipelines(m_LogicalDevice, VK_NULL_HANDLE, 1, &grassPipelineCreateInfo, nullptr, &grassPipeline) != VK_SUCCESS) {
+    if (vkCreateGraphicsPipelines(m_LogicalDevice, pipelineCache, 1, &grassPipelineCreateInfo, nullptr, &pipeline) != VK_SUCCESS) {
         throw std::runtime_error("failed to create graphics pipeline!");
         return VK_ERROR_INITIALIZATION_FAILED;
     }
@@ -1083,18 +2121,168 @@ VkResult VulkanApplication::createGrassPipeline()
     return VK_SUCCESS;
 }
 
-VkResult VulkanApplication::createHeightMapImage()
+VkResult VulkanApplication::createGrassStripPipeline(VkPipeline& pipeline)
 {
-    // Read the pixel data for the texture.
-    int texWidth, texHeight, texChannels;
-    stbi_uc* pixels = stbi_load("../assets/RollingHillsHeightMap.png", &texWidth, &texHeight, &texChannels, STBI_rgb_alpha);
-    VkDeviceSize imageSize = texWidth * texHeight * 4;
+    CPU_PROFILE_ZONE("createGrassStripPipeline");
 
-    if (!pixels) {
-        throw std::runtime_error("failed to load texture image!");
+    // Read SPIR-V files.
+    auto grassStripVertexShaderCode = getShaderCode("grassStrip.vert.spv");
+    auto fragmentShaderCode = getShaderCode("basicShader.frag.spv");
+
+    // Load shader modules.
+    VkShaderModule grassStripVertexShaderModule = createShaderModule(grassStripVertexShaderCode);
+    VkShaderModule fragmentShaderModule = createShaderModule(fragmentShaderCode);
+
+    // Configure how the vertex shader will execute within the pipeline, this generates the blade geometry that the tessellation stages would otherwise generate.
+    VkPipelineShaderStageCreateInfo grassStripVertexShaderStageInfo = {};
+    grassStripVertexShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    grassStripVertexShaderStageInfo.stage = VK_SHADER_STAGE_VERTEX_BIT;
+    grassStripVertexShaderStageInfo.module = grassStripVertexShaderModule;
+    grassStripVertexShaderStageInfo.pName = "main";
+
+    // Configure the same for the fragment shader...
+    VkPipelineShaderStageCreateInfo fragmentShaderStageInfo = {};
+    fragmentShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    fragmentShaderStageInfo.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
+    fragmentShaderStageInfo.module = fragmentShaderModule;
+    fragmentShaderStageInfo.pName = "main";
+
+    // Connect all shader stages for this pipeline.
+    VkPipelineShaderStageCreateInfo shaderStages[] = { grassStripVertexShaderStageInfo, fragmentShaderStageInfo };
+
+    // As with the tessellated grass pipeline, the blade instance data comes from a shader storage buffer object so there are no vertex bindings.
+    VkPipelineVertexInputStateCreateInfo vertexInputInfo = {};
+    vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+    vertexInputInfo.vertexBindingDescriptionCount = 0;
+    vertexInputInfo.pVertexBindingDescriptions = nullptr;
+    vertexInputInfo.vertexAttributeDescriptionCount = 0;
+    vertexInputInfo.pVertexAttributeDescriptions = nullptr;
+
+    // One triangle strip per-instance, the vertices are generated from gl_VertexIndex.
+    VkPipelineInputAssemblyStateCreateInfo inputAssembly = {};
+    inputAssembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+    inputAssembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_STRIP;
+    inputAssembly.primitiveRestartEnable = VK_FALSE;
+
+    // Specify the structures that may change at runtime.
+    std::vector<VkDynamicState> dynamicStates = { VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR };
+    VkPipelineDynamicStateCreateInfo dynamicState = {};
+    dynamicState.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+    dynamicState.dynamicStateCount = static_cast<uint32_t>(dynamicStates.size());
+    dynamicState.pDynamicStates = dynamicStates.data();
+
+    // Configures the viewports and scissors to determine the regions of the framebuffer to render to.
+    VkPipelineViewportStateCreateInfo viewportState{};
+    viewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+    viewportState.viewportCount = 1;
+    viewportState.scissorCount = 1;
+
+    // Configures settings for how primitives are transformed into fragments/pixels.
+    // Triangle strips alternate their winding, and a blade should be visible from both sides, so nothing is culled.
+    VkPipelineRasterizationStateCreateInfo rasterizer = {};
+    rasterizer.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+    rasterizer.depthClampEnable = VK_FALSE;
+    rasterizer.rasterizerDiscardEnable = VK_FALSE;
+    rasterizer.polygonMode = VK_POLYGON_MODE_FILL;
+    rasterizer.lineWidth = 1.0f;
+    rasterizer.cullMode = VK_CULL_MODE_NONE;
+    rasterizer.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+    rasterizer.depthBiasEnable = VK_FALSE;
+
+    // Configure settings for how multisampling performs, reducing aliasing and jagged edges in the rendered image.
+    VkPipelineMultisampleStateCreateInfo multisampling = {};
+    multisampling.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+    multisampling.sampleShadingEnable = VK_FALSE;
+    multisampling.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+    multisampling.minSampleShading = 0;
+
+    VkPipelineDepthStencilStateCreateInfo depthStencil = {};
+    depthStencil.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+    depthStencil.depthTestEnable = VK_TRUE;
+    depthStencil.depthWriteEnable = VK_TRUE;
+    depthStencil.depthCompareOp = VK_COMPARE_OP_LESS;
+    depthStencil.depthBoundsTestEnable = VK_FALSE;
+    depthStencil.stencilTestEnable = VK_FALSE;
+
+    // Enables blending settings for colour attachments, allowing transparency and masking effects.
+    VkPipelineColorBlendAttachmentState colorBlendAttachment = {};
+    colorBlendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+    colorBlendAttachment.blendEnable = VK_FALSE;
+
+    // Configure how blending is applied for individual attachments and logic-based colour operations.
+    VkPipelineColorBlendStateCreateInfo colorBlending = {};
+    colorBlending.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+    colorBlending.logicOpEnable = VK_FALSE;
+    colorBlending.attachmentCount = 1;
+    colorBlending.pAttachments = &colorBlendAttachment;
+
+    // The strip vertex count differs between the near and far level of detail draws, so it is pushed before each draw.
+    VkPushConstantRange pushConstantRange = {};
+    pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+    pushConstantRange.offset = 0;
+    pushConstantRange.size = sizeof(GrassPushConstantsObject);
+
+    // Configure how Vulkan understands to bind resources to shaders, ensuring they can efficiently access required resources.
+    VkPipelineLayoutCreateInfo grassPipelineLayoutInfo = {};
+    grassPipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    grassPipelineLayoutInfo.pushConstantRangeCount = 1;
+    grassPipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+    grassPipelineLayoutInfo.setLayoutCount = 1;
+    grassPipelineLayoutInfo.pSetLayouts = &grassDescriptorSetLayout;
+
+    // Create the layout/blueprint for how the graphics pipeline will be created.
+    // The layout does not depend on the shaders, so a hot reload keeps the one created at start-up.
+    if (grassPipelineLayout == VK_NULL_HANDLE && vkCreatePipelineLayout(m_LogicalDevice, &grassPipelineLayoutInfo, nullptr, &grassPipelineLayout) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create pipeline layout!");
         return VK_ERROR_INITIALIZATION_FAILED;
     }
 
+    // Encapsulate all aspects of the pipeline layout, note there is no tessellation state for this pipeline.
+    VkGraphicsPipelineCreateInfo grassPipelineCreateInfo = {};
+    grassPipelineCreateInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+    grassPipelineCreateInfo.pNext = dynamicRendering ? &pipelineRenderingInfo : nullptr; // renderPass is null with dynamic rendering.
+    grassPipelineCreateInfo.stageCount = sizeof(shaderStages) / sizeof(shaderStages[0]); // Get the size of shader stages array. 
+    grassPipelineCreateInfo.pStages = shaderStages;
+    grassPipelineCreateInfo.pVertexInputState = &vertexInputInfo;
+    grassPipelineCreateInfo.pInputAssemblyState = &inputAssembly;
+    grassPipelineCreateInfo.pTessellationState = nullptr;
+    grassPipelineCreateInfo.pViewportState = &viewportState;
+    grassPipelineCreateInfo.pRasterizationState = &rasterizer;
+    grassPipelineCreateInfo.pMultisampleState = &multisampling;
+    grassPipelineCreateInfo.pDepthStencilState = &depthStencil;
+    grassPipelineCreateInfo.pColorBlendState = &colorBlending;
+    grassPipelineCreateInfo.pDynamicState = &dynamicState;
+    grassPipelineCreateInfo.layout = grassPipelineLayout;
+    grassPipelineCreateInfo.renderPass = renderPass;
+    grassPipelineCreateInfo.subpass = 0;
+    grassPipelineCreateInfo.basePipelineHandle = VK_NULL_HANDLE;
+
+    if (vkCreateGraphicsPipelines(m_LogicalDevice, pipelineCache, 1, &grassPipelineCreateInfo, nullptr, &pipeline) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create graphics pipeline!");
+        return VK_ERROR_INITIALIZATION_FAILED;
+    }
+
+    // The pipeline retains a reference to previously created shader modules, so we no longer need local references.
+    vkDestroyShaderModule(m_LogicalDevice, fragmentShaderModule, nullptr);
+    vkDestroyShaderModule(m_LogicalDevice, grassStripVertexShaderModule, nullptr);
+
+    return VK_SUCCESS;
+}
+
+VkResult VulkanApplication::createHeightMapImage()
+{
+    // Take the pixel data decoded on the task pool, or decode it here if it was never queued.
+    DecodedImage heightMap = {};
+    if (heightMapDecodeTask.valid()) {
+        CPU_PROFILE_ZONE("Wait for height map decode");
+        heightMap = heightMapDecodeTask.get();
+    }
+    else {
+        heightMap = decodeImage("../assets/RollingHillsHeightMap.png");
+    }
+    int texWidth = heightMap.width, texHeight = heightMap.height;
+    VkDeviceSize imageSize = heightMap.pixels.size();
+
     // Create a staging buffer to upload pixel data to the GPU.
     VkBuffer stagingBuffer;
     VkDeviceMemory stagingBufferMemory;
@@ -1115,12 +2303,9 @@ VkResult VulkanApplication::createHeightMapImage()
     // Upload pixel data to the GPU.
     void* data;
     vkMapMemory(m_LogicalDevice, stagingBufferMemory, 0, imageSize, 0, &data);
-    memcpy(data, pixels, static_cast<size_t>(imageSize));
+    memcpy(data, heightMap.pixels.data(), static_cast<size_t>(imageSize));
     vkUnmapMemory(m_LogicalDevice, stagingBufferMemory);
 
-    // Since the GPU now has a reference to the pixel data, we don't need to store it on the host anymore.
-    stbi_image_free(pixels);
-
     ImageCreateInfo heightMapImageInfo = {};
     heightMapImageInfo.width = texWidth;
     heightMapImageInfo.height = texHeight;
@@ -1132,6 +2317,7 @@ VkResult VulkanApplication::createHeightMapImage()
     heightMapImageInfo.properties = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
     heightMapImageInfo.pImage = &heightMapImage;
     heightMapImageInfo.pImageMemory = &heightMapImageMemory;
+    heightMapImageInfo.concurrent = true; // Sampled by the culling pass as well as the draws.
 
     // Create an image handle.
     ret = createImage(heightMapImageInfo);
@@ -1195,8 +2381,52 @@ VkResult VulkanApplication::createHeightMapSampler()
     return VK_SUCCESS;
 }
 
+VkResult VulkanApplication::createWindFieldImage()
+{
+    // RGBA16F rather than RG16F, storage image support for two channel formats is optional (shaderStorageImageExtendedFormats) whereas it is guaranteed for this one.
+    // Only the red and green channels are used, holding the XY wind vector (Z is up).
+    VkFormat windFieldFormat = VK_FORMAT_R16G16B16A16_SFLOAT;
+
+    ImageCreateInfo windFieldImageInfo = {};
+    windFieldImageInfo.width = kWindFieldResolution;
+    windFieldImageInfo.height = kWindFieldResolution;
+    windFieldImageInfo.mipLevels = 1;
+    windFieldImageInfo.numSamples = VK_SAMPLE_COUNT_1_BIT;
+    windFieldImageInfo.format = windFieldFormat;
+    windFieldImageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+    windFieldImageInfo.usage = VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT; // Transfer source so the simulation validation can read it back.
+    windFieldImageInfo.properties = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+    windFieldImageInfo.pImage = &windFieldImage;
+    windFieldImageInfo.pImageMemory = &windFieldImageMemory;
+    windFieldImageInfo.concurrent = true; // Transitioned and read back on the graphics queue.
+
+    VkResult ret = createImage(windFieldImageInfo);
+    if (ret != VK_SUCCESS) {
+        throw std::runtime_error("bad image creation.");
+        return ret;
+    }
+
+    // The image is written as a storage image and read through a sampler every frame, so it stays in the general layout for its lifetime.
+    transitionImageLayout(windFieldImage, windFieldFormat, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL);
+
+    windFieldImageView = createImageView(windFieldImage, windFieldFormat, VK_IMAGE_ASPECT_COLOR_BIT);
+
+    if (!windFieldImageView) {
+        throw std::runtime_error("bad wind field image view.");
+        return VK_ERROR_INITIALIZATION_FAILED;
+    }
+
+    return ret;
+}
+
 VkResult VulkanApplication::createFrameBuffers()
 {
+    CPU_PROFILE_ZONE("createFrameBuffers");
+
+    if (dynamicRendering) {
+        return VK_SUCCESS;
+    }
+
     swapchainData.framebuffers.resize(swapchainData.imageViews.size());
     for (size_t i = 0; i < swapchainData.imageViews.size(); i++) {
 
@@ -1222,23 +2452,43 @@ VkResult VulkanApplication::createFrameBuffers()
 
 VkResult VulkanApplication::createCommandPool()
 {
-    QueueFamilyIndices queueFamilyIndices = findQueueFamilies(m_PhysicalDevice, m_SurfaceKHR);
+    CPU_PROFILE_ZONE("createCommandPool");
 
     VkCommandPoolCreateInfo poolInfo = {};
     poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
     poolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
-    poolInfo.queueFamilyIndex = queueFamilyIndices.graphicsAndComputeFamily.value();
+    poolInfo.queueFamilyIndex = graphicsQueueFamily;
 
     if (vkCreateCommandPool(m_LogicalDevice, &poolInfo, nullptr, &commandPool) != VK_SUCCESS) {
         throw std::runtime_error("failed to create command pool!");
         return VK_ERROR_INITIALIZATION_FAILED;
     }
 
+    // Command buffers may only be submitted to queues of their pool's family.
+    poolInfo.queueFamilyIndex = computeQueueFamily;
+
+    if (vkCreateCommandPool(m_LogicalDevice, &poolInfo, nullptr, &computeCommandPool) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create compute command pool!");
+        return VK_ERROR_INITIALIZATION_FAILED;
+    }
+
+    // The secondary passes are recorded in parallel on the task pool. A pool may only be used by one thread at a time, so each pass has one
+    // of its own rather than each worker, which would tie a pass's command buffers to whichever worker first picked it up.
+    poolInfo.queueFamilyIndex = graphicsQueueFamily;
+    for (VkCommandPool& secondaryCommandPool : secondaryCommandPools) {
+        if (vkCreateCommandPool(m_LogicalDevice, &poolInfo, nullptr, &secondaryCommandPool) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create secondary command pool!");
+            return VK_ERROR_INITIALIZATION_FAILED;
+        }
+    }
+
     return VK_SUCCESS;
 }
 
 VkResult VulkanApplication::createDepthResources()
 {
+    CPU_PROFILE_ZONE("createDepthResources");
+
     VkFormat depthFormat = findDepthFormat();
 
     ImageCreateInfo depthImageInfo = {};
@@ -1266,6 +2516,8 @@ VkResult VulkanApplication::createDepthResources()
 
 VkResult VulkanApplication::createTextureResources()
 {
+    CPU_PROFILE_ZONE("createTextureResources");
+
     VkResult ret = VK_SUCCESS;
 
     ret = createHeightMapImage();
@@ -1286,27 +2538,37 @@ VkResult VulkanApplication::createTextureResources()
         return ret;
     }
 
+    ret = createWindFieldImage();
+    if (ret != VK_SUCCESS) {
+        throw std::runtime_error("bad wind field image creation.");
+        return ret;
+    }
+
     return ret;
 }
 
 VkResult VulkanApplication::createShaderStorageBuffers()
 {
-    VkDeviceSize bufferSize = sizeof(GrassBladeInstanceData) * kMaxBlades;
+    CPU_PROFILE_ZONE("createShaderStorageBuffers");
+
+    VkDeviceSize bufferSize = sizeof(GrassBladeInstanceData) * bladeCapacity;
 
     VkResult ret = VK_SUCCESS;
 
-    bladeInstanceDataBuffer.resize(kMaxFramesInFlight);
-    bladeInstanceDataBufferMemory.resize(kMaxFramesInFlight);
+    bladeInstanceDataBuffer.resize(framesInFlight);
+    bladeInstanceDataBufferMemory.resize(framesInFlight);
 
-    // Create 2 SSBOs per-framebuffer, this application uses double-buffering.
-    for (size_t i = 0; i < kMaxFramesInFlight; ++i) {
+    // Create one SSBO per-frame in flight. These hold the persistent blade state, each frame reads the previous frame's buffer and writes its
+    // own. With a single frame in flight both are the same buffer, which is safe as every invocation only reads and writes its own blade.
+    for (size_t i = 0; i < framesInFlight; ++i) {
         
         BufferCreateInfo buffer = {};
         buffer.size = bufferSize;
-        buffer.usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+        buffer.usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
         buffer.memProperties = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
         buffer.pBuffer = &bladeInstanceDataBuffer[i];
         buffer.pBufferMemory = &bladeInstanceDataBufferMemory[i];
+        buffer.concurrent = true; // Uploaded and read back on the graphics queue.
 
         ret = createBuffer(buffer);
 
@@ -1316,11 +2578,62 @@ VkResult VulkanApplication::createShaderStorageBuffers()
         }
     } 
 
+    // The compacted output of the culling pass, rebuilt every frame. On one queue a single buffer is shared by all frames, as each frame's
+    // culling waits for the previous draw in submission order. With async compute the next frame culls while this one draws, so each frame
+    // in flight gets its own.
+    size_t numVisibleBuffers = asyncCompute ? framesInFlight : 1;
+    visibleBladeInstanceDataBuffers.resize(numVisibleBuffers);
+    visibleBladeInstanceDataBufferMemory.resize(numVisibleBuffers);
+
+    for (size_t i = 0; i < numVisibleBuffers; ++i) {
+
+        BufferCreateInfo visibleBuffer = {};
+        visibleBuffer.size = bufferSize;
+        visibleBuffer.usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+        visibleBuffer.memProperties = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+        visibleBuffer.pBuffer = &visibleBladeInstanceDataBuffers[i];
+        visibleBuffer.pBufferMemory = &visibleBladeInstanceDataBufferMemory[i];
+        visibleBuffer.concurrent = true;
+
+        ret = createBuffer(visibleBuffer);
+        if (ret != VK_SUCCESS) {
+            throw std::runtime_error("bad buffer creation.");
+            return ret;
+        }
+    }
+
+    // One trample amount per-blade, ping-ponged with the blade state and starting upright (zero).
+    trampleBuffer.resize(framesInFlight);
+    trampleBufferMemory.resize(framesInFlight);
+
+    for (size_t i = 0; i < framesInFlight; ++i) {
+
+        BufferCreateInfo buffer = {};
+        buffer.size = sizeof(float) * bladeCapacity;
+        buffer.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+        buffer.memProperties = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+        buffer.pBuffer = &trampleBuffer[i];
+        buffer.pBufferMemory = &trampleBufferMemory[i];
+        buffer.concurrent = true; // Cleared on the graphics queue.
+
+        ret = createBuffer(buffer);
+        if (ret != VK_SUCCESS) {
+            throw std::runtime_error("bad buffer creation.");
+            return ret;
+        }
+
+        VkCommandBuffer commandBuffer = beginSingleTimeCommands();
+        vkCmdFillBuffer(commandBuffer, trampleBuffer[i], 0, VK_WHOLE_SIZE, 0);
+        endSingleTimeCommands(commandBuffer);
+    }
+
     return ret;
 }
 
 VkResult VulkanApplication::createVertexBuffer()
 {
+    CPU_PROFILE_ZONE("createVertexBuffer");
+
     // Define a return code for potentially dangerous function calls to ensure they ran correctly.
     VkResult ret = VK_ERROR_INITIALIZATION_FAILED; 
 
@@ -1443,6 +2756,8 @@ VkResult VulkanApplication::createVertexBuffer()
 
 VkResult VulkanApplication::createIndexBuffer()
 {
+    CPU_PROFILE_ZONE("createIndexBuffer");
+
     // Define a return code for potentially dangerous function calls to ensure they ran correctly.
     VkResult ret = VK_ERROR_INITIALIZATION_FAILED;
 
@@ -1565,20 +2880,71 @@ VkResult VulkanApplication::createIndexBuffer()
 
 VkResult VulkanApplication::createUniformBuffers()
 {
+    CPU_PROFILE_ZONE("createUniformBuffers");
+
     VkDeviceSize bufferSize = sizeof(CameraUniformBufferObject);
 
-    BufferCreateInfo buffer = {};
-    buffer.size = bufferSize;
-    buffer.usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
-    buffer.memProperties = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
-    buffer.pBuffer = &uniformBuffer;
-    buffer.pBufferMemory = &uniformBufferMemory;
+    VkResult ret = VK_SUCCESS;
 
-    VkResult ret = createBuffer(buffer);
+    uniformBuffers.resize(framesInFlight);
+    uniformBufferMemory.resize(framesInFlight);
+    uniformBufferMapped.resize(framesInFlight);
 
-    if (ret != VK_SUCCESS) {
-        throw std::runtime_error("bad buffer creation.");
-        return ret;
+    // One per-frame in flight since the CPU rewrites it every frame, kept mapped for the lifetime of the application.
+    for (size_t i = 0; i < framesInFlight; ++i) {
+
+        BufferCreateInfo buffer = {};
+        buffer.size = bufferSize;
+        buffer.usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
+        buffer.memProperties = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+        buffer.pBuffer = &uniformBuffers[i];
+        buffer.pBufferMemory = &uniformBufferMemory[i];
+        buffer.concurrent = true;
+
+        ret = createBuffer(buffer);
+        if (ret != VK_SUCCESS) {
+            throw std::runtime_error("bad buffer creation.");
+            return ret;
+        }
+
+        vkMapMemory(m_LogicalDevice, uniformBufferMemory[i], 0, bufferSize, 0, &uniformBufferMapped[i]);
+    }
+
+    return ret;
+}
+
+VkResult VulkanApplication::createColliderBuffers()
+{
+    CPU_PROFILE_ZONE("createColliderBuffers");
+
+    VkDeviceSize bufferSize = sizeof(ColliderBufferObject);
+
+    VkResult ret = VK_SUCCESS;
+
+    colliderBuffer.resize(framesInFlight);
+    colliderBufferMemory.resize(framesInFlight);
+    colliderBufferMapped.resize(framesInFlight);
+
+    // One per-frame in flight since the CPU rebuilds it every frame, kept mapped for the lifetime of the application.
+    for (size_t i = 0; i < framesInFlight; ++i) {
+
+        BufferCreateInfo buffer = {};
+        buffer.size = bufferSize;
+        buffer.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+        buffer.memProperties = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+        buffer.pBuffer = &colliderBuffer[i];
+        buffer.pBufferMemory = &colliderBufferMemory[i];
+
+        ret = createBuffer(buffer);
+        if (ret != VK_SUCCESS) {
+            throw std::runtime_error("bad buffer creation.");
+            return ret;
+        }
+
+        vkMapMemory(m_LogicalDevice, colliderBufferMemory[i], 0, bufferSize, 0, &colliderBufferMapped[i]);
+
+        // Start with no colliders in case the buffer is read before the first update.
+        ColliderGrid::build({}, *static_cast<ColliderBufferObject*>(colliderBufferMapped[i]));
     }
 
     return ret;
@@ -1586,12 +2952,19 @@ VkResult VulkanApplication::createUniformBuffers()
 
 VkResult VulkanApplication::createDescriptorPool()
 { 
+    CPU_PROFILE_ZONE("createDescriptorPool");
+
     // Pool sizes containing uniform buffer objects (UBO) and shader storage buffer objects (SSBO).
     // Also include one here for the dynamic storage buffer to be used for an arbitrary number of grass blade objects.
+    // The samplers are the height map (model and grass sets) and the wind field (grass set), the storage image is the wind field (wind field set).
+    // There is one model and one grass set per-frame in flight, each grass set with seven storage buffers (last state, visible blades, counters,
+    // current state, colliders, last trample, current trample).
 
     VkDescriptorPoolSize poolSizes[] = {
-        { VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1},
-        { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 4}
+        { VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 2 * framesInFlight},
+        { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 7 * framesInFlight},
+        { VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 3 * framesInFlight},
+        { VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1}
     };
 
     VkDescriptorPoolCreateInfo poolInfo = {};
@@ -1599,7 +2972,7 @@ VkResult VulkanApplication::createDescriptorPool()
     poolInfo.flags = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT; 
     poolInfo.poolSizeCount = (uint32_t)std::size(poolSizes); 
     poolInfo.pPoolSizes = poolSizes;
-    poolInfo.maxSets = 5; // Must be at >= the maximum pool size for one type.
+    poolInfo.maxSets = 2 * framesInFlight + 1; // The model and grass sets per-frame in flight, and the wind field set.
 
     if (vkCreateDescriptorPool(m_LogicalDevice, &poolInfo, nullptr, &descriptorPool) != VK_SUCCESS) {
         throw std::runtime_error("failed to create descriptor pool!");
@@ -1611,6 +2984,8 @@ VkResult VulkanApplication::createDescriptorPool()
 
 VkResult VulkanApplication::createDescriptorSets()
 {
+    CPU_PROFILE_ZONE("createDescriptorSets");
+
     VkResult ret = VK_SUCCESS; 
 
     ret = createModelDescriptorSets();
@@ -1625,11 +3000,19 @@ VkResult VulkanApplication::createDescriptorSets()
         return ret;
     }
 
+    ret = createWindFieldDescriptorSets();
+    if (ret != VK_SUCCESS) {
+        throw std::runtime_error("could not create wind field descriptor sets.");
+        return ret;
+    }
+
     return ret;
 }
 
 VkResult VulkanApplication::createCommandBuffers()
 {
+    CPU_PROFILE_ZONE("createCommandBuffers");
+
     VkResult ret = VK_SUCCESS;
 
     ret = createGraphicsCommandBuffer();
@@ -1649,39 +3032,40 @@ VkResult VulkanApplication::createCommandBuffers()
 
 VkResult VulkanApplication::createSynchronizationObjects()
 {
-    // Graphics synchronisation.
-    imageAvailableSemaphores.resize(kMaxFramesInFlight);
-    renderFinishedSemaphores.resize(kMaxFramesInFlight);
-    inFlightFences.resize(kMaxFramesInFlight);
+    CPU_PROFILE_ZONE("createSynchronizationObjects");
+
+    // Frame pacing, one timeline per queue. Each submit signals the next value, so a frame slot is free once both timelines reach the
+    // values its last frame signalled, with no fences to reset.
+    VkSemaphoreTypeCreateInfo timelineTypeInfo = {};
+    timelineTypeInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+    timelineTypeInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+    timelineTypeInfo.initialValue = 0;
+
+    VkSemaphoreCreateInfo timelineInfo{};
+    timelineInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+    timelineInfo.pNext = &timelineTypeInfo;
+
+    if (vkCreateSemaphore(m_LogicalDevice, &timelineInfo, nullptr, &computeTimeline) != VK_SUCCESS ||
+        vkCreateSemaphore(m_LogicalDevice, &timelineInfo, nullptr, &graphicsTimeline) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create timeline semaphores!");
+        return VK_ERROR_INITIALIZATION_FAILED;
+    }
+
+    // Swapchain synchronisation, acquire and present only take binary semaphores.
+    imageAvailableSemaphores.resize(framesInFlight);
+    renderFinishedSemaphores.resize(framesInFlight);
 
     VkSemaphoreCreateInfo semaphoreInfo{};
     semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
 
-    VkFenceCreateInfo fenceInfo{};
-    fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
-    fenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
-
-    for (size_t i = 0; i < kMaxFramesInFlight; i++) {
+    for (size_t i = 0; i < framesInFlight; i++) {
         if (vkCreateSemaphore(m_LogicalDevice, &semaphoreInfo, nullptr, &imageAvailableSemaphores[i]) != VK_SUCCESS ||
-            vkCreateSemaphore(m_LogicalDevice, &semaphoreInfo, nullptr, &renderFinishedSemaphores[i]) != VK_SUCCESS ||
-            vkCreateFence(m_LogicalDevice, &fenceInfo, nullptr, &inFlightFences[i]) != VK_SUCCESS) {
+            vkCreateSemaphore(m_LogicalDevice, &semaphoreInfo, nullptr, &renderFinishedSemaphores[i]) != VK_SUCCESS) {
             throw std::runtime_error("failed to create graphics synchronization objects for a frame!");
             return VK_ERROR_INITIALIZATION_FAILED;
         }
     }
 
-    // Compute synchronisation.
-    computeInFlightFences.resize(kMaxFramesInFlight);
-    computeFinishedSemaphores.resize(kMaxFramesInFlight);
-
-    for (size_t i = 0; i < kMaxFramesInFlight; i++) {
-        if (vkCreateSemaphore(m_LogicalDevice, &semaphoreInfo, nullptr, &computeFinishedSemaphores[i]) != VK_SUCCESS ||
-            vkCreateFence(m_LogicalDevice, &fenceInfo, nullptr, &computeInFlightFences[i]) != VK_SUCCESS) {
-            throw std::runtime_error("failed to create compute synchronization objects for a frame!");
-            return VK_ERROR_INITIALIZATION_FAILED;
-        }
-    }
-
     return VK_SUCCESS;
 }
 
@@ -1700,6 +3084,8 @@ VkResult VulkanApplication::createDefaultCamera()
 
 VkResult VulkanApplication::createImGuiImplementation()
 {
+    CPU_PROFILE_ZONE("createImGuiImplementation");
+
     VkDescriptorPoolSize pool_sizes[] = { 
         { VK_DESCRIPTOR_TYPE_SAMPLER, 1000 },
         { VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1000 },
@@ -1737,10 +3123,16 @@ VkResult VulkanApplication::createImGuiImplementation()
     init_info.Device = m_LogicalDevice;
     init_info.Queue = graphicsQueue;
     init_info.DescriptorPool = imguiDescriptorPool;
-    init_info.MinImageCount = 3;
-    init_info.ImageCount = 3;
+    // ImGui only uses the image count to size its per-frame vertex buffers, which must outlast the frames in flight, so it does not
+    // need reinitialising when the swapchain is recreated with a different count.
+    init_info.MinImageCount = std::max(2u, swapchainData.capabilities.minImageCount);
+    init_info.ImageCount = std::max({ init_info.MinImageCount, static_cast<uint32_t>(swapchainData.images.size()), framesInFlight });
     init_info.MSAASamples = VK_SAMPLE_COUNT_1_BIT;
     init_info.RenderPass = renderPass;
+#if defined(IMGUI_IMPL_VULKAN_HAS_DYNAMIC_RENDERING) && IMGUI_VERSION_NUM >= 19090
+    init_info.UseDynamicRendering = dynamicRendering;
+    init_info.PipelineRenderingCreateInfo = pipelineRenderingInfo;
+#endif
     init_info.Allocator = nullptr;
 
     ImGui_ImplVulkan_Init(&init_info);
@@ -1750,37 +3142,49 @@ VkResult VulkanApplication::createImGuiImplementation()
 
 void VulkanApplication::createMeshObjects()
 {
-    // Construct a plane mesh, for the ground.
-    MeshTransform _groundPlane = quadMesh.generateQuad(glm::vec3(0.0f, 0.0f, 0.0f));
+    CPU_PROFILE_ZONE("createMeshObjects");
+
+    // Construct a plane mesh, for the ground. Without tessellation the plane is subdivided up front so it can still be displaced by the height map.
+    MeshTransform _groundPlane = (grassRenderPath == GrassRenderPath::Tessellated) 
+        ? quadMesh.generateQuad(glm::vec3(0.0f, 0.0f, 0.0f)) 
+        : quadMesh.generateGrid(glm::vec3(0.0f, 0.0f, 0.0f), kTerrainGridResolution);
     _groundPlane.position = glm::vec3(0.0f, 0.0f, 0.0f); // X is right. Y is forward. Z is up.
     _groundPlane.rotation = glm::vec3(0.0f, 0.0f, 45.0f);
     _groundPlane.scale = glm::vec3(MEADOW_SCALE_X, MEADOW_SCALE_Y, MEADOW_SCALE_Z); 
+
+    // Calculate the bounds of the flat plane (Z is not needed yet as there is no terrain height on the host, this is done in tessellation).
+    glm::vec2 bounds = getMeadowBounds();
+    _groundPlane.position.x += bounds.x;
+    _groundPlane.position.y += bounds.y;
     groundPlane = _groundPlane;
+
+    // The base blade mesh, later tessellated and aligned to each blade's bezier curve. One shape is shared by every instance.
+    bladeShapeMesh.generateShape();
 }
 
 void VulkanApplication::populateBladeInstanceBuffer()
 {
-    // Based on the bounds of the plane, populate the blade instance container with values to be staged to the GPU later.
+    CPU_PROFILE_ZONE("populateBladeInstanceBuffer");
 
-    // Prepare the instance buffer.
-    localBladeInstanceBuffer.reserve(kMaxBlades);
+    // Based on the bounds of the plane, populate the blade instance container with values to be staged to the GPU later. Runs on the task
+    // pool during initialisation, so it only uses the meadow bounds and sceneSettings, never groundPlane.
+    const glm::vec2 bounds = getMeadowBounds();
 
-    // Calculate the bounds of the flat plane (Z is not needed yet as there is no terrain height on the host, this is done in tessellation).
-    glm::vec2 offset = glm::vec2(-150.0f, 20.0f);        // Scale 120| -150, 20
-    groundPlane.position.x += MEADOW_SCALE_X + offset.x; // -30.0f x | ranges [-30, +140]
-    groundPlane.position.y += MEADOW_SCALE_Y + offset.y; // 140.0f y | ranges [-30, +140]
+    // Prepare the instance buffer.
+    localBladeInstanceBuffer.clear();
+    localBladeInstanceBuffer.reserve(sceneSettings.numBlades);
 
     const float zFightingEpsilon = 0.01f; // Small value to avoid the grass being clipped into the ground and causing z-fighting.
 
     // Do this outside the loop to avoid continuously creating struct instances, just change the data inside it.
     GrassBladeInstanceData bladeInstanceData = {};
 
-    for (size_t i = 0; i < kMaxBlades; ++i) {
+    for (size_t i = 0; i < sceneSettings.numBlades; ++i) {
 
         // Using pre-calculated bounds and no Z variation, generate a random point on the plane's surface. 
         glm::vec3 randomPositionOnPlaneBounds = {};
-        randomPositionOnPlaneBounds.x = Utils::getRandomFloat(groundPlane.position.x, groundPlane.position.y);
-        randomPositionOnPlaneBounds.y = Utils::getRandomFloat(groundPlane.position.x, groundPlane.position.y); 
+        randomPositionOnPlaneBounds.x = Utils::getRandomFloat(bounds.x, bounds.y);
+        randomPositionOnPlaneBounds.y = Utils::getRandomFloat(bounds.x, bounds.y); 
         randomPositionOnPlaneBounds.z = zFightingEpsilon;
 
         // Create an instance of a grass blade, and define its' natural world position.
@@ -1796,24 +3200,39 @@ void VulkanApplication::populateBladeInstanceBuffer()
 
         // Add this blade to the instance buffer.
         localBladeInstanceBuffer.push_back(bladeInstanceData);
+    }
+
+    // Sort the blades tile by tile (the collider grid cells), so each compute warp works on blades that are close together and mostly agrees on
+    // culling, simulation tier, and collider cell instead of diverging as it would with blades in random order.
+    const float tileSize = kColliderGridWorldSize / kColliderGridResolution;
+    std::vector<uint64_t> sortKeys(localBladeInstanceBuffer.size());
+    for (size_t i = 0; i < localBladeInstanceBuffer.size(); ++i) {
+        const glm::vec4& p0 = localBladeInstanceBuffer[i].p0_width;
+        uint64_t tileX = static_cast<uint64_t>(glm::clamp((p0.x - kColliderGridOrigin) / tileSize, 0.0f, kColliderGridResolution - 1.0f));
+        uint64_t tileY = static_cast<uint64_t>(glm::clamp((p0.y - kColliderGridOrigin) / tileSize, 0.0f, kColliderGridResolution - 1.0f));
+        sortKeys[i] = ((tileY * kColliderGridResolution + tileX) << 32) | i;
+    }
+    std::sort(sortKeys.begin(), sortKeys.end());
 
-        // Create a base mesh instance for a grass blade, to later be tessellated and aligned to its' bezier curve.
-        MeshTransform baseBladeGeometry = bladeShapeMesh.generateShape();
-        baseBladeGeometry.position = glm::vec3(bladeInstance.p0AndWidth.x, bladeInstance.p0AndWidth.y, bladeInstance.p0AndWidth.z); 
-        baseBladeGeometry.scale = glm::vec3(1.0f); 
+    std::vector<GrassBladeInstanceData> sortedBlades(localBladeInstanceBuffer.size());
+    for (size_t i = 0; i < sortKeys.size(); ++i) {
+        sortedBlades[i] = localBladeInstanceBuffer[sortKeys[i] & 0xFFFFFFFFu];
     }
+    localBladeInstanceBuffer.swap(sortedBlades);
 }
 
 void VulkanApplication::createBladeInstanceStagingBuffer()
 {
-    // Calculate the required size for the staging buffer.
-    VkDeviceSize bladeInstanceBufferRequiredSize = sizeof(GrassBladeInstanceData) * kMaxBlades;
+    CPU_PROFILE_ZONE("createBladeInstanceStagingBuffer");
 
-    bladeInstanceStagingBuffer.resize(kMaxFramesInFlight);
-    bladeInstanceStagingBufferMemory.resize(kMaxFramesInFlight);
+    // Calculate the required size for the staging buffer, large enough for any blade count up to the capacity.
+    VkDeviceSize bladeInstanceBufferRequiredSize = sizeof(GrassBladeInstanceData) * bladeCapacity;
+
+    bladeInstanceStagingBuffer.resize(framesInFlight);
+    bladeInstanceStagingBufferMemory.resize(framesInFlight);
 
     // Create 2 staging buffers per-SSBO, this application uses double-buffering.
-    for (size_t i = 0; i < kMaxFramesInFlight; ++i) {
+    for (size_t i = 0; i < framesInFlight; ++i) {
 
         BufferCreateInfo buffer = {};
         buffer.size = bladeInstanceBufferRequiredSize;
@@ -1827,36 +3246,63 @@ void VulkanApplication::createBladeInstanceStagingBuffer()
         if (ret != VK_SUCCESS) {
             throw std::runtime_error("bad buffer creation.");
         }
+    }
+
+    uploadBladeInstances();
+}
+
+void VulkanApplication::uploadBladeInstances()
+{
+    CPU_PROFILE_ZONE("uploadBladeInstances");
+
+    VkDeviceSize bladeInstanceDataSize = sizeof(GrassBladeInstanceData) * localBladeInstanceBuffer.size();
+
+    for (size_t i = 0; i < framesInFlight; ++i) {
 
         // To upload data to the GPU, you first need to map and copy the CPU local data to a staging buffer,
         // then make sure to copy the staging buffer data over to the shader resource buffer using a single time command.
 
         // Map the memory and copy the data from the local vector into the staging buffer.
         void* data;
-        vkMapMemory(m_LogicalDevice, bladeInstanceStagingBufferMemory[i], 0, bladeInstanceBufferRequiredSize, 0, &data);
-        memcpy(data, localBladeInstanceBuffer.data(), (size_t)bladeInstanceBufferRequiredSize);
+        vkMapMemory(m_LogicalDevice, bladeInstanceStagingBufferMemory[i], 0, bladeInstanceDataSize, 0, &data);
+        memcpy(data, localBladeInstanceBuffer.data(), (size_t)bladeInstanceDataSize);
         vkUnmapMemory(m_LogicalDevice, bladeInstanceStagingBufferMemory[i]);
 
         // Copy data from the staging buffer (host) to the shader storage buffer (GPU).
-        copyBuffer(bladeInstanceStagingBuffer[i], bladeInstanceDataBuffer[i], bladeInstanceBufferRequiredSize);
-    }    
+        copyBuffer(bladeInstanceStagingBuffer[i], bladeInstanceDataBuffer[i], bladeInstanceDataSize);
+    }
 }
 
 void VulkanApplication::createNumBladesBuffer()
 {
+    CPU_PROFILE_ZONE("createNumBladesBuffer");
+
     VkDeviceSize numBladesBufferRequiredSize = sizeof(NumBladesBufferObject);
 
-    BufferCreateInfo buffer = {};
-    buffer.size = numBladesBufferRequiredSize;
-    buffer.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
-    buffer.memProperties = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
-    buffer.pBuffer = &numBladesBuffer;
-    buffer.pBufferMemory = &numBladesBufferMemory;
+    numBladesBuffers.resize(framesInFlight);
+    numBladesBufferMemory.resize(framesInFlight);
+    numBladesBufferMapped.resize(framesInFlight);
 
-    VkResult ret = createBuffer(buffer);
+    // One per-frame in flight so the counts can be read once their frame has completed, while later frames cull into their own.
+    for (size_t i = 0; i < framesInFlight; ++i) {
 
-    if (ret != VK_SUCCESS) {
-        throw std::runtime_error("bad buffer creation");
+        BufferCreateInfo buffer = {};
+        buffer.size = numBladesBufferRequiredSize;
+        buffer.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+        buffer.memProperties = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+        buffer.pBuffer = &numBladesBuffers[i];
+        buffer.pBufferMemory = &numBladesBufferMemory[i];
+        buffer.concurrent = true;
+
+        VkResult ret = createBuffer(buffer);
+
+        if (ret != VK_SUCCESS) {
+            throw std::runtime_error("bad buffer creation");
+        }
+
+        // Nothing has been culled before the first frame.
+        vkMapMemory(m_LogicalDevice, numBladesBufferMemory[i], 0, numBladesBufferRequiredSize, 0, &numBladesBufferMapped[i]);
+        memset(numBladesBufferMapped[i], 0, sizeof(NumBladesBufferObject));
     }
 }
 
@@ -1875,15 +3321,137 @@ void VulkanApplication::prepareImGuiDrawData()
     ImGui::Text("Frames per second: %f", 1 / (lastFrameTime / 1000));
     ImGui::Text("Delta time: %f", deltaTime);
     ImGui::Text("Frame number: %i", frameCount);
+    ImGui::Text("Frames in flight: %u", framesInFlight);
+    ImGui::Text("Async compute: %s", asyncCompute ? "Yes" : "No");
+    ImGui::Text("Rendering: %s", dynamicRendering ? "Dynamic rendering" : "Render pass");
+    ImGui::Text("Swapchain recreations: %u (last %.3f ms / max %.3f ms)", swapchainRecreationStats.count, swapchainRecreationStats.lastMs,
+        swapchainRecreationStats.maxMs);
+
+    // Both take effect by recreating the swapchain after the next present. Unsupported modes can still be picked to test the fallback.
+    if (ImGui::BeginCombo("Present mode", getPresentModeName(requestedPresentMode))) {
+        for (VkPresentModeKHR presentMode : { VK_PRESENT_MODE_FIFO_KHR, VK_PRESENT_MODE_MAILBOX_KHR, VK_PRESENT_MODE_IMMEDIATE_KHR }) {
+            bool supported = std::find(swapchainData.presentModes.begin(), swapchainData.presentModes.end(), presentMode) != swapchainData.presentModes.end();
+            std::string label = std::string(getPresentModeName(presentMode)) + (supported ? "" : " (unsupported)");
+            if (ImGui::Selectable(label.c_str(), presentMode == requestedPresentMode)) {
+                setPresentMode(presentMode);
+            }
+        }
+        ImGui::EndCombo();
+    }
+    int imageCount = static_cast<int>(requestedImageCount);
+    int maxImageCount = (swapchainData.capabilities.maxImageCount > 0) ? static_cast<int>(swapchainData.capabilities.maxImageCount) : 8; // 0 is no limit.
+    if (ImGui::SliderInt("Swapchain images (0: auto)", &imageCount, 0, maxImageCount)) {
+        setSwapchainImageCount(static_cast<uint32_t>(imageCount));
+    }
+    ImGui::Text("Presenting: %s, %zu images", getPresentModeName(swapchainData.presentMode), swapchainData.images.size());
+    ImGui::SliderFloat("Frame limit (0: off)", &frameLimit, 0.0f, 240.0f, "%.0f fps");
+    ImGui::Text("Input to present: %.3f ms avg / %.3f ms last", averageInputToPresentMs, lastInputToPresentMs);
+
+    ImGui::Separator();
+
+    ImGui::Text("Max grass blade count: %u (capacity %u)", sceneSettings.numBlades, bladeCapacity);
+    ImGui::Text("Num grass blades culled: %u", sceneSettings.numBlades - driverData.numVisible); 
+
+    ImGui::Separator();
+
+    ImGui::Text("Grass blades: %u/%u", driverData.numVisible, sceneSettings.numBlades);
+    ImGui::Text("Grass render path: %s", (grassRenderPath == GrassRenderPath::Tessellated) ? "Tessellated" : "Instanced strip");
+    ImGui::Checkbox("Frustum culling", &sceneSettings.frustumCulling);
+
+    // Each size is a specialization constant of its own pipeline variant, built the first time it is selected.
+    if (ImGui::BeginCombo("Compute workgroup size", std::to_string(sceneSettings.computeWorkgroupSize).c_str())) {
+        for (uint32_t size = 32; size <= std::min(deviceProperties.limits.maxComputeWorkGroupSize[0], deviceProperties.limits.maxComputeWorkGroupInvocations); size *= 2) {
+            if (ImGui::Selectable(std::to_string(size).c_str(), size == sceneSettings.computeWorkgroupSize)) {
+                sceneSettings.computeWorkgroupSize = size;
+            }
+        }
+        ImGui::EndCombo();
+    }
+    ImGui::Text("Compute pipeline variants built: %zu", computePipelineVariants.size());
+    ImGui::Text("Terrain and grass recordings: %u", sceneCommandRecordings);
+    ImGui::Text("Shader hot reload: %s", shaderReloadStatus.c_str());
+    if (grassRenderPath == GrassRenderPath::Tessellated) {
+        ImGui::SliderFloat("Max tessellation level", &sceneSettings.maxTessellationLevel, sceneSettings.minTessellationLevel, 64.0f, "%.0f");
+    }
+
+    ImGui::Separator();
+
+    // GPU pass timings, resolved framesInFlight frames late so reading them never stalls.
+    if (gpuProfiler.isEnabled()) {
+        for (uint32_t i = 0; i < static_cast<uint32_t>(GpuScope::Count); ++i) {
+            GpuScopeStatistics statistics = gpuProfiler.getStatistics(static_cast<GpuScope>(i));
+            ImGui::Text("%s: %.3f ms avg / %.3f ms p99", getGpuScopeName(static_cast<GpuScope>(i)), statistics.average, statistics.p99);
+        }
+
+        // Culling of the next frame running while this one rasterises, zero on a shared queue.
+        GpuScopeStatistics overlap = gpuProfiler.getComputeOverlapStatistics();
+        ImGui::Text("Compute overlap: %.3f ms avg / %.3f ms last", overlap.average, overlap.last);
+    }
+    else {
+        ImGui::Text("GPU timings: timestamps not supported by this queue.");
+    }
+
+    // Pipeline statistics, resolved with the timings. Per-blade figures divide by the visible blade count of the current frame.
+    if (gpuProfiler.isPipelineStatisticsEnabled()) {
+        const PipelineStatistics& culling = gpuProfiler.getPipelineStatistics(GpuStatisticsScope::Culling);
+        const PipelineStatistics& terrain = gpuProfiler.getPipelineStatistics(GpuStatisticsScope::Terrain);
+        const PipelineStatistics& grass = gpuProfiler.getPipelineStatistics(GpuStatisticsScope::Grass);
+        double numVisible = static_cast<double>(std::max(driverData.numVisible, 1u));
+
+        ImGui::Text("Compute invocations: %llu", static_cast<unsigned long long>(culling.computeShaderInvocations));
+        ImGui::Text("Terrain: %llu VS / %llu FS invocations", static_cast<unsigned long long>(terrain.vertexShaderInvocations),
+            static_cast<unsigned long long>(terrain.fragmentShaderInvocations));
+        ImGui::Text("Grass: %llu VS invocations", static_cast<unsigned long long>(grass.vertexShaderInvocations));
+        ImGui::Text("Grass: %llu TCS patches / %llu TES invocations", static_cast<unsigned long long>(grass.tessellationControlPatches),
+            static_cast<unsigned long long>(grass.tessellationEvaluationInvocations));
+        ImGui::Text("Grass: %llu -> %llu clipped primitives", static_cast<unsigned long long>(grass.clippingInvocations),
+            static_cast<unsigned long long>(grass.clippingPrimitives));
+        ImGui::Text("Grass: %llu FS invocations", static_cast<unsigned long long>(grass.fragmentShaderInvocations));
+        ImGui::Text("Grass per-blade: %.1f TES / %.1f FS", grass.tessellationEvaluationInvocations / numVisible, grass.fragmentShaderInvocations / numVisible);
+    }
+    else {
+        ImGui::Text("Pipeline statistics: not supported by this device.");
+    }
+
+    ImGui::Separator();
+
+    ImGui::Checkbox("Wind", &windParameters.enabled);
+    ImGui::Checkbox("Wind field (off: per-blade Perlin noise)", &sceneSettings.windField);
+    ImGui::SliderFloat("Wind direction", &windParameters.directionDegrees, 0.0f, 360.0f, "%.0f deg");
+    ImGui::SliderFloat("Wind strength", &windParameters.strength, 0.0f, 2.0f);
+    ImGui::SliderFloat("Gust strength", &windParameters.gustStrength, 0.0f, 2.0f);
+    ImGui::SliderFloat("Gust frequency", &windParameters.gustFrequency, 0.0f, 2.0f);
 
     ImGui::Separator();
 
-    ImGui::Text("Max grass blade count: %u", kMaxBlades);
-    ImGui::Text("Num grass blades culled: %u", kMaxBlades - driverData.numVisible); 
+    ImGui::SliderFloat("Gravity", &simulationParameters.gravity, 0.0f, 10.0f);
+    ImGui::SliderFloat("Wind force", &simulationParameters.windForce, 0.0f, 20.0f);
+    ImGui::SliderFloat("Trample recovery time", &simulationParameters.trampleRecoveryTime, 0.1f, 20.0f, "%.1f s");
+    ImGui::SliderFloat("Simulation distance", &simulationParameters.simulationDistance, 0.0f, 250.0f);
+    ImGui::SliderFloat("Sway distance", &simulationParameters.swayDistance, 0.0f, 250.0f);
+    simulationParameters.swayDistance = glm::max(simulationParameters.swayDistance, simulationParameters.simulationDistance);
+    ImGui::Text("Simulated: %u / Swaying: %u / Static: %u", driverData.numSimulated, driverData.numSwaying, driverData.numStatic);
+
+    // The CPU reference only models the wind field, not the per-blade Perlin fallback. With one frame in flight the state is simulated in
+    // place, leaving no previous state to step the reference from.
+    if (windParameters.enabled && sceneSettings.windField && framesInFlight > 1 && ImGui::Button("Validate simulation")) {
+        validateBladeSimulation();
+    }
+
+    if (hasSimulationValidation) {
+        ImGui::Text("Simulated blades checked: %u/%u", simulationValidation.compared, simulationValidation.sampled);
+        ImGui::Text("Mismatched: %u (tolerance %.4f)", simulationValidation.mismatched, kSimulationValidationTolerance);
+        ImGui::Text("Max error: %.6f / Mean error: %.6f", simulationValidation.maxError, simulationValidation.meanError);
+    }
 
     ImGui::Separator();
 
-    ImGui::Text("Grass blades: %u/%u", driverData.numVisible, kMaxBlades);
+    ImGui::Checkbox("Camera collider", &colliderParameters.cameraCollider);
+    ImGui::SliderFloat("Camera collider radius", &colliderParameters.cameraColliderRadius, 0.1f, 5.0f);
+    ImGui::SliderInt("Orbiting colliders", &colliderParameters.numOrbitingColliders, 0, kMaxColliders - 1);
+    ImGui::SliderFloat("Orbiting collider radius", &colliderParameters.orbitingColliderRadius, 0.1f, 5.0f);
+    ImGui::SliderFloat("Orbit speed", &colliderParameters.orbitSpeed, 0.0f, 2.0f);
+    ImGui::Text("Colliders: %u/%u", static_cast<uint32_t>(colliders.size()), kMaxColliders);
 
     ImGui::Separator();
 
@@ -1906,6 +3474,14 @@ VkResult VulkanApplication::createBuffer(BufferCreateInfo& bufferCreateInfo)
     bufferInfo.size = bufferCreateInfo.size;
     bufferInfo.usage = bufferCreateInfo.usage;
     bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+    // Resources used by both queues are shared concurrently, when they are of different families, rather than transferring ownership twice a frame.
+    uint32_t queueFamilyIndices[] = { graphicsQueueFamily, computeQueueFamily };
+    if (bufferCreateInfo.concurrent && graphicsQueueFamily != computeQueueFamily) {
+        bufferInfo.sharingMode = VK_SHARING_MODE_CONCURRENT;
+        bufferInfo.queueFamilyIndexCount = 2;
+        bufferInfo.pQueueFamilyIndices = queueFamilyIndices;
+    }
     
     if (vkCreateBuffer(m_LogicalDevice, &bufferInfo, nullptr, bufferCreateInfo.pBuffer) != VK_SUCCESS) {
         throw std::runtime_error("failed to create buffer!");
@@ -1947,6 +3523,13 @@ VkResult VulkanApplication::createImage(ImageCreateInfo& imageCreateInfo)
     imageInfo.samples = imageCreateInfo.numSamples;
     imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
 
+    uint32_t queueFamilyIndices[] = { graphicsQueueFamily, computeQueueFamily };
+    if (imageCreateInfo.concurrent && graphicsQueueFamily != computeQueueFamily) {
+        imageInfo.sharingMode = VK_SHARING_MODE_CONCURRENT;
+        imageInfo.queueFamilyIndexCount = 2;
+        imageInfo.pQueueFamilyIndices = queueFamilyIndices;
+    }
+
     if (vkCreateImage(m_LogicalDevice, &imageInfo, nullptr, imageCreateInfo.pImage) != VK_SUCCESS) {
         throw std::runtime_error("failed to create image!");
         return VK_ERROR_INITIALIZATION_FAILED;
@@ -1965,50 +3548,274 @@ VkResult VulkanApplication::createImage(ImageCreateInfo& imageCreateInfo)
         return VK_ERROR_INITIALIZATION_FAILED;
     }
 
-    vkBindImageMemory(m_LogicalDevice, *imageCreateInfo.pImage, *imageCreateInfo.pImageMemory, 0);
-
-    return VK_SUCCESS;
+    vkBindImageMemory(m_LogicalDevice, *imageCreateInfo.pImage, *imageCreateInfo.pImageMemory, 0);
+
+    return VK_SUCCESS;
+}
+
+void VulkanApplication::copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size)
+{
+    VkCommandBuffer commandBuffer = beginSingleTimeCommands();
+    
+    VkBufferCopy copyRegion = {};
+    copyRegion.srcOffset = 0;
+    copyRegion.dstOffset = 0;
+    copyRegion.size = size;
+    vkCmdCopyBuffer(commandBuffer, srcBuffer, dstBuffer, 1, &copyRegion);
+    
+    endSingleTimeCommands(commandBuffer);
+}
+
+void VulkanApplication::recordCommandBuffer(VkCommandBuffer commandBuffer, uint32_t imageIndex)
+{
+    CPU_PROFILE_ZONE("recordCommandBuffer");
+
+    VkCommandBufferBeginInfo beginInfo{};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+
+    if (vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS) {
+        throw std::runtime_error("failed to begin recording command buffer!");
+    }
+
+    // Reset the graphics scopes' queries before the render pass, the compute command buffer only resets its own.
+    gpuProfiler.beginGraphicsFrame(commandBuffer, currentFrame);
+
+    std::array<VkClearValue, 2> clearValues = {};
+    clearValues[0] = {};
+    clearValues[0].color = { { 0.05f, 0.3f, 0.9f, 1.0f} };
+    clearValues[1] = {};
+    clearValues[1].depthStencil = { 1.0f, 0 };
+
+    // The render pass only executes secondary command buffers, so the draws need not be recorded into this primary, which changes with the
+    // acquired image.
+    if (dynamicRendering) {
+        beginDynamicRendering(commandBuffer, imageIndex, clearValues);
+    }
+    else {
+        VkRenderPassBeginInfo renderPassInfo = {};
+        renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+        renderPassInfo.renderPass = renderPass;
+        renderPassInfo.framebuffer = swapchainData.framebuffers[imageIndex];
+        renderPassInfo.renderArea.offset = { 0, 0 };
+        renderPassInfo.renderArea.extent = swapchainData.extents;
+        renderPassInfo.clearValueCount = static_cast<uint32_t>(clearValues.size());
+        renderPassInfo.pClearValues = clearValues.data();
+
+        vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+    }
+
+    waitForSecondaryRecording();
+
+    // Executing the terrain and grass command buffers writes their scopes' queries again, whether or not they were recorded this frame.
+    gpuProfiler.markScope(currentFrame, GpuScope::Terrain);
+    gpuProfiler.markScope(currentFrame, GpuScope::Grass);
+    gpuProfiler.markStatistics(currentFrame, GpuStatisticsScope::Terrain);
+    gpuProfiler.markStatistics(currentFrame, GpuStatisticsScope::Grass);
+
+    std::array<VkCommandBuffer, static_cast<size_t>(SecondaryPass::Count)> passCommandBuffers = {};
+    uint32_t passCount = headless ? static_cast<uint32_t>(SecondaryPass::ImGui) : static_cast<uint32_t>(SecondaryPass::Count);
+    for (uint32_t pass = 0; pass < passCount; ++pass) {
+        passCommandBuffers[pass] = secondaryCommandBuffers[pass][currentFrame];
+    }
+    vkCmdExecuteCommands(commandBuffer, passCount, passCommandBuffers.data());
+
+    if (dynamicRendering) {
+        endDynamicRendering(commandBuffer, imageIndex);
+    }
+    else {
+        vkCmdEndRenderPass(commandBuffer);
+    }
+
+    if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS) {
+        throw std::runtime_error("failed to record command buffer!");
+    }
+}
+
+void VulkanApplication::beginDynamicRendering(VkCommandBuffer commandBuffer, uint32_t imageIndex, const std::array<VkClearValue, 2>& clearValues)
+{
+    // Both attachments are cleared, so their previous contents are discarded. The colour write waits for the acquire semaphore's stage,
+    // and the depth write for the last frame's depth tests, as every frame shares the one depth attachment.
+    VkFormat depthFormat = pipelineRenderingInfo.depthAttachmentFormat;
+    bool hasStencil = depthFormat == VK_FORMAT_D32_SFLOAT_S8_UINT || depthFormat == VK_FORMAT_D24_UNORM_S8_UINT;
+
+    std::array<VkImageMemoryBarrier, 2> barriers = {};
+    barriers[0].sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barriers[0].srcAccessMask = 0;
+    barriers[0].dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+    barriers[0].oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    barriers[0].newLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+    barriers[0].srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barriers[0].dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barriers[0].image = swapchainData.images[imageIndex];
+    barriers[0].subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+
+    barriers[1].sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barriers[1].srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+    barriers[1].dstAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+    barriers[1].oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    barriers[1].newLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+    barriers[1].srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barriers[1].dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barriers[1].image = depthImage;
+    barriers[1].subresourceRange = { VK_IMAGE_ASPECT_DEPTH_BIT | (hasStencil ? VK_IMAGE_ASPECT_STENCIL_BIT : 0u), 0, 1, 0, 1 };
+
+    VkPipelineStageFlags stages = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT
+        | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+    vkCmdPipelineBarrier(commandBuffer, stages, stages, 0, 0, nullptr, 0, nullptr, static_cast<uint32_t>(barriers.size()), barriers.data());
+
+    VkRenderingAttachmentInfo colorAttachment = {};
+    colorAttachment.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO;
+    colorAttachment.imageView = swapchainData.imageViews[imageIndex];
+    colorAttachment.imageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+    colorAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+    colorAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+    colorAttachment.clearValue = clearValues[0];
+
+    VkRenderingAttachmentInfo depthAttachment = {};
+    depthAttachment.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO;
+    depthAttachment.imageView = depthImageView;
+    depthAttachment.imageLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+    depthAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+    depthAttachment.storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+    depthAttachment.clearValue = clearValues[1];
+
+    VkRenderingInfo renderingInfo = {};
+    renderingInfo.sType = VK_STRUCTURE_TYPE_RENDERING_INFO;
+    renderingInfo.flags = VK_RENDERING_CONTENTS_SECONDARY_COMMAND_BUFFERS_BIT;
+    renderingInfo.renderArea.offset = { 0, 0 };
+    renderingInfo.renderArea.extent = swapchainData.extents;
+    renderingInfo.layerCount = 1;
+    renderingInfo.colorAttachmentCount = 1;
+    renderingInfo.pColorAttachments = &colorAttachment;
+    renderingInfo.pDepthAttachment = &depthAttachment;
+
+    vkCmdBeginRendering(commandBuffer, &renderingInfo);
+}
+
+void VulkanApplication::endDynamicRendering(VkCommandBuffer commandBuffer, uint32_t imageIndex)
+{
+    vkCmdEndRendering(commandBuffer);
+
+    // Presentation waits on the render finished semaphore, so only the layout needs to change for it.
+    VkImageMemoryBarrier barrier = {};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+    barrier.dstAccessMask = headless ? VK_ACCESS_TRANSFER_READ_BIT : 0;
+    barrier.oldLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+    barrier.newLayout = headless ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = swapchainData.images[imageIndex];
+    barrier.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+
+    VkPipelineStageFlags dstStage = headless ? VK_PIPELINE_STAGE_TRANSFER_BIT : VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, dstStage, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+}
+
+SceneCommandState VulkanApplication::getSceneCommandState() const
+{
+    SceneCommandState state = {};
+    state.modelPipeline = modelPipeline;
+    state.grassPipeline = grassPipeline;
+    state.width = swapchainData.extents.width;
+    state.height = swapchainData.extents.height;
+    state.minTessellationLevel = sceneSettings.minTessellationLevel;
+    state.maxTessellationLevel = sceneSettings.maxTessellationLevel;
+    state.tessellationDistance = sceneSettings.tessellationDistance;
+    return state;
+}
+
+void VulkanApplication::startSecondaryRecording()
+{
+    CPU_PROFILE_ZONE("startSecondaryRecording");
+
+    // The tasks are given the frame slot rather than reading currentFrame, and are waited on before anything they read changes: the
+    // pipelines are only swapped, and the swapchain only recreated, between frames.
+    uint32_t frame = currentFrame;
+    SceneCommandState state = getSceneCommandState();
+    if (state != recordedSceneStates[frame]) {
+        for (SecondaryPass pass : { SecondaryPass::Terrain, SecondaryPass::Grass }) {
+            secondaryRecordingTasks.push_back(taskPool.submit([this, pass, frame]() { recordSecondaryCommandBuffer(pass, frame); }));
+        }
+        recordedSceneStates[frame] = state;
+        sceneCommandRecordings++;
+    }
+
+    if (!headless) {
+        secondaryRecordingTasks.push_back(taskPool.submit([this, frame]() { recordSecondaryCommandBuffer(SecondaryPass::ImGui, frame); }));
+    }
+}
+
+void VulkanApplication::waitForSecondaryRecording()
+{
+    CPU_PROFILE_ZONE("Wait for secondary recording");
+
+    // Wait for every task before rethrowing, so none is left recording.
+    std::exception_ptr error = nullptr;
+    for (std::future<void>& task : secondaryRecordingTasks) {
+        try {
+            task.get();
+        }
+        catch (...) {
+            error = error ? error : std::current_exception();
+        }
+    }
+    secondaryRecordingTasks.clear();
+
+    if (error) {
+        std::rethrow_exception(error);
+    }
 }
 
-void VulkanApplication::copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size)
+void VulkanApplication::recordSecondaryCommandBuffer(SecondaryPass pass, uint32_t frame)
 {
-    VkCommandBuffer commandBuffer = beginSingleTimeCommands();
-    
-    VkBufferCopy copyRegion = {};
-    copyRegion.srcOffset = 0;
-    copyRegion.dstOffset = 0;
-    copyRegion.size = size;
-    vkCmdCopyBuffer(commandBuffer, srcBuffer, dstBuffer, 1, &copyRegion);
-    
-    endSingleTimeCommands(commandBuffer);
-}
+    CPU_PROFILE_ZONE("recordSecondaryCommandBuffer");
+
+    // waitForFrameSlot has seen this slot's last submit complete, so its secondary command buffers can be reset. No framebuffer is
+    // inherited, the image is acquired while they are recorded and the same commands run against every swapchain image.
+    VkCommandBuffer commandBuffer = secondaryCommandBuffers[static_cast<size_t>(pass)][frame];
+    vkResetCommandBuffer(commandBuffer, 0);
+
+    // With dynamic rendering no render pass is inherited, the attachment formats are instead. vkCmdExecuteCommands inside
+    // vkCmdBeginRendering requires the inherited render pass to be null.
+    VkCommandBufferInheritanceRenderingInfo renderingInheritanceInfo = {};
+    renderingInheritanceInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_RENDERING_INFO;
+    renderingInheritanceInfo.colorAttachmentCount = pipelineRenderingInfo.colorAttachmentCount;
+    renderingInheritanceInfo.pColorAttachmentFormats = pipelineRenderingInfo.pColorAttachmentFormats;
+    renderingInheritanceInfo.depthAttachmentFormat = pipelineRenderingInfo.depthAttachmentFormat;
+    renderingInheritanceInfo.stencilAttachmentFormat = pipelineRenderingInfo.stencilAttachmentFormat;
+    renderingInheritanceInfo.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+
+    VkCommandBufferInheritanceInfo inheritanceInfo = {};
+    inheritanceInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+    inheritanceInfo.pNext = dynamicRendering ? &renderingInheritanceInfo : nullptr;
+    inheritanceInfo.renderPass = dynamicRendering ? VK_NULL_HANDLE : renderPass;
+    inheritanceInfo.subpass = 0;
+    inheritanceInfo.framebuffer = VK_NULL_HANDLE;
 
-void VulkanApplication::recordCommandBuffer(VkCommandBuffer commandBuffer, uint32_t imageIndex)
-{
-    VkCommandBufferBeginInfo beginInfo{};
+    VkCommandBufferBeginInfo beginInfo = {};
     beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+    beginInfo.pInheritanceInfo = &inheritanceInfo;
 
     if (vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS) {
-        throw std::runtime_error("failed to begin recording command buffer!");
+        throw std::runtime_error("failed to begin recording secondary command buffer!");
     }
 
-    std::array<VkClearValue, 2> clearValues = {};
-    clearValues[0] = {};
-    clearValues[0].color = { { 0.05f, 0.3f, 0.9f, 1.0f} };
-    clearValues[1] = {};
-    clearValues[1].depthStencil = { 1.0f, 0 };
-
-    VkRenderPassBeginInfo renderPassInfo = {};
-    renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-    renderPassInfo.renderPass = renderPass;
-    renderPassInfo.framebuffer = swapchainData.framebuffers[imageIndex];
-    renderPassInfo.renderArea.offset = { 0, 0 };
-    renderPassInfo.renderArea.extent = swapchainData.extents;
-    renderPassInfo.clearValueCount = static_cast<uint32_t>(clearValues.size());
-    renderPassInfo.pClearValues = clearValues.data();
+    switch (pass) {
+    case SecondaryPass::Terrain: recordTerrainCommands(commandBuffer, frame); break;
+    case SecondaryPass::Grass: recordGrassCommands(commandBuffer, frame); break;
+    case SecondaryPass::ImGui: recordImGuiCommands(commandBuffer, frame); break;
+    default: break;
+    }
 
-    vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);    
+    if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS) {
+        throw std::runtime_error("failed to record secondary command buffer!");
+    }
+}
 
+void VulkanApplication::recordTerrainCommands(VkCommandBuffer commandBuffer, uint32_t frame)
+{
     //
     // Start model pipeline.
     //
@@ -2034,12 +3841,30 @@ void VulkanApplication::recordCommandBuffer(VkCommandBuffer commandBuffer, uint3
     VkDeviceSize quadOffsets[] = { 0 };                                                         
     vkCmdBindVertexBuffers(commandBuffer, 0, 1, quadVertexBuffers, quadOffsets);                
     vkCmdBindIndexBuffer(commandBuffer, quadIndexBuffer, 0, VK_INDEX_TYPE_UINT16);    
-    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, modelPipelineLayout, 0, 1, &modelPipelineDescriptorSet, 0, nullptr);
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, modelPipelineLayout, 0, 1, &modelPipelineDescriptorSets[frame], 0, nullptr);
+    gpuProfiler.beginScope(commandBuffer, frame, GpuScope::Terrain);
+    gpuProfiler.beginStatistics(commandBuffer, frame, GpuStatisticsScope::Terrain);
     vkCmdDrawIndexed(commandBuffer, quadMesh.indexCount, 1, 0, 0, 0); 
+    gpuProfiler.endStatistics(commandBuffer, frame, GpuStatisticsScope::Terrain);
+    gpuProfiler.endScope(commandBuffer, frame, GpuScope::Terrain);
+}
 
-    //
-    // End model pipeline.
-    //
+void VulkanApplication::recordGrassCommands(VkCommandBuffer commandBuffer, uint32_t frame)
+{
+    // Secondary command buffers inherit no dynamic state, each sets its own.
+    VkViewport viewport = {};
+    viewport.x = 0.0f;
+    viewport.y = 0.0f;
+    viewport.width = static_cast<float>(swapchainData.extents.width);
+    viewport.height = static_cast<float>(swapchainData.extents.height);
+    viewport.minDepth = 0.0f;
+    viewport.maxDepth = 1.0f;
+    vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+
+    VkRect2D scissor = {};
+    scissor.offset = { 0, 0 };
+    scissor.extent = swapchainData.extents;
+    vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
 
     //
     // Start grass pipeline.
@@ -2048,32 +3873,62 @@ void VulkanApplication::recordCommandBuffer(VkCommandBuffer commandBuffer, uint3
     vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, grassPipeline);
 
     VkDeviceSize quadOffsetsGRASS[] = { 0 };
-    vkCmdBindVertexBuffers(commandBuffer, 0, 1, &bladeInstanceDataBuffer[currentFrame], quadOffsetsGRASS);
+    vkCmdBindVertexBuffers(commandBuffer, 0, 1, &visibleBladeInstanceDataBuffers[frame % visibleBladeInstanceDataBuffers.size()], quadOffsetsGRASS);
 
-    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, grassPipelineLayout, 0, 1, &grassPipelineDescriptorSet, 0, nullptr);
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, grassPipelineLayout, 0, 1, &grassPipelineDescriptorSets[frame], 0, nullptr);
 
-    uint32_t numVisibleBlades = retrieveNumVisibleBlades();
+    // The culling pass compacts near blades from the front of the visible buffer and far blades from the back, so each level of detail
+    // is one contiguous range of instances. It writes both draws into this frame's num blades buffer, so the counts never visit the CPU.
+    VkBuffer numBladesBuffer = numBladesBuffers[frame];
+    const VkDeviceSize farDrawOffset = offsetof(NumBladesBufferObject, farVertexCount);
 
-    // The tessellation primitive generator expects to be generating quads, hence the value of 4.
-    vkCmdDraw(commandBuffer, 4, numVisibleBlades, 0, 0);
+    gpuProfiler.beginScope(commandBuffer, frame, GpuScope::Grass);
+    gpuProfiler.beginStatistics(commandBuffer, frame, GpuStatisticsScope::Grass);
 
-    //
-    // End grass pipeline.
-    //
+    if (grassRenderPath == GrassRenderPath::Tessellated) {
+        GrassPushConstantsObject grassPushConstantsObject = {};
+        grassPushConstantsObject.minTessellationLevel = sceneSettings.minTessellationLevel;
+        grassPushConstantsObject.maxTessellationLevel = sceneSettings.maxTessellationLevel;
+        grassPushConstantsObject.tessellationDistance = sceneSettings.tessellationDistance;
+        vkCmdPushConstants(commandBuffer, grassPipelineLayout, VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT, 0, sizeof(GrassPushConstantsObject), &grassPushConstantsObject);
 
-    // Start ImGui rendering.
-    ImGui_ImplVulkan_RenderDrawData(ImGui::GetDrawData(), commandBuffer); 
-    // End ImGui rendering.
+        vkCmdDrawIndirect(commandBuffer, numBladesBuffer, 0, 1, sizeof(VkDrawIndirectCommand));
+        vkCmdDrawIndirect(commandBuffer, numBladesBuffer, farDrawOffset, 1, sizeof(VkDrawIndirectCommand));
+    }
+    else {
+        // One triangle strip per-blade, with fewer strip vertices for the far level of detail.
+        GrassPushConstantsObject grassPushConstantsObject = {};
 
-    vkCmdEndRenderPass(commandBuffer); 
+        grassPushConstantsObject.vertexCount = kStripNearVertexCount;
+        vkCmdPushConstants(commandBuffer, grassPipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(GrassPushConstantsObject), &grassPushConstantsObject);
+        vkCmdDrawIndirect(commandBuffer, numBladesBuffer, 0, 1, sizeof(VkDrawIndirectCommand));
 
-    if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS) {
-        throw std::runtime_error("failed to record command buffer!");
+        grassPushConstantsObject.vertexCount = kStripFarVertexCount;
+        vkCmdPushConstants(commandBuffer, grassPipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(GrassPushConstantsObject), &grassPushConstantsObject);
+        vkCmdDrawIndirect(commandBuffer, numBladesBuffer, farDrawOffset, 1, sizeof(VkDrawIndirectCommand));
     }
+
+    gpuProfiler.endStatistics(commandBuffer, frame, GpuStatisticsScope::Grass);
+    gpuProfiler.endScope(commandBuffer, frame, GpuScope::Grass);
+
+    //
+    // End grass pipeline.
+    //
+}
+
+void VulkanApplication::recordImGuiCommands(VkCommandBuffer commandBuffer, uint32_t frame)
+{
+    // The draw data was finalised by ImGui::Render on the main thread before render, which does not touch ImGui until this task is waited
+    // on. The backend only records commands and fills its vertex buffers here, its font upload is submitted from ImGui_ImplVulkan_NewFrame.
+    gpuProfiler.beginScope(commandBuffer, frame, GpuScope::ImGui);
+    ImGui_ImplVulkan_RenderDrawData(ImGui::GetDrawData(), commandBuffer);
+    gpuProfiler.endScope(commandBuffer, frame, GpuScope::ImGui);
 }
 
 void VulkanApplication::recordComputeCommandBuffer(VkCommandBuffer commandBuffer)
 {
+    CPU_PROFILE_ZONE("recordComputeCommandBuffer");
+
     VkCommandBufferBeginInfo beginInfo = {};
     beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
 
@@ -2081,19 +3936,123 @@ void VulkanApplication::recordComputeCommandBuffer(VkCommandBuffer commandBuffer
         throw std::runtime_error("failed to begin recording compute command buffer!");
     }
 
-    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, computePipeline);
+    // Resolves this frame slot's timestamps from framesInFlight frames ago and resets the compute scopes', the compute pass is recorded first each frame.
+    gpuProfiler.beginFrame(commandBuffer, currentFrame);
+
+    // Reset the draws and visible blade counters before culling, every work group increments them so this cannot be done from inside the
+    // shader. The tessellation primitive generator expects to be generating quads, hence the vertex count of 4.
+    NumBladesBufferObject resetCounts = {};
+    resetCounts.nearVertexCount = (grassRenderPath == GrassRenderPath::Tessellated) ? 4 : kStripNearVertexCount;
+    resetCounts.farVertexCount = (grassRenderPath == GrassRenderPath::Tessellated) ? 4 : kStripFarVertexCount;
+    resetCounts.farFirstInstance = sceneSettings.numBlades;
+    VkBuffer numBladesBuffer = numBladesBuffers[currentFrame];
+    vkCmdUpdateBuffer(commandBuffer, numBladesBuffer, 0, sizeof(NumBladesBufferObject), &resetCounts);
+
+    VkBufferMemoryBarrier resetBarrier = {};
+    resetBarrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+    resetBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    resetBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+    resetBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    resetBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    resetBarrier.buffer = numBladesBuffer;
+    resetBarrier.offset = 0;
+    resetBarrier.size = VK_WHOLE_SIZE;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, nullptr, 1, &resetBarrier, 0, nullptr);
+
+    // The previous frame's simulation wrote the state this frame reads, and was submitted to this queue earlier, so a single global barrier
+    // orders them. On a shared queue the previous frame's draw also read the visible buffer this frame overwrites. With async compute that
+    // draw is on the graphics queue, each frame in flight culls into its own visible buffer instead, and waitForFrameSlot has seen the last
+    // draw that read it complete. The grass vertex shaders read the visible buffer as a storage buffer, not as vertex input, and the
+    // tessellation stages do not read it.
+    VkPipelineStageFlags simulationSrcStages = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+    if (!asyncCompute) {
+        simulationSrcStages |= VK_PIPELINE_STAGE_VERTEX_SHADER_BIT;
+    }
+
+    VkMemoryBarrier simulationBarrier = {};
+    simulationBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    simulationBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    simulationBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+    vkCmdPipelineBarrier(commandBuffer, simulationSrcStages, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &simulationBarrier, 0, nullptr, 0, nullptr);
+
+    // Wind field pass, once per-frame for the whole field rather than evaluating noise once per-blade.
+    GrassComputeVariant variant = getComputeVariant();
+    if (variant.windField) {
+        VkImageMemoryBarrier windFieldBarrier = {};
+        windFieldBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        windFieldBarrier.oldLayout = VK_IMAGE_LAYOUT_GENERAL;
+        windFieldBarrier.newLayout = VK_IMAGE_LAYOUT_GENERAL;
+        windFieldBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        windFieldBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        windFieldBarrier.image = windFieldImage;
+        windFieldBarrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        windFieldBarrier.subresourceRange.baseMipLevel = 0;
+        windFieldBarrier.subresourceRange.levelCount = 1;
+        windFieldBarrier.subresourceRange.baseArrayLayer = 0;
+        windFieldBarrier.subresourceRange.layerCount = 1;
+
+        // The previous frame's culling pass must have finished reading the field before it is overwritten.
+        windFieldBarrier.srcAccessMask = VK_ACCESS_SHADER_READ_BIT;
+        windFieldBarrier.dstAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &windFieldBarrier);
+
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, windFieldPipeline);
+
+        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, windFieldPipelineLayout, 0, 1, &windFieldPipelineDescriptorSet, 0, nullptr);
+
+        WindPushConstantsObject windPushConstantsObject = {};
+        windPushConstantsObject.direction = glm::vec2(cos(glm::radians(windParameters.directionDegrees)), sin(glm::radians(windParameters.directionDegrees)));
+        windPushConstantsObject.strength = windParameters.strength;
+        windPushConstantsObject.gustStrength = windParameters.gustStrength;
+        windPushConstantsObject.gustFrequency = windParameters.gustFrequency;
+        windPushConstantsObject.elapsed = getElapsedTime();
+
+        vkCmdPushConstants(commandBuffer, windFieldPipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(WindPushConstantsObject), &windPushConstantsObject);
+
+        // One invocation per-texel, with 16x16 invocations per work group.
+        gpuProfiler.beginScope(commandBuffer, currentFrame, GpuScope::WindField);
+        vkCmdDispatch(commandBuffer, kWindFieldResolution / 16u, kWindFieldResolution / 16u, 1);
+        gpuProfiler.endScope(commandBuffer, currentFrame, GpuScope::WindField);
+
+        // The culling pass samples the field, so the writes must be visible before it starts.
+        windFieldBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+        windFieldBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &windFieldBarrier);
+    }
+
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, getComputePipeline(variant));
 
-    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, computePipelineLayout, 0, 1, &grassPipelineDescriptorSet, 0, nullptr);
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, computePipelineLayout, 0, 1, &grassPipelineDescriptorSets[currentFrame], 0, nullptr);
 
     PushConstantsObject pushConstantsObject = {};
-    pushConstantsObject.totalNumBlades = kMaxBlades;
-    pushConstantsObject.elapsed = glfwGetTime();
+    pushConstantsObject.totalNumBlades = sceneSettings.numBlades;
+    pushConstantsObject.elapsed = getElapsedTime();
+    pushConstantsObject.lodDistance = kGrassLodDistance;
+    pushConstantsObject.cameraPosition = glm::vec4(camera->position, 1.0f);
+    pushConstantsObject.windFieldWorldSize = kWindFieldWorldSize;
+
+    // Clamp the step so a hitch (window drag, breakpoint) cannot launch the blades.
+    simulationParameters.deltaTime = glm::min(deltaTime, kGrassMaxSimulationStep);
+    pushConstantsObject.deltaTime = simulationParameters.deltaTime;
+    pushConstantsObject.gravity = simulationParameters.gravity;
+    pushConstantsObject.windForce = simulationParameters.windForce;
+    pushConstantsObject.trampleRecoveryTime = simulationParameters.trampleRecoveryTime;
+    pushConstantsObject.simulationDistance = simulationParameters.simulationDistance;
+    pushConstantsObject.swayDistance = simulationParameters.swayDistance;
+    simulationParameters.cameraPosition = glm::vec2(camera->position.x, camera->position.y);
+
+    lastSimulationParameters = simulationParameters;
+    lastSimulatedFrame = static_cast<int>(currentFrame);
 
     vkCmdPushConstants(commandBuffer, computePipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(PushConstantsObject), &pushConstantsObject);
 
     // This should run ONCE PER-BLADE. Dividing the work-group by 32 to match the ideal size of a warp on most hardware, then working with
     // 32 threads per-thread group on the local size in the shader. These values are multiplied so it makes the MAX count anyway.
-    vkCmdDispatch(commandBuffer, ((kMaxBlades - 1) / 32u) + 1, 1, 1); // Currently only a 1 dimensional array of thread groups and work groups.
+    gpuProfiler.beginScope(commandBuffer, currentFrame, GpuScope::Culling);
+    gpuProfiler.beginStatistics(commandBuffer, currentFrame, GpuStatisticsScope::Culling);
+    vkCmdDispatch(commandBuffer, ((sceneSettings.numBlades - 1) / variant.workgroupSize) + 1, 1, 1); // Currently only a 1 dimensional array of thread groups and work groups.
+    gpuProfiler.endStatistics(commandBuffer, currentFrame, GpuStatisticsScope::Culling);
+    gpuProfiler.endScope(commandBuffer, currentFrame, GpuScope::Culling);
 
     if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS) {
         throw std::runtime_error("failed to end recording compute command buffer!");
@@ -2103,47 +4062,74 @@ void VulkanApplication::recordComputeCommandBuffer(VkCommandBuffer commandBuffer
 void VulkanApplication::cleanupApplication(GLFWwindow* window)
 {
     // Synchronisation Objects. 
-    for (size_t i = 0; i < kMaxFramesInFlight; ++i) {
-        vkDestroyFence(m_LogicalDevice, computeInFlightFences[i], nullptr);
-        vkDestroySemaphore(m_LogicalDevice, computeFinishedSemaphores[i], nullptr);
-
-        vkDestroyFence(m_LogicalDevice, inFlightFences[i], nullptr);
+    vkDestroySemaphore(m_LogicalDevice, computeTimeline, nullptr);
+    vkDestroySemaphore(m_LogicalDevice, graphicsTimeline, nullptr);
+    for (size_t i = 0; i < framesInFlight; ++i) {
         vkDestroySemaphore(m_LogicalDevice, renderFinishedSemaphores[i], nullptr);
         vkDestroySemaphore(m_LogicalDevice, imageAvailableSemaphores[i], nullptr);
     }
 
+    // Timestamp query pools.
+    gpuProfiler.destroy();
+
     // Command Buffer - uses command pool, so destroy pool later.
-    vkFreeCommandBuffers(m_LogicalDevice, commandPool, static_cast<uint32_t>(computeCommandBuffers.size()), computeCommandBuffers.data());
+    vkFreeCommandBuffers(m_LogicalDevice, computeCommandPool, static_cast<uint32_t>(computeCommandBuffers.size()), computeCommandBuffers.data());
     vkFreeCommandBuffers(m_LogicalDevice, commandPool, static_cast<uint32_t>(commandBuffers.size()), commandBuffers.data());
+    for (size_t pass = 0; pass < secondaryCommandBuffers.size(); ++pass) {
+        vkFreeCommandBuffers(m_LogicalDevice, secondaryCommandPools[pass], static_cast<uint32_t>(secondaryCommandBuffers[pass].size()), secondaryCommandBuffers[pass].data());
+    }
 
     // Blade instance staging buffer.
-    for (size_t i = 0; i < kMaxFramesInFlight; ++i) {
+    for (size_t i = 0; i < framesInFlight; ++i) {
         vkDestroyBuffer(m_LogicalDevice, bladeInstanceStagingBuffer[i], nullptr);
         vkFreeMemory(m_LogicalDevice, bladeInstanceStagingBufferMemory[i], nullptr);
     }
 
     // Descriptor Sets - uses descriptor pool, so destroy pool later.
-    std::array<VkDescriptorSet, 2> descriptorSets = { grassPipelineDescriptorSet, modelPipelineDescriptorSet }; 
+    std::vector<VkDescriptorSet> descriptorSets = { windFieldPipelineDescriptorSet }; 
+    descriptorSets.insert(descriptorSets.end(), modelPipelineDescriptorSets.begin(), modelPipelineDescriptorSets.end());
+    descriptorSets.insert(descriptorSets.end(), grassPipelineDescriptorSets.begin(), grassPipelineDescriptorSets.end());
     vkFreeDescriptorSets(m_LogicalDevice, descriptorPool, static_cast<uint32_t>(descriptorSets.size()), descriptorSets.data());
 
-    // Num blades buffer.
-    vkDestroyBuffer(m_LogicalDevice, numBladesBuffer, nullptr);
-    vkFreeMemory(m_LogicalDevice, numBladesBufferMemory, nullptr);
+    // Num blades buffers.
+    for (size_t i = 0; i < framesInFlight; ++i) {
+        vkUnmapMemory(m_LogicalDevice, numBladesBufferMemory[i]);
+        vkDestroyBuffer(m_LogicalDevice, numBladesBuffers[i], nullptr);
+        vkFreeMemory(m_LogicalDevice, numBladesBufferMemory[i], nullptr);
+    }
 
     // Descriptor Pool.
     vkDestroyDescriptorPool(m_LogicalDevice, imguiDescriptorPool, nullptr);
     vkDestroyDescriptorPool(m_LogicalDevice, descriptorPool, nullptr); 
 
-    // Uniform Buffer Object.
-    vkDestroyBuffer(m_LogicalDevice, uniformBuffer, nullptr);
-    vkFreeMemory(m_LogicalDevice, uniformBufferMemory, nullptr);
+    // Uniform Buffer Objects.
+    for (size_t i = 0; i < framesInFlight; ++i) {
+        vkUnmapMemory(m_LogicalDevice, uniformBufferMemory[i]);
+        vkDestroyBuffer(m_LogicalDevice, uniformBuffers[i], nullptr);
+        vkFreeMemory(m_LogicalDevice, uniformBufferMemory[i], nullptr);
+    }
 
     // Shader Storage Buffer Object.
-    for (size_t i = 0; i < kMaxFramesInFlight; ++i) {
+    for (size_t i = 0; i < framesInFlight; ++i) {
         vkDestroyBuffer(m_LogicalDevice, bladeInstanceDataBuffer[i], nullptr);
         vkFreeMemory(m_LogicalDevice, bladeInstanceDataBufferMemory[i], nullptr);
     }
 
+    for (size_t i = 0; i < visibleBladeInstanceDataBuffers.size(); ++i) {
+        vkDestroyBuffer(m_LogicalDevice, visibleBladeInstanceDataBuffers[i], nullptr);
+        vkFreeMemory(m_LogicalDevice, visibleBladeInstanceDataBufferMemory[i], nullptr);
+    }
+
+    // Trample and collider buffers.
+    for (size_t i = 0; i < framesInFlight; ++i) {
+        vkDestroyBuffer(m_LogicalDevice, trampleBuffer[i], nullptr);
+        vkFreeMemory(m_LogicalDevice, trampleBufferMemory[i], nullptr);
+
+        vkUnmapMemory(m_LogicalDevice, colliderBufferMemory[i]);
+        vkDestroyBuffer(m_LogicalDevice, colliderBuffer[i], nullptr);
+        vkFreeMemory(m_LogicalDevice, colliderBufferMemory[i], nullptr);
+    }
+
     // Index Buffers.
     vkDestroyBuffer(m_LogicalDevice, bladeShapeIndexBuffer, nullptr);
     vkFreeMemory(m_LogicalDevice, bladeShapeIndexBufferMemory, nullptr);
@@ -2157,6 +4143,9 @@ void VulkanApplication::cleanupApplication(GLFWwindow* window)
     vkFreeMemory(m_LogicalDevice, quadVertexBufferMemory, nullptr);
 
     // Texture resources.
+    vkDestroyImageView(m_LogicalDevice, windFieldImageView, nullptr);
+    vkDestroyImage(m_LogicalDevice, windFieldImage, nullptr);
+    vkFreeMemory(m_LogicalDevice, windFieldImageMemory, nullptr);
     vkDestroySampler(m_LogicalDevice, heightMapSampler, nullptr);
     vkDestroyImageView(m_LogicalDevice, heightMapImageView, nullptr);
     vkDestroyImage(m_LogicalDevice, heightMapImage, nullptr);
@@ -2164,6 +4153,10 @@ void VulkanApplication::cleanupApplication(GLFWwindow* window)
 
     // Command Pool.
     vkDestroyCommandPool(m_LogicalDevice, commandPool, nullptr);
+    vkDestroyCommandPool(m_LogicalDevice, computeCommandPool, nullptr);
+    for (VkCommandPool secondaryCommandPool : secondaryCommandPools) {
+        vkDestroyCommandPool(m_LogicalDevice, secondaryCommandPool, nullptr);
+    }
 
     for (size_t i = 0; i < swapchainData.framebuffers.size(); i++) {
         vkDestroyFramebuffer(m_LogicalDevice, swapchainData.framebuffers[i], nullptr);
@@ -2174,15 +4167,39 @@ void VulkanApplication::cleanupApplication(GLFWwindow* window)
     vkDestroyImage(m_LogicalDevice, depthImage, nullptr);
     vkFreeMemory(m_LogicalDevice, depthImageMemory, nullptr);
     
+    // Shader hot reload, a reload still in flight is finished and its pipelines discarded.
+    shaderWatcher.stop();
+    if (shaderReloadTask.valid()) {
+        try {
+            for (const ReloadedPipeline& pipeline : shaderReloadTask.get()) {
+                vkDestroyPipeline(m_LogicalDevice, pipeline.handle, nullptr);
+            }
+        }
+        catch (const std::exception&) {
+            // Nothing was built.
+        }
+    }
+    for (const RetiredPipeline& retired : retiredPipelines) {
+        vkDestroyPipeline(m_LogicalDevice, retired.handle, nullptr);
+    }
+    retiredPipelines.clear();
+
     // Pipelines.
+    savePipelineCache();
+    vkDestroyPipelineCache(m_LogicalDevice, pipelineCache, nullptr);
     vkDestroyPipelineLayout(m_LogicalDevice, grassPipelineLayout, nullptr);
     vkDestroyPipelineLayout(m_LogicalDevice, computePipelineLayout, nullptr);
+    vkDestroyPipelineLayout(m_LogicalDevice, windFieldPipelineLayout, nullptr);
     vkDestroyPipelineLayout(m_LogicalDevice, modelPipelineLayout, nullptr);
     vkDestroyPipeline(m_LogicalDevice, grassPipeline, nullptr);
-    vkDestroyPipeline(m_LogicalDevice, computePipeline, nullptr);
+    for (const auto& [variant, pipeline] : computePipelineVariants) {
+        vkDestroyPipeline(m_LogicalDevice, pipeline, nullptr);
+    }
+    vkDestroyPipeline(m_LogicalDevice, windFieldPipeline, nullptr);
     vkDestroyPipeline(m_LogicalDevice, modelPipeline, nullptr);
 
     // Descriptor Set Layouts.
+    vkDestroyDescriptorSetLayout(m_LogicalDevice, windFieldDescriptorSetLayout, nullptr);
     vkDestroyDescriptorSetLayout(m_LogicalDevice, grassDescriptorSetLayout, nullptr);
     vkDestroyDescriptorSetLayout(m_LogicalDevice, modelDescriptorSetLayout, nullptr);
 
@@ -2194,8 +4211,16 @@ void VulkanApplication::cleanupApplication(GLFWwindow* window)
         vkDestroyImageView(m_LogicalDevice, swapchainData.imageViews[i], nullptr);
     }
 
-    // Swapchain.
+    // Swapchain, or the offscreen images standing in for it.
     vkDestroySwapchainKHR(m_LogicalDevice, swapchainData.handle, nullptr);
+    for (RetiredSwapchain& retired : retiredSwapchains) {
+        retired.destroy(m_LogicalDevice);
+    }
+    retiredSwapchains.clear();
+    for (size_t i = 0; i < offscreenImageMemory.size(); i++) {
+        vkDestroyImage(m_LogicalDevice, swapchainData.images[i], nullptr);
+        vkFreeMemory(m_LogicalDevice, offscreenImageMemory[i], nullptr);
+    }
 
     // Logical Device.
     vkDestroyDevice(m_LogicalDevice, nullptr);
@@ -2212,8 +4237,10 @@ void VulkanApplication::cleanupApplication(GLFWwindow* window)
     vkDestroyInstance(m_VkInstance, nullptr);
 
     // Window.
-    glfwDestroyWindow(window);
-    glfwTerminate();
+    if (window != nullptr) {
+        glfwDestroyWindow(window);
+        glfwTerminate();
+    }
 }
 
 VkSurfaceFormatKHR VulkanApplication::chooseSwapchainSurfaceFormat(const std::vector<VkSurfaceFormatKHR>& availableFormats)
@@ -2228,12 +4255,19 @@ VkSurfaceFormatKHR VulkanApplication::chooseSwapchainSurfaceFormat(const std::ve
 
 VkPresentModeKHR VulkanApplication::chooseSwapPresentMode(const std::vector<VkPresentModeKHR>& availablePresentModes)
 {
-    for (const auto& availablePresentMode : availablePresentModes) {
-        if (availablePresentMode == VK_PRESENT_MODE_MAILBOX_KHR) {
-            return availablePresentMode;
-        }
+    auto isAvailable = [&availablePresentModes](VkPresentModeKHR presentMode) {
+        return std::find(availablePresentModes.begin(), availablePresentModes.end(), presentMode) != availablePresentModes.end();
+    };
+
+    if (isAvailable(requestedPresentMode)) {
+        return requestedPresentMode;
     }
 
+    // IMMEDIATE falls back to the other mode that does not wait for vertical blank. Anything else falls back to FIFO, which every device
+    // supports and which never tears.
+    if (requestedPresentMode == VK_PRESENT_MODE_IMMEDIATE_KHR && isAvailable(VK_PRESENT_MODE_MAILBOX_KHR)) {
+        return VK_PRESENT_MODE_MAILBOX_KHR;
+    }
     return VK_PRESENT_MODE_FIFO_KHR;
 }
 
@@ -2258,19 +4292,136 @@ VkExtent2D VulkanApplication::chooseSwapExtent(GLFWwindow* window, const VkSurfa
     }
 }
 
-uint32_t VulkanApplication::retrieveNumVisibleBlades()
+NumBladesBufferObject VulkanApplication::retrieveNumVisibleBlades()
+{
+    CPU_PROFILE_ZONE("retrieveNumVisibleBlades");
+
+    // render() has waited for this slot's last frame, so the counts are complete without waiting on the device.
+    NumBladesBufferObject numVisible = *static_cast<const NumBladesBufferObject*>(numBladesBufferMapped[currentFrame]);
+    driverData.numVisible = numVisible.numVisible;
+    driverData.numSimulated = numVisible.numSimulated;
+    driverData.numSwaying = numVisible.numSwaying;
+    driverData.numStatic = numVisible.numStatic;
+
+    return numVisible;
+}
+
+void VulkanApplication::validateBladeSimulation()
 {
+    // Nothing to compare until the compute pass has simulated at least once.
+    if (lastSimulatedFrame < 0 || sceneSettings.numBlades == 0) {
+        return;
+    }
+
     vkDeviceWaitIdle(m_LogicalDevice);
 
+    // The newest state was written into the last simulated frame's buffer from the state in the buffer before it.
+    VkBuffer lastStateBuffer = bladeInstanceDataBuffer[(lastSimulatedFrame + framesInFlight - 1) % framesInFlight];
+    VkBuffer currentStateBuffer = bladeInstanceDataBuffer[lastSimulatedFrame];
+    VkBuffer lastTrampleBuffer = trampleBuffer[(lastSimulatedFrame + framesInFlight - 1) % framesInFlight];
+    VkBuffer currentTrampleBuffer = trampleBuffer[lastSimulatedFrame];
+
+    // Fewer blades than samples are all checked, rather than a stride of 0 reading the first blade every time.
+    const uint32_t sampleCount = std::min(kSimulationValidationSamples, sceneSettings.numBlades);
+    const uint32_t sampleStride = std::max(1u, sceneSettings.numBlades / sampleCount);
+    const VkDeviceSize bladeSize = sizeof(GrassBladeInstanceData);
+    const VkDeviceSize statesSize = bladeSize * sampleCount;
+    const VkDeviceSize trampleSize = sizeof(float) * sampleCount;
+    const VkDeviceSize windFieldSize = sizeof(uint16_t) * 4 * kWindFieldResolution * kWindFieldResolution; // R16G16B16A16_SFLOAT.
+
+    // Layout of the readback buffer: sampled last states, sampled current states, sampled last and current trample, then the whole wind field.
+    VkBuffer readbackBuffer = VK_NULL_HANDLE;
+    VkDeviceMemory readbackBufferMemory = VK_NULL_HANDLE;
+
+    BufferCreateInfo readbackBufferInfo = {};
+    readbackBufferInfo.size = statesSize * 2 + trampleSize * 2 + windFieldSize;
+    readbackBufferInfo.usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+    readbackBufferInfo.memProperties = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+    readbackBufferInfo.pBuffer = &readbackBuffer;
+    readbackBufferInfo.pBufferMemory = &readbackBufferMemory;
+
+    if (createBuffer(readbackBufferInfo) != VK_SUCCESS) {
+        throw std::runtime_error("bad buffer creation.");
+    }
+
+    std::vector<VkBufferCopy> lastStateRegions(sampleCount);
+    std::vector<VkBufferCopy> currentStateRegions(sampleCount);
+    std::vector<VkBufferCopy> lastTrampleRegions(sampleCount);
+    std::vector<VkBufferCopy> currentTrampleRegions(sampleCount);
+    for (uint32_t i = 0; i < sampleCount; ++i) {
+        lastStateRegions[i].srcOffset = bladeSize * i * sampleStride;
+        lastStateRegions[i].dstOffset = bladeSize * i;
+        lastStateRegions[i].size = bladeSize;
+
+        currentStateRegions[i] = lastStateRegions[i];
+        currentStateRegions[i].dstOffset += statesSize;
+
+        lastTrampleRegions[i].srcOffset = sizeof(float) * i * sampleStride;
+        lastTrampleRegions[i].dstOffset = statesSize * 2 + sizeof(float) * i;
+        lastTrampleRegions[i].size = sizeof(float);
+
+        currentTrampleRegions[i] = lastTrampleRegions[i];
+        currentTrampleRegions[i].dstOffset += trampleSize;
+    }
+
+    VkBufferImageCopy windFieldRegion = {};
+    windFieldRegion.bufferOffset = statesSize * 2 + trampleSize * 2;
+    windFieldRegion.bufferRowLength = 0;
+    windFieldRegion.bufferImageHeight = 0;
+    windFieldRegion.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    windFieldRegion.imageSubresource.mipLevel = 0;
+    windFieldRegion.imageSubresource.baseArrayLayer = 0;
+    windFieldRegion.imageSubresource.layerCount = 1;
+    windFieldRegion.imageOffset = { 0, 0, 0 };
+    windFieldRegion.imageExtent = { kWindFieldResolution, kWindFieldResolution, 1 };
+
+    VkCommandBuffer commandBuffer = beginSingleTimeCommands();
+
+    vkCmdCopyBuffer(commandBuffer, lastStateBuffer, readbackBuffer, sampleCount, lastStateRegions.data());
+    vkCmdCopyBuffer(commandBuffer, currentStateBuffer, readbackBuffer, sampleCount, currentStateRegions.data());
+    vkCmdCopyBuffer(commandBuffer, lastTrampleBuffer, readbackBuffer, sampleCount, lastTrampleRegions.data());
+    vkCmdCopyBuffer(commandBuffer, currentTrampleBuffer, readbackBuffer, sampleCount, currentTrampleRegions.data());
+    vkCmdCopyImageToBuffer(commandBuffer, windFieldImage, VK_IMAGE_LAYOUT_GENERAL, readbackBuffer, 1, &windFieldRegion);
+
+    endSingleTimeCommands(commandBuffer);
+
     void* data;
-    vkMapMemory(m_LogicalDevice, numBladesBufferMemory, 0, sizeof(NumBladesBufferObject), 0, &data);
+    vkMapMemory(m_LogicalDevice, readbackBufferMemory, 0, readbackBufferInfo.size, 0, &data);
 
-    uint32_t numVisible = *static_cast<uint32_t*>(data);
-    driverData.numVisible = numVisible;
+    const GrassBladeInstanceData* states = static_cast<const GrassBladeInstanceData*>(data);
+    std::vector<GrassBladeInstanceData> lastStates(states, states + sampleCount);
+    std::vector<GrassBladeInstanceData> gpuStates(states + sampleCount, states + sampleCount * 2);
 
-    vkUnmapMemory(m_LogicalDevice, numBladesBufferMemory);
+    const float* trample = reinterpret_cast<const float*>(static_cast<const char*>(data) + statesSize * 2);
+    std::vector<float> lastTrample(trample, trample + sampleCount);
+    std::vector<float> gpuTrample(trample + sampleCount, trample + sampleCount * 2);
 
-    return numVisible;
+    // Only the first two (wind) channels of each half float texel are used.
+    const uint16_t* texels = reinterpret_cast<const uint16_t*>(static_cast<const char*>(data) + statesSize * 2 + trampleSize * 2);
+    std::vector<glm::vec2> windField(kWindFieldResolution * kWindFieldResolution);
+    for (size_t i = 0; i < windField.size(); ++i) {
+        windField[i] = glm::vec2(glm::unpackHalf1x16(texels[i * 4 + 0]), glm::unpackHalf1x16(texels[i * 4 + 1]));
+    }
+
+    vkUnmapMemory(m_LogicalDevice, readbackBufferMemory);
+
+    vkDestroyBuffer(m_LogicalDevice, readbackBuffer, nullptr);
+    vkFreeMemory(m_LogicalDevice, readbackBufferMemory, nullptr);
+
+    // Sample the field at each blade's root, as the culling pass does.
+    std::vector<glm::vec2> windSamples(sampleCount);
+    for (uint32_t i = 0; i < sampleCount; ++i) {
+        glm::vec2 uv = glm::vec2(lastStates[i].p0_width.x, lastStates[i].p0_width.y) / kWindFieldWorldSize;
+        windSamples[i] = BladeSimulation::sampleWindField(windField, kWindFieldResolution, uv);
+    }
+
+    // The collider buffer of the simulated frame is not rewritten until that frame slot comes round again.
+    const ColliderBufferObject* colliderGrid = static_cast<const ColliderBufferObject*>(colliderBufferMapped[lastSimulatedFrame]);
+    std::vector<glm::vec4> simulatedColliders(colliderGrid->colliders, colliderGrid->colliders + colliderGrid->numColliders);
+
+    simulationValidation = BladeSimulation::validate(lastStates, gpuStates, lastTrample, gpuTrample, windSamples, simulatedColliders, 
+        lastSimulationParameters, kSimulationValidationTolerance);
+    hasSimulationValidation = true;
 }
 
 void VulkanApplication::linkWindowToVulkan(GLFWwindow* window)
@@ -2286,6 +4437,173 @@ void VulkanApplication::linkCameraToVulkan(Camera* camera)
     this->camera = camera;
 }
 
+void VulkanApplication::enableHeadless(uint32_t width, uint32_t height)
+{
+    headless = true;
+    headlessExtent = { width, height };
+}
+
+void VulkanApplication::setLoadPipelineCache(bool load)
+{
+    loadPipelineCache = load;
+}
+
+void VulkanApplication::setFramesInFlight(uint32_t count)
+{
+    if (count == 0 || count > kMaxFramesInFlight) {
+        throw std::runtime_error("frames in flight must be between 1 and " + std::to_string(kMaxFramesInFlight) + ".");
+    }
+    framesInFlight = count;
+}
+
+void VulkanApplication::setAsyncCompute(bool enable)
+{
+    asyncCompute = enable;
+}
+
+void VulkanApplication::setDynamicRendering(bool enable)
+{
+    dynamicRendering = enable;
+}
+
+void VulkanApplication::setPresentMode(VkPresentModeKHR mode)
+{
+    requestedPresentMode = mode;
+
+    // Once running, recreate the swapchain after the next present as a resize does.
+    if (swapchainData.handle != VK_NULL_HANDLE) {
+        framebufferResized = true;
+    }
+}
+
+void VulkanApplication::setSwapchainImageCount(uint32_t count)
+{
+    requestedImageCount = count;
+
+    if (swapchainData.handle != VK_NULL_HANDLE) {
+        framebufferResized = true;
+    }
+}
+
+void VulkanApplication::setFrameLimit(float fps)
+{
+    if (fps < 0.0f) {
+        throw std::runtime_error("frame limit must not be negative.");
+    }
+    frameLimit = fps;
+}
+
+void VulkanApplication::setInputTimestamp(uint64_t ns)
+{
+    inputTimestampNs = ns;
+}
+
+void VulkanApplication::setBladeCapacity(uint32_t capacity)
+{
+    if (capacity == 0) {
+        throw std::runtime_error("blade capacity must be non-zero.");
+    }
+    bladeCapacity = capacity;
+}
+
+void VulkanApplication::applySceneSettings(const SceneSettings& settings)
+{
+    CPU_PROFILE_ZONE("applySceneSettings");
+
+    uint32_t numBlades = (settings.numBlades == 0) ? bladeCapacity : settings.numBlades;
+    if (numBlades > bladeCapacity) {
+        throw std::runtime_error("blade count exceeds the blade capacity.");
+    }
+
+    // Tessellation is a push constant, and culling, the wind field, and the workgroup size select a compute pipeline variant, so they take
+    // effect on the next frame. Only a new blade count needs the scene rebuilt.
+    bool repopulate = (numBlades != sceneSettings.numBlades);
+    sceneSettings = settings;
+    sceneSettings.numBlades = numBlades;
+    if (!repopulate) {
+        return;
+    }
+
+    // The blade state buffers are read and written by the frames in flight.
+    vkDeviceWaitIdle(m_LogicalDevice);
+
+    populateBladeInstanceBuffer();
+    uploadBladeInstances();
+
+    // Every blade starts upright again, and the simulation restarts from the uploaded state.
+    VkCommandBuffer commandBuffer = beginSingleTimeCommands();
+    for (size_t i = 0; i < framesInFlight; ++i) {
+        vkCmdFillBuffer(commandBuffer, trampleBuffer[i], 0, VK_WHOLE_SIZE, 0);
+    }
+    endSingleTimeCommands(commandBuffer);
+
+    lastSimulatedFrame = -1;
+    hasSimulationValidation = false;
+}
+
+double VulkanApplication::getElapsedTime() const
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+}
+
+FrameStatsMetadata VulkanApplication::getFrameStatsMetadata() const
+{
+    FrameStatsMetadata metadata = {};
+
+#if defined(NDEBUG)
+    metadata.build = "Release";
+#else
+    metadata.build = "Debug";
+#endif
+#if defined(_MSC_VER)
+    metadata.build += " MSVC " + std::to_string(_MSC_VER);
+#elif defined(__clang__)
+    metadata.build += " Clang " + std::to_string(__clang_major__) + "." + std::to_string(__clang_minor__);
+#elif defined(__GNUC__)
+    metadata.build += " GCC " + std::to_string(__GNUC__) + "." + std::to_string(__GNUC_MINOR__);
+#endif
+    metadata.build += std::string(" ") + __DATE__ + " " + __TIME__;
+
+    metadata.device = driverData.name;
+    metadata.device += (grassRenderPath == GrassRenderPath::Tessellated) ? " (tessellated)" : " (instanced strip)";
+    metadata.numBlades = sceneSettings.numBlades;
+    metadata.frustumCulling = sceneSettings.frustumCulling;
+    metadata.maxTessellationLevel = (grassRenderPath == GrassRenderPath::Tessellated) ? sceneSettings.maxTessellationLevel : 0.0f;
+    metadata.computeWorkgroupSize = sceneSettings.computeWorkgroupSize;
+    metadata.windField = sceneSettings.windField;
+    metadata.width = swapchainData.extents.width;
+    metadata.height = swapchainData.extents.height;
+    metadata.framesInFlight = framesInFlight;
+    metadata.asyncCompute = asyncCompute;
+    metadata.dynamicRendering = dynamicRendering;
+
+    metadata.presentMode = headless ? "HEADLESS" : getPresentModeName(swapchainData.presentMode); // Nothing is presented when headless.
+    metadata.swapchainImages = static_cast<uint32_t>(swapchainData.images.size());
+    metadata.fpsLimit = frameLimit;
+
+    return metadata;
+}
+
+FrameStatsSample VulkanApplication::getFrameStatsSample(double cpuMs) const
+{
+    FrameStatsSample sample = {};
+    sample.cpuMs = cpuMs;
+
+    const std::array<GpuScopeTimestamps, static_cast<size_t>(GpuScope::Count)>& timestamps = gpuProfiler.getLastTimestamps();
+    for (size_t i = 0; i < timestamps.size(); ++i) {
+        sample.gpuMs[i] = timestamps[i].valid ? static_cast<float>((timestamps[i].endNs - timestamps[i].beginNs) * 1e-6) : 0.0f;
+    }
+    sample.gpuComputeOverlapMs = gpuProfiler.getComputeOverlapStatistics().last;
+    sample.inputToPresentMs = lastInputToPresentMs;
+
+    sample.numVisible = driverData.numVisible;
+    sample.cameraPosition = camera->position;
+    sample.cameraPitch = camera->pitch;
+    sample.cameraYaw = camera->yaw;
+
+    return sample;
+}
+
 uint32_t VulkanApplication::findGPUMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties)
 {
     VkPhysicalDeviceMemoryProperties memProperties;
@@ -2354,7 +4672,7 @@ void VulkanApplication::destroyDebugUtilsMessengerEXT(VkInstance instance, VkDeb
 
 VkResult VulkanApplication::createGraphicsCommandBuffer()
 {
-    commandBuffers.resize(kMaxFramesInFlight);
+    commandBuffers.resize(framesInFlight);
 
     VkCommandBufferAllocateInfo allocInfo = {};
     allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
@@ -2366,16 +4684,29 @@ VkResult VulkanApplication::createGraphicsCommandBuffer()
         throw std::runtime_error("failed to allocate command buffers!");
         return VK_ERROR_INITIALIZATION_FAILED;
     }
+
+    // The secondary command buffers executed inside the render pass, each pass's from its own pool, see recordCommandBuffer.
+    allocInfo.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+    for (size_t pass = 0; pass < secondaryCommandBuffers.size(); ++pass) {
+        secondaryCommandBuffers[pass].resize(framesInFlight);
+        allocInfo.commandPool = secondaryCommandPools[pass];
+        allocInfo.commandBufferCount = framesInFlight;
+
+        if (vkAllocateCommandBuffers(m_LogicalDevice, &allocInfo, secondaryCommandBuffers[pass].data()) != VK_SUCCESS) {
+            throw std::runtime_error("failed to allocate secondary command buffers!");
+            return VK_ERROR_INITIALIZATION_FAILED;
+        }
+    }
     return VK_SUCCESS;
 }
 
 VkResult VulkanApplication::createComputeCommandBuffer()
 {
-    computeCommandBuffers.resize(kMaxFramesInFlight);
+    computeCommandBuffers.resize(framesInFlight);
 
     VkCommandBufferAllocateInfo allocInfo = {};
     allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-    allocInfo.commandPool = commandPool;
+    allocInfo.commandPool = computeCommandPool;
     allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
     allocInfo.commandBufferCount = (uint32_t)computeCommandBuffers.size();
 
@@ -2422,7 +4753,7 @@ VkResult VulkanApplication::createModelDescriptorSetLayout()
 VkResult VulkanApplication::createGrassDescriptorSetLayout()
 {
     // This layout requires a UBO for the camera data to be used here too, so that the grass positions can be represented as points.
-    std::array<VkDescriptorSetLayoutBinding, 5> layoutBindings = {};
+    std::array<VkDescriptorSetLayoutBinding, 10> layoutBindings = {};
 
     // Uniform buffer objects.
     layoutBindings[0] = {};
@@ -2440,7 +4771,7 @@ VkResult VulkanApplication::createGrassDescriptorSetLayout()
     layoutBindings[1].stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_COMPUTE_BIT; 
     layoutBindings[1].pImmutableSamplers = nullptr;
 
-    // Shader storage buffer object current frame
+    // Shader storage buffer object for the compacted visible blades.
     layoutBindings[2] = {};
     layoutBindings[2].binding = 2;
     layoutBindings[2].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER; 
@@ -2464,6 +4795,45 @@ VkResult VulkanApplication::createGrassDescriptorSetLayout()
     layoutBindings[4].stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT | VK_SHADER_STAGE_COMPUTE_BIT;
     layoutBindings[4].pImmutableSamplers = nullptr;
 
+    // Wind field, sampled once per-blade during the culling pass.
+    layoutBindings[5] = {};
+    layoutBindings[5].binding = 5;
+    layoutBindings[5].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    layoutBindings[5].descriptorCount = 1;
+    layoutBindings[5].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    layoutBindings[5].pImmutableSamplers = nullptr;
+
+    // Shader storage buffer object current frame, the simulated blade state read back by the next frame.
+    layoutBindings[6] = {};
+    layoutBindings[6].binding = 6;
+    layoutBindings[6].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    layoutBindings[6].descriptorCount = 1;
+    layoutBindings[6].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    layoutBindings[6].pImmutableSamplers = nullptr;
+
+    // Sphere colliders binned into a grid, rebuilt by the CPU every frame.
+    layoutBindings[7] = {};
+    layoutBindings[7].binding = 7;
+    layoutBindings[7].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    layoutBindings[7].descriptorCount = 1;
+    layoutBindings[7].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    layoutBindings[7].pImmutableSamplers = nullptr;
+
+    // Trample amounts last frame and current frame, ping-ponged like bindings 1 and 6.
+    layoutBindings[8] = {};
+    layoutBindings[8].binding = 8;
+    layoutBindings[8].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    layoutBindings[8].descriptorCount = 1;
+    layoutBindings[8].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    layoutBindings[8].pImmutableSamplers = nullptr;
+
+    layoutBindings[9] = {};
+    layoutBindings[9].binding = 9;
+    layoutBindings[9].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    layoutBindings[9].descriptorCount = 1;
+    layoutBindings[9].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    layoutBindings[9].pImmutableSamplers = nullptr;
+
     VkDescriptorSetLayoutCreateInfo layoutCreateInfo = {};
     layoutCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
     layoutCreateInfo.bindingCount = static_cast<uint32_t>(layoutBindings.size());
@@ -2477,63 +4847,92 @@ VkResult VulkanApplication::createGrassDescriptorSetLayout()
     return VK_SUCCESS;
 }
 
+VkResult VulkanApplication::createWindFieldDescriptorSetLayout()
+{
+    // The wind field pipeline only writes the wind field image, everything else it needs is pushed as constants.
+    VkDescriptorSetLayoutBinding storageImageBinding = {};
+    storageImageBinding.binding = 0;
+    storageImageBinding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+    storageImageBinding.descriptorCount = 1;
+    storageImageBinding.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    storageImageBinding.pImmutableSamplers = nullptr;
+
+    VkDescriptorSetLayoutCreateInfo layoutInfo = {};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layoutInfo.pNext = nullptr;
+    layoutInfo.flags = 0;
+    layoutInfo.bindingCount = 1;
+    layoutInfo.pBindings = &storageImageBinding;
+
+    if (vkCreateDescriptorSetLayout(m_LogicalDevice, &layoutInfo, nullptr, &windFieldDescriptorSetLayout) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create wind field descriptor set layout!");
+        return VK_ERROR_INITIALIZATION_FAILED;
+    }
+
+    return VK_SUCCESS;
+}
+
 VkResult VulkanApplication::createModelDescriptorSets()
 {
     //
-    // Create descriptor sets for the model pipeline.
+    // Create descriptor sets for the model pipeline, one per-frame in flight for the uniform buffers.
     //
 
-    VkDescriptorSetLayout modelLayout(modelDescriptorSetLayout);
+    std::vector<VkDescriptorSetLayout> modelLayouts(framesInFlight, modelDescriptorSetLayout);
 
     VkDescriptorSetAllocateInfo modelAllocInfo = {};
     modelAllocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
     modelAllocInfo.descriptorPool = descriptorPool;
-    modelAllocInfo.descriptorSetCount = 1;
-    modelAllocInfo.pSetLayouts = &modelLayout;
+    modelAllocInfo.descriptorSetCount = static_cast<uint32_t>(modelLayouts.size());
+    modelAllocInfo.pSetLayouts = modelLayouts.data();
 
     // Allocate uniform buffer descriptor set memory.
-    if (vkAllocateDescriptorSets(m_LogicalDevice, &modelAllocInfo, &modelPipelineDescriptorSet) != VK_SUCCESS) {
+    modelPipelineDescriptorSets.resize(framesInFlight);
+    if (vkAllocateDescriptorSets(m_LogicalDevice, &modelAllocInfo, modelPipelineDescriptorSets.data()) != VK_SUCCESS) {
         throw std::runtime_error("failed to allocate descriptor sets!");
         return VK_ERROR_INITIALIZATION_FAILED;
     }
 
-    std::array<VkWriteDescriptorSet, 2> modelDescriptorWrites = {};
-
-    VkDescriptorBufferInfo uboBufferInfo = {};
-    uboBufferInfo.buffer = uniformBuffer;
-    uboBufferInfo.offset = 0;
-    uboBufferInfo.range = sizeof(CameraUniformBufferObject); // Assumes only one CameraUniformBufferObject will be sent.    
-
-    modelDescriptorWrites[0] = {};
-    modelDescriptorWrites[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-    modelDescriptorWrites[0].pNext = nullptr;
-    modelDescriptorWrites[0].dstSet = modelPipelineDescriptorSet;
-    modelDescriptorWrites[0].dstBinding = 0;
-    modelDescriptorWrites[0].dstArrayElement = 0;
-    modelDescriptorWrites[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-    modelDescriptorWrites[0].descriptorCount = 1;
-    modelDescriptorWrites[0].pImageInfo = nullptr;
-    modelDescriptorWrites[0].pBufferInfo = &uboBufferInfo;
-    modelDescriptorWrites[0].pTexelBufferView = nullptr;
-
-    VkDescriptorImageInfo heightMapImageInfo = {};
-    heightMapImageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-    heightMapImageInfo.imageView = heightMapImageView;
-    heightMapImageInfo.sampler = heightMapSampler;
-
-    modelDescriptorWrites[1] = {};
-    modelDescriptorWrites[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-    modelDescriptorWrites[1].pNext = nullptr;
-    modelDescriptorWrites[1].dstSet = modelPipelineDescriptorSet;
-    modelDescriptorWrites[1].dstBinding = 1;
-    modelDescriptorWrites[1].dstArrayElement = 0;
-    modelDescriptorWrites[1].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-    modelDescriptorWrites[1].descriptorCount = 1;
-    modelDescriptorWrites[1].pImageInfo = &heightMapImageInfo;
-    modelDescriptorWrites[1].pBufferInfo = nullptr;
-    modelDescriptorWrites[1].pTexelBufferView = nullptr;
-
-    vkUpdateDescriptorSets(m_LogicalDevice, static_cast<uint32_t>(modelDescriptorWrites.size()), modelDescriptorWrites.data(), 0, nullptr);
+    for (size_t i = 0; i < framesInFlight; ++i) {
+
+        std::array<VkWriteDescriptorSet, 2> modelDescriptorWrites = {};
+
+        VkDescriptorBufferInfo uboBufferInfo = {};
+        uboBufferInfo.buffer = uniformBuffers[i];
+        uboBufferInfo.offset = 0;
+        uboBufferInfo.range = sizeof(CameraUniformBufferObject); // Assumes only one CameraUniformBufferObject will be sent.    
+
+        modelDescriptorWrites[0] = {};
+        modelDescriptorWrites[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        modelDescriptorWrites[0].pNext = nullptr;
+        modelDescriptorWrites[0].dstSet = modelPipelineDescriptorSets[i];
+        modelDescriptorWrites[0].dstBinding = 0;
+        modelDescriptorWrites[0].dstArrayElement = 0;
+        modelDescriptorWrites[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+        modelDescriptorWrites[0].descriptorCount = 1;
+        modelDescriptorWrites[0].pImageInfo = nullptr;
+        modelDescriptorWrites[0].pBufferInfo = &uboBufferInfo;
+        modelDescriptorWrites[0].pTexelBufferView = nullptr;
+
+        VkDescriptorImageInfo heightMapImageInfo = {};
+        heightMapImageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        heightMapImageInfo.imageView = heightMapImageView;
+        heightMapImageInfo.sampler = heightMapSampler;
+
+        modelDescriptorWrites[1] = {};
+        modelDescriptorWrites[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        modelDescriptorWrites[1].pNext = nullptr;
+        modelDescriptorWrites[1].dstSet = modelPipelineDescriptorSets[i];
+        modelDescriptorWrites[1].dstBinding = 1;
+        modelDescriptorWrites[1].dstArrayElement = 0;
+        modelDescriptorWrites[1].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        modelDescriptorWrites[1].descriptorCount = 1;
+        modelDescriptorWrites[1].pImageInfo = &heightMapImageInfo;
+        modelDescriptorWrites[1].pBufferInfo = nullptr;
+        modelDescriptorWrites[1].pTexelBufferView = nullptr;
+
+        vkUpdateDescriptorSets(m_LogicalDevice, static_cast<uint32_t>(modelDescriptorWrites.size()), modelDescriptorWrites.data(), 0, nullptr);
+    }
 
     return VK_SUCCESS;
 }
@@ -2541,100 +4940,222 @@ VkResult VulkanApplication::createModelDescriptorSets()
 VkResult VulkanApplication::createGrassDescriptorSets()
 {
     //
-    // Create descriptor sets for the grass pipeline.
+    // Create descriptor sets for the grass pipeline, one per-frame in flight so the blade state buffers can ping-pong.
     //
 
-    VkDescriptorSetLayout grassLayout(grassDescriptorSetLayout);
+    std::vector<VkDescriptorSetLayout> grassLayouts(framesInFlight, grassDescriptorSetLayout);
 
     VkDescriptorSetAllocateInfo grassAllocInfo = {};
     grassAllocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
     grassAllocInfo.descriptorPool = descriptorPool;
-    grassAllocInfo.descriptorSetCount = 1;
-    grassAllocInfo.pSetLayouts = &grassLayout;
+    grassAllocInfo.descriptorSetCount = static_cast<uint32_t>(grassLayouts.size());
+    grassAllocInfo.pSetLayouts = grassLayouts.data();
 
     // Allocate shader storage buffer descriptor set memory.
-    VkResult ret = vkAllocateDescriptorSets(m_LogicalDevice, &grassAllocInfo, &grassPipelineDescriptorSet);
+    grassPipelineDescriptorSets.resize(framesInFlight);
+    VkResult ret = vkAllocateDescriptorSets(m_LogicalDevice, &grassAllocInfo, grassPipelineDescriptorSets.data());
     if (ret != VK_SUCCESS) {
         throw std::runtime_error("failed to allocate descriptor sets!");
         return ret;
     }   
 
-    std::array<VkWriteDescriptorSet, 5> grassDescriptorWrites = {};
-
-    VkDescriptorBufferInfo uboBufferInfo = {};
-    uboBufferInfo.buffer = uniformBuffer;
-    uboBufferInfo.offset = 0;
-    uboBufferInfo.range = sizeof(CameraUniformBufferObject); // Assumes only one CameraUniformBufferObject will be sent.
-
-    grassDescriptorWrites[0] = {};
-    grassDescriptorWrites[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-    grassDescriptorWrites[0].dstSet = grassPipelineDescriptorSet;
-    grassDescriptorWrites[0].dstBinding = 0;
-    grassDescriptorWrites[0].dstArrayElement = 0;
-    grassDescriptorWrites[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-    grassDescriptorWrites[0].descriptorCount = 1;
-    grassDescriptorWrites[0].pBufferInfo = &uboBufferInfo;
-
-    VkDescriptorBufferInfo ssboBufferInfoLastFrame = {};
-    ssboBufferInfoLastFrame.buffer = bladeInstanceDataBuffer[(currentFrame - 1) % kMaxFramesInFlight]; // Return the index for the previous frame, % to ensure correct wrapping.  
-    ssboBufferInfoLastFrame.offset = 0;  
-    ssboBufferInfoLastFrame.range = sizeof(GrassBladeInstanceData) * kMaxBlades; 
-
-    grassDescriptorWrites[1] = {};
-    grassDescriptorWrites[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-    grassDescriptorWrites[1].dstSet = grassPipelineDescriptorSet;
-    grassDescriptorWrites[1].dstBinding = 1;
-    grassDescriptorWrites[1].dstArrayElement = 0;
-    grassDescriptorWrites[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
-    grassDescriptorWrites[1].descriptorCount = 1;
-    grassDescriptorWrites[1].pBufferInfo = &ssboBufferInfoLastFrame;
-
-    VkDescriptorBufferInfo ssboBufferInfoCurrentFrame = {};
-    ssboBufferInfoCurrentFrame.buffer = bladeInstanceDataBuffer[(currentFrame) % kMaxFramesInFlight]; // Return the index for the current frame, % to ensure correct wrapping. 
-    ssboBufferInfoCurrentFrame.offset = 0; 
-    ssboBufferInfoCurrentFrame.range = sizeof(GrassBladeInstanceData) * kMaxBlades; 
-
-    grassDescriptorWrites[2] = {};
-    grassDescriptorWrites[2].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-    grassDescriptorWrites[2].dstSet = grassPipelineDescriptorSet;
-    grassDescriptorWrites[2].dstBinding = 2;
-    grassDescriptorWrites[2].dstArrayElement = 0;
-    grassDescriptorWrites[2].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
-    grassDescriptorWrites[2].descriptorCount = 1;
-    grassDescriptorWrites[2].pBufferInfo = &ssboBufferInfoCurrentFrame;
-
-    VkDescriptorBufferInfo sboNumBladesBufferInfo = {};
-    sboNumBladesBufferInfo.buffer = numBladesBuffer;
-    sboNumBladesBufferInfo.offset = 0;
-    sboNumBladesBufferInfo.range = sizeof(NumBladesBufferObject);
-
-    grassDescriptorWrites[3] = {};
-    grassDescriptorWrites[3].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-    grassDescriptorWrites[3].dstSet = grassPipelineDescriptorSet;
-    grassDescriptorWrites[3].dstBinding = 3;
-    grassDescriptorWrites[3].dstArrayElement = 0;
-    grassDescriptorWrites[3].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
-    grassDescriptorWrites[3].descriptorCount = 1;
-    grassDescriptorWrites[3].pBufferInfo = &sboNumBladesBufferInfo;
-
-    VkDescriptorImageInfo heightMapImageInfo = {};
-    heightMapImageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-    heightMapImageInfo.imageView = heightMapImageView;
-    heightMapImageInfo.sampler = heightMapSampler;
-
-    grassDescriptorWrites[4] = {};
-    grassDescriptorWrites[4].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-    grassDescriptorWrites[4].pNext = nullptr;
-    grassDescriptorWrites[4].dstSet = grassPipelineDescriptorSet;
-    grassDescriptorWrites[4].dstBinding = 4;
-    grassDescriptorWrites[4].dstArrayElement = 0;
-    grassDescriptorWrites[4].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-    grassDescriptorWrites[4].descriptorCount = 1;
-    grassDescriptorWrites[4].pImageInfo = &heightMapImageInfo;
-    grassDescriptorWrites[4].pBufferInfo = nullptr;
-    grassDescriptorWrites[4].pTexelBufferView = nullptr;
-
-    vkUpdateDescriptorSets(m_LogicalDevice, static_cast<uint32_t>(grassDescriptorWrites.size()), grassDescriptorWrites.data(), 0, nullptr);
+    for (size_t i = 0; i < framesInFlight; ++i) {
+
+        std::array<VkWriteDescriptorSet, 10> grassDescriptorWrites = {};
+
+        VkDescriptorBufferInfo uboBufferInfo = {};
+        uboBufferInfo.buffer = uniformBuffers[i];
+        uboBufferInfo.offset = 0;
+        uboBufferInfo.range = sizeof(CameraUniformBufferObject); // Assumes only one CameraUniformBufferObject will be sent.
+
+        grassDescriptorWrites[0] = {};
+        grassDescriptorWrites[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        grassDescriptorWrites[0].dstSet = grassPipelineDescriptorSets[i];
+        grassDescriptorWrites[0].dstBinding = 0;
+        grassDescriptorWrites[0].dstArrayElement = 0;
+        grassDescriptorWrites[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+        grassDescriptorWrites[0].descriptorCount = 1;
+        grassDescriptorWrites[0].pBufferInfo = &uboBufferInfo;
+
+        // Frame i reads the state written by the frame before it, and writes the state the frame after it will read.
+        VkDescriptorBufferInfo ssboBufferInfoLastFrame = {};
+        ssboBufferInfoLastFrame.buffer = bladeInstanceDataBuffer[(i + framesInFlight - 1) % framesInFlight]; // Return the index for the previous frame, % to ensure correct wrapping.  
+        ssboBufferInfoLastFrame.offset = 0;  
+        ssboBufferInfoLastFrame.range = sizeof(GrassBladeInstanceData) * bladeCapacity; 
+
+        grassDescriptorWrites[1] = {};
+        grassDescriptorWrites[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        grassDescriptorWrites[1].dstSet = grassPipelineDescriptorSets[i];
+        grassDescriptorWrites[1].dstBinding = 1;
+        grassDescriptorWrites[1].dstArrayElement = 0;
+        grassDescriptorWrites[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        grassDescriptorWrites[1].descriptorCount = 1;
+        grassDescriptorWrites[1].pBufferInfo = &ssboBufferInfoLastFrame;
+
+        VkDescriptorBufferInfo ssboBufferInfoVisible = {};
+        ssboBufferInfoVisible.buffer = visibleBladeInstanceDataBuffers[i % visibleBladeInstanceDataBuffers.size()];
+        ssboBufferInfoVisible.offset = 0; 
+        ssboBufferInfoVisible.range = sizeof(GrassBladeInstanceData) * bladeCapacity; 
+
+        grassDescriptorWrites[2] = {};
+        grassDescriptorWrites[2].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        grassDescriptorWrites[2].dstSet = grassPipelineDescriptorSets[i];
+        grassDescriptorWrites[2].dstBinding = 2;
+        grassDescriptorWrites[2].dstArrayElement = 0;
+        grassDescriptorWrites[2].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        grassDescriptorWrites[2].descriptorCount = 1;
+        grassDescriptorWrites[2].pBufferInfo = &ssboBufferInfoVisible;
+
+        VkDescriptorBufferInfo sboNumBladesBufferInfo = {};
+        sboNumBladesBufferInfo.buffer = numBladesBuffers[i];
+        sboNumBladesBufferInfo.offset = 0;
+        sboNumBladesBufferInfo.range = sizeof(NumBladesBufferObject);
+
+        grassDescriptorWrites[3] = {};
+        grassDescriptorWrites[3].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        grassDescriptorWrites[3].dstSet = grassPipelineDescriptorSets[i];
+        grassDescriptorWrites[3].dstBinding = 3;
+        grassDescriptorWrites[3].dstArrayElement = 0;
+        grassDescriptorWrites[3].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        grassDescriptorWrites[3].descriptorCount = 1;
+        grassDescriptorWrites[3].pBufferInfo = &sboNumBladesBufferInfo;
+
+        VkDescriptorImageInfo heightMapImageInfo = {};
+        heightMapImageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        heightMapImageInfo.imageView = heightMapImageView;
+        heightMapImageInfo.sampler = heightMapSampler;
+
+        grassDescriptorWrites[4] = {};
+        grassDescriptorWrites[4].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        grassDescriptorWrites[4].pNext = nullptr;
+        grassDescriptorWrites[4].dstSet = grassPipelineDescriptorSets[i];
+        grassDescriptorWrites[4].dstBinding = 4;
+        grassDescriptorWrites[4].dstArrayElement = 0;
+        grassDescriptorWrites[4].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        grassDescriptorWrites[4].descriptorCount = 1;
+        grassDescriptorWrites[4].pImageInfo = &heightMapImageInfo;
+        grassDescriptorWrites[4].pBufferInfo = nullptr;
+        grassDescriptorWrites[4].pTexelBufferView = nullptr;
+
+        // The height map sampler already filters linearly and repeats, which is exactly what the tileable wind field needs.
+        VkDescriptorImageInfo windFieldImageInfo = {};
+        windFieldImageInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+        windFieldImageInfo.imageView = windFieldImageView;
+        windFieldImageInfo.sampler = heightMapSampler;
+
+        grassDescriptorWrites[5] = {};
+        grassDescriptorWrites[5].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        grassDescriptorWrites[5].pNext = nullptr;
+        grassDescriptorWrites[5].dstSet = grassPipelineDescriptorSets[i];
+        grassDescriptorWrites[5].dstBinding = 5;
+        grassDescriptorWrites[5].dstArrayElement = 0;
+        grassDescriptorWrites[5].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        grassDescriptorWrites[5].descriptorCount = 1;
+        grassDescriptorWrites[5].pImageInfo = &windFieldImageInfo;
+        grassDescriptorWrites[5].pBufferInfo = nullptr;
+        grassDescriptorWrites[5].pTexelBufferView = nullptr;
+
+        VkDescriptorBufferInfo ssboBufferInfoCurrentFrame = {};
+        ssboBufferInfoCurrentFrame.buffer = bladeInstanceDataBuffer[i]; // The index for the current frame.
+        ssboBufferInfoCurrentFrame.offset = 0; 
+        ssboBufferInfoCurrentFrame.range = sizeof(GrassBladeInstanceData) * bladeCapacity; 
+
+        grassDescriptorWrites[6] = {};
+        grassDescriptorWrites[6].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        grassDescriptorWrites[6].dstSet = grassPipelineDescriptorSets[i];
+        grassDescriptorWrites[6].dstBinding = 6;
+        grassDescriptorWrites[6].dstArrayElement = 0;
+        grassDescriptorWrites[6].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        grassDescriptorWrites[6].descriptorCount = 1;
+        grassDescriptorWrites[6].pBufferInfo = &ssboBufferInfoCurrentFrame;
+
+        VkDescriptorBufferInfo colliderBufferInfo = {};
+        colliderBufferInfo.buffer = colliderBuffer[i];
+        colliderBufferInfo.offset = 0;
+        colliderBufferInfo.range = sizeof(ColliderBufferObject);
+
+        grassDescriptorWrites[7] = {};
+        grassDescriptorWrites[7].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        grassDescriptorWrites[7].dstSet = grassPipelineDescriptorSets[i];
+        grassDescriptorWrites[7].dstBinding = 7;
+        grassDescriptorWrites[7].dstArrayElement = 0;
+        grassDescriptorWrites[7].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        grassDescriptorWrites[7].descriptorCount = 1;
+        grassDescriptorWrites[7].pBufferInfo = &colliderBufferInfo;
+
+        VkDescriptorBufferInfo trampleBufferInfoLastFrame = {};
+        trampleBufferInfoLastFrame.buffer = trampleBuffer[(i + framesInFlight - 1) % framesInFlight];
+        trampleBufferInfoLastFrame.offset = 0;
+        trampleBufferInfoLastFrame.range = sizeof(float) * bladeCapacity;
+
+        grassDescriptorWrites[8] = {};
+        grassDescriptorWrites[8].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        grassDescriptorWrites[8].dstSet = grassPipelineDescriptorSets[i];
+        grassDescriptorWrites[8].dstBinding = 8;
+        grassDescriptorWrites[8].dstArrayElement = 0;
+        grassDescriptorWrites[8].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        grassDescriptorWrites[8].descriptorCount = 1;
+        grassDescriptorWrites[8].pBufferInfo = &trampleBufferInfoLastFrame;
+
+        VkDescriptorBufferInfo trampleBufferInfoCurrentFrame = {};
+        trampleBufferInfoCurrentFrame.buffer = trampleBuffer[i];
+        trampleBufferInfoCurrentFrame.offset = 0;
+        trampleBufferInfoCurrentFrame.range = sizeof(float) * bladeCapacity;
+
+        grassDescriptorWrites[9] = {};
+        grassDescriptorWrites[9].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        grassDescriptorWrites[9].dstSet = grassPipelineDescriptorSets[i];
+        grassDescriptorWrites[9].dstBinding = 9;
+        grassDescriptorWrites[9].dstArrayElement = 0;
+        grassDescriptorWrites[9].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        grassDescriptorWrites[9].descriptorCount = 1;
+        grassDescriptorWrites[9].pBufferInfo = &trampleBufferInfoCurrentFrame;
+
+        vkUpdateDescriptorSets(m_LogicalDevice, static_cast<uint32_t>(grassDescriptorWrites.size()), grassDescriptorWrites.data(), 0, nullptr);
+    }
+
+    return ret;
+}
+
+VkResult VulkanApplication::createWindFieldDescriptorSets()
+{
+    //
+    // Create descriptor sets for the wind field pipeline.
+    //
+
+    VkDescriptorSetLayout windFieldLayout(windFieldDescriptorSetLayout);
+
+    VkDescriptorSetAllocateInfo windFieldAllocInfo = {};
+    windFieldAllocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    windFieldAllocInfo.descriptorPool = descriptorPool;
+    windFieldAllocInfo.descriptorSetCount = 1;
+    windFieldAllocInfo.pSetLayouts = &windFieldLayout;
+
+    // Allocate storage image descriptor set memory.
+    VkResult ret = vkAllocateDescriptorSets(m_LogicalDevice, &windFieldAllocInfo, &windFieldPipelineDescriptorSet);
+    if (ret != VK_SUCCESS) {
+        throw std::runtime_error("failed to allocate descriptor sets!");
+        return ret;
+    }
+
+    VkDescriptorImageInfo windFieldImageInfo = {};
+    windFieldImageInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+    windFieldImageInfo.imageView = windFieldImageView;
+    windFieldImageInfo.sampler = VK_NULL_HANDLE;
+
+    VkWriteDescriptorSet windFieldDescriptorWrite = {};
+    windFieldDescriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    windFieldDescriptorWrite.pNext = nullptr;
+    windFieldDescriptorWrite.dstSet = windFieldPipelineDescriptorSet;
+    windFieldDescriptorWrite.dstBinding = 0;
+    windFieldDescriptorWrite.dstArrayElement = 0;
+    windFieldDescriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+    windFieldDescriptorWrite.descriptorCount = 1;
+    windFieldDescriptorWrite.pImageInfo = &windFieldImageInfo;
+    windFieldDescriptorWrite.pBufferInfo = nullptr;
+    windFieldDescriptorWrite.pTexelBufferView = nullptr;
+
+    vkUpdateDescriptorSets(m_LogicalDevice, 1, &windFieldDescriptorWrite, 0, nullptr);
 
     return ret;
 }
@@ -2734,6 +5255,12 @@ void VulkanApplication::transitionImageLayout(VkImage image, VkFormat format, Vk
         sourceStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
         destinationStage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
     }
+    else if (oldLayout == VK_IMAGE_LAYOUT_UNDEFINED && newLayout == VK_IMAGE_LAYOUT_GENERAL) {
+        barrier.srcAccessMask = 0;
+        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+        sourceStage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+        destinationStage = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+    }
     else {
         throw std::invalid_argument("unsupported layout transition!");
     }
@@ -2780,28 +5307,74 @@ void VulkanApplication::endSingleTimeCommands(VkCommandBuffer commandBuffer)
 
 bool VulkanApplication::checkPhysicalDeviceSuitability(VkPhysicalDevice device)
 {
-    VkPhysicalDeviceProperties deviceProperties;
-    VkPhysicalDeviceFeatures deviceFeatures;
-    vkGetPhysicalDeviceProperties(device, &deviceProperties);
-    vkGetPhysicalDeviceFeatures(device, &deviceFeatures);
     QueueFamilyIndices indices = findQueueFamilies(device, m_SurfaceKHR);
 
+    if (!checkPhysicalDeviceTimelineSemaphoreSupport(device)) {
+        return false;
+    }
+
+    // Headless runs only need a graphics and compute queue, the swapchain extension is neither required nor enabled.
+    if (headless) {
+        return indices.graphicsAndComputeFamily.has_value();
+    }
+
     bool isSwapchainAdequate = false;
     if (checkPhysicalDeviceExtensionSupport(device)) {
         SwapChain swapChainSupport = checkSwapchainSupport(device);
         isSwapchainAdequate = !swapChainSupport.formats.empty() && !swapChainSupport.presentModes.empty();
     }
 
+    // Tessellation is no longer a requirement, devices without it are given the instanced strip path (see createPhysicalDevice).
+    return indices.isComplete()
+        && checkPhysicalDeviceExtensionSupport(device)
+        && isSwapchainAdequate;
+}
+
+bool VulkanApplication::checkPhysicalDeviceTessellationSupport(VkPhysicalDevice device)
+{
     VkPhysicalDeviceFeatures supportedFeatures;
     vkGetPhysicalDeviceFeatures(device, &supportedFeatures);
 
-    return deviceProperties.deviceType == VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU 
-        && deviceFeatures.tessellationShader
-        && deviceFeatures.shaderTessellationAndGeometryPointSize
-        && deviceFeatures.multiDrawIndirect
-        && indices.isComplete()
-        && checkPhysicalDeviceExtensionSupport(device)
-        && isSwapchainAdequate;
+    return supportedFeatures.tessellationShader
+        && supportedFeatures.shaderTessellationAndGeometryPointSize;
+}
+
+bool VulkanApplication::checkPhysicalDeviceTimelineSemaphoreSupport(VkPhysicalDevice device)
+{
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(device, &properties);
+    if (properties.apiVersion < VK_API_VERSION_1_2) {
+        return false;
+    }
+
+    VkPhysicalDeviceVulkan12Features vulkan12Features = {};
+    vulkan12Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+
+    VkPhysicalDeviceFeatures2 supportedFeatures = {};
+    supportedFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+    supportedFeatures.pNext = &vulkan12Features;
+    vkGetPhysicalDeviceFeatures2(device, &supportedFeatures);
+
+    return vulkan12Features.timelineSemaphore;
+}
+
+bool VulkanApplication::checkPhysicalDeviceDynamicRenderingSupport(VkPhysicalDevice device)
+{
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(device, &properties);
+    if (properties.apiVersion < VK_API_VERSION_1_3) {
+        return false;
+    }
+
+    VkPhysicalDeviceVulkan13Features vulkan13Features = {};
+    vulkan13Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES;
+
+    VkPhysicalDeviceFeatures2 supportedFeatures = {};
+    supportedFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+    supportedFeatures.pNext = &vulkan13Features;
+    vkGetPhysicalDeviceFeatures2(device, &supportedFeatures);
+
+    return vulkan13Features.dynamicRendering;
 }
 
 bool VulkanApplication::checkPhysicalDeviceExtensionSupport(VkPhysicalDevice device)
@@ -12,7 +12,17 @@
 #include <Camera.h>
 #include <Timer.h>
 
+#include <FrameStats.h>
+#include <CameraPath.h>
+#include <CpuProfiler.h>
+
 #include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <iostream>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
 
 // ===============================================================================================================================================================================
 
@@ -70,116 +80,585 @@ static void keyCallback(GLFWwindow* window, int key, int scancode, int action, i
     }
 }
 
+// Benchmark capture lengths and headless mode, from the command line with Constants.h providing the defaults.
+struct LaunchOptions {
+    int warmupFrames = kWaitFrames;     // Frames to wait for the scene to populate before capturing.
+    int captureFrames = kMonitorFrames; // Frames to capture, 0 disables the capture.
+    bool headless = false;              // Render offscreen with no window, then exit once the capture completes.
+    bool trace = false;                 // Record CPU zones and export Chrome traces of the start-up and each capture.
+    bool coldPipelines = false;         // Ignore the pipeline cache on disk, to time pipeline creation from scratch.
+    bool asyncCompute = true;           // Cull on a queue of its own when the device has one.
+    bool dynamicRendering = true;       // Render with vkCmdBeginRendering when the device supports it.
+    bool resizeTest = false;            // Resize the window on a script, report the swapchain recreation stalls, and close.
+    VkPresentModeKHR presentMode = VK_PRESENT_MODE_MAILBOX_KHR; // Preferred present mode, see VulkanApplication::setPresentMode.
+    int swapchainImages = 0;            // Swapchain images to request, 0 for one more than the surface minimum.
+    int fpsLimit = 0;                   // Frame rate to pace the application loop to, 0 for unlimited.
+    int width = 1920;                   // Window or offscreen resolution.
+    int height = 1080;
+    int framesInFlight = kDefaultFramesInFlight;    // Frames the CPU may record ahead of the GPU, 1 to kMaxFramesInFlight.
+    std::string cameraPath;             // Camera path file to play, "default" for the built-in flythrough, empty for live input.
+    std::string recordPath;             // Camera path file to record live input into, written on exit.
+    std::vector<uint32_t> sweepBlades;  // Blade counts to sweep, see buildSweep.
+    std::vector<bool> sweepCulling;     // Frustum culling modes to sweep.
+    std::vector<float> sweepTessellation;   // Maximum grass tessellation levels to sweep.
+    std::vector<uint32_t> sweepWorkgroup;   // Grass compute workgroup sizes to sweep.
+    std::vector<bool> sweepWindField;       // Wind field or per-blade Perlin noise to sweep.
+};
+
+// Split a comma separated option value, "a,b,c".
+static std::vector<std::string> splitList(const std::string& text) {
+    std::vector<std::string> items = {};
+    std::istringstream stream(text);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        if (!item.empty()) {
+            items.push_back(item);
+        }
+    }
+    if (items.empty()) {
+        throw std::runtime_error("empty list " + text);
+    }
+    return items;
+}
+
+// Parse "--warmup <frames>", "--capture <frames>", "--headless", "--trace", "--cold-pipelines", "--no-async-compute", "--render-pass", "--resize-test", "--width <pixels>",
+// "--height <pixels>", "--present-mode <fifo|mailbox|immediate>", "--swapchain-images <n>", "--fps-limit <fps>", "--camera-path <file|default>", "--record-path <file>", "--frames-in-flight <1-4>", "--sweep-blades <n,n,...>", "--sweep-culling <on|off,...>", "--sweep-tessellation <level,level,...>",
+// "--sweep-workgroup <size,size,...>", and "--sweep-wind-field <on|off,...>", other arguments are ignored.
+static LaunchOptions parseLaunchOptions(int argc, char** argv) {
+    LaunchOptions options = {};
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--headless") == 0) {
+            options.headless = true;
+            continue;
+        }
+        if (std::strcmp(argv[i], "--trace") == 0) {
+            options.trace = true;
+            continue;
+        }
+        if (std::strcmp(argv[i], "--cold-pipelines") == 0) {
+            options.coldPipelines = true;
+            continue;
+        }
+        if (std::strcmp(argv[i], "--no-async-compute") == 0) {
+            options.asyncCompute = false;
+            continue;
+        }
+        if (std::strcmp(argv[i], "--render-pass") == 0) {
+            options.dynamicRendering = false;
+            continue;
+        }
+        if (std::strcmp(argv[i], "--resize-test") == 0) {
+            options.resizeTest = true;
+            continue;
+        }
+        if (std::strcmp(argv[i], "--present-mode") == 0) {
+            if (i + 1 >= argc) {
+                throw std::runtime_error(std::string("missing value after ") + argv[i]);
+            }
+            std::string mode = argv[++i];
+            if (mode == "fifo") options.presentMode = VK_PRESENT_MODE_FIFO_KHR;
+            else if (mode == "mailbox") options.presentMode = VK_PRESENT_MODE_MAILBOX_KHR;
+            else if (mode == "immediate") options.presentMode = VK_PRESENT_MODE_IMMEDIATE_KHR;
+            else throw std::runtime_error("present mode must be fifo, mailbox, or immediate, not " + mode);
+            continue;
+        }
+
+        if (std::strcmp(argv[i], "--sweep-blades") == 0 || std::strcmp(argv[i], "--sweep-culling") == 0 || std::strcmp(argv[i], "--sweep-tessellation") == 0 ||
+            std::strcmp(argv[i], "--sweep-workgroup") == 0 || std::strcmp(argv[i], "--sweep-wind-field") == 0) {
+            if (i + 1 >= argc) {
+                throw std::runtime_error(std::string("missing value after ") + argv[i]);
+            }
+            std::string option = argv[i];
+            for (const std::string& item : splitList(argv[++i])) {
+                if (option == "--sweep-blades") {
+                    long long numBlades = std::stoll(item);
+                    if (numBlades <= 0 || numBlades > UINT32_MAX) {
+                        throw std::runtime_error("blade count out of range " + item);
+                    }
+                    options.sweepBlades.push_back(static_cast<uint32_t>(numBlades));
+                }
+                else if (option == "--sweep-culling") {
+                    if (item != "on" && item != "off") {
+                        throw std::runtime_error("culling mode must be on or off, not " + item);
+                    }
+                    options.sweepCulling.push_back(item == "on");
+                }
+                else if (option == "--sweep-wind-field") {
+                    if (item != "on" && item != "off") {
+                        throw std::runtime_error("wind field mode must be on or off, not " + item);
+                    }
+                    options.sweepWindField.push_back(item == "on");
+                }
+                else if (option == "--sweep-workgroup") {
+                    long long size = std::stoll(item);
+                    if (size <= 0 || size > 1024 || (size & (size - 1)) != 0) {
+                        throw std::runtime_error("workgroup size must be a power of two up to 1024, not " + item);
+                    }
+                    options.sweepWorkgroup.push_back(static_cast<uint32_t>(size));
+                }
+                else {
+                    float level = std::stof(item);
+                    if (level < 1.0f) {
+                        throw std::runtime_error("tessellation level below 1 " + item);
+                    }
+                    options.sweepTessellation.push_back(level);
+                }
+            }
+            continue;
+        }
+
+        std::string* text = nullptr;
+        if (std::strcmp(argv[i], "--camera-path") == 0) text = &options.cameraPath;
+        else if (std::strcmp(argv[i], "--record-path") == 0) text = &options.recordPath;
+        if (text != nullptr) {
+            if (i + 1 >= argc) {
+                throw std::runtime_error(std::string("missing value after ") + argv[i]);
+            }
+            *text = argv[++i];
+            continue;
+        }
+
+        int* value = nullptr;
+        if (std::strcmp(argv[i], "--warmup") == 0) value = &options.warmupFrames;
+        else if (std::strcmp(argv[i], "--capture") == 0) value = &options.captureFrames;
+        else if (std::strcmp(argv[i], "--width") == 0) value = &options.width;
+        else if (std::strcmp(argv[i], "--height") == 0) value = &options.height;
+        else if (std::strcmp(argv[i], "--frames-in-flight") == 0) value = &options.framesInFlight;
+        else if (std::strcmp(argv[i], "--swapchain-images") == 0) value = &options.swapchainImages;
+        else if (std::strcmp(argv[i], "--fps-limit") == 0) value = &options.fpsLimit;
+        else continue;
+
+        if (i + 1 >= argc) {
+            throw std::runtime_error(std::string("missing value after ") + argv[i]);
+        }
+        *value = std::stoi(argv[++i]);
+        if (*value < 0) {
+            throw std::runtime_error(std::string("negative value after ") + argv[i - 1]);
+        }
+    }
+    if (options.width == 0 || options.height == 0) {
+        throw std::runtime_error("resolution must be non-zero");
+    }
+    if (options.framesInFlight < 1 || options.framesInFlight > kMaxFramesInFlight) {
+        throw std::runtime_error("frames in flight must be between 1 and " + std::to_string(kMaxFramesInFlight));
+    }
+    if (!options.cameraPath.empty() && !options.recordPath.empty()) {
+        throw std::runtime_error("cannot play and record a camera path at once");
+    }
+    if (options.resizeTest && options.headless) {
+        throw std::runtime_error("the resize test needs a window");
+    }
+    return options;
+}
+
+// The scene settings of each configuration of a blade count sweep, the product of the swept blade counts, culling modes, tessellation levels,
+// compute workgroup sizes, and wind field modes. Blade counts change slowest, as only they rebuild the scene. Dimensions that are not swept keep the SceneSettings default, and a
+// run without any sweep options is a single configuration filling the blade capacity.
+static std::vector<SceneSettings> buildSweep(const LaunchOptions& options) {
+    std::vector<uint32_t> blades = options.sweepBlades.empty() ? std::vector<uint32_t>{ 0 } : options.sweepBlades;
+    std::vector<bool> culling = options.sweepCulling.empty() ? std::vector<bool>{ SceneSettings().frustumCulling } : options.sweepCulling;
+    std::vector<float> tessellation = options.sweepTessellation.empty() ? std::vector<float>{ SceneSettings().maxTessellationLevel } : options.sweepTessellation;
+    std::vector<uint32_t> workgroup = options.sweepWorkgroup.empty() ? std::vector<uint32_t>{ SceneSettings().computeWorkgroupSize } : options.sweepWorkgroup;
+    std::vector<bool> windFieldModes = options.sweepWindField.empty() ? std::vector<bool>{ SceneSettings().windField } : options.sweepWindField;
+
+    std::vector<SceneSettings> configurations = {};
+    for (uint32_t numBlades : blades) {
+        for (bool frustumCulling : culling) {
+            for (float maxTessellationLevel : tessellation) {
+                for (uint32_t computeWorkgroupSize : workgroup) {
+                    for (bool windField : windFieldModes) {
+                        SceneSettings settings = {};
+                        settings.numBlades = numBlades;
+                        settings.frustumCulling = frustumCulling;
+                        settings.maxTessellationLevel = maxTessellationLevel;
+                        settings.minTessellationLevel = std::min(settings.minTessellationLevel, maxTessellationLevel);
+                        settings.computeWorkgroupSize = computeWorkgroupSize;
+                        settings.windField = windField;
+                        configurations.push_back(settings);
+                    }
+                }
+            }
+        }
+    }
+    return configurations;
+}
+
+// Name a capture file as "<kind>_<blades>" in the performance timings folder. Sweeping culling prefixes Culled or NoCull like the original data
+// set, and sweeping tessellation, the workgroup size, or the wind field appends the level, size, or mode.
+static std::string getCaptureFileName(const LaunchOptions& options, const SceneSettings& settings, const std::string& kind, const std::string& extension) {
+    std::string name = "../assets/performance_timings/";
+    if (!options.sweepCulling.empty()) {
+        name += settings.frustumCulling ? "Culled" : "NoCull";
+    }
+    name += kind + "_" + std::to_string(settings.numBlades);
+    if (!options.sweepTessellation.empty()) {
+        std::ostringstream level;
+        level << settings.maxTessellationLevel;
+        name += "_tess" + level.str();
+    }
+    if (!options.sweepWorkgroup.empty()) {
+        name += "_wg" + std::to_string(settings.computeWorkgroupSize);
+    }
+    if (!options.sweepWindField.empty()) {
+        name += settings.windField ? "_windField" : "_perlin";
+    }
+    return name + extension;
+}
+
+// Write the per-frame average pipeline statistics of the monitored frames next to the frame timings, one "scope,counter,value" line each.
+static void writePipelineStatistics(const GpuProfiler& gpuProfiler, const std::string& fileName) {
+    if (!gpuProfiler.isPipelineStatisticsEnabled()) {
+        return;
+    }
+
+    std::ofstream file(fileName);
+
+    for (uint32_t i = 0; i < static_cast<uint32_t>(GpuStatisticsScope::Count); ++i) {
+        GpuStatisticsScope scope = static_cast<GpuStatisticsScope>(i);
+        PipelineStatistics statistics = gpuProfiler.getAveragePipelineStatistics(scope);
+        const char* name = getGpuStatisticsScopeName(scope);
+        file << name << ",vertexShaderInvocations," << statistics.vertexShaderInvocations << "\n";
+        file << name << ",tessellationControlPatches," << statistics.tessellationControlPatches << "\n";
+        file << name << ",tessellationEvaluationInvocations," << statistics.tessellationEvaluationInvocations << "\n";
+        file << name << ",clippingInvocations," << statistics.clippingInvocations << "\n";
+        file << name << ",clippingPrimitives," << statistics.clippingPrimitives << "\n";
+        file << name << ",fragmentShaderInvocations," << statistics.fragmentShaderInvocations << "\n";
+        file << name << ",computeShaderInvocations," << statistics.computeShaderInvocations << "\n";
+    }
+}
+
+// Write the time to first frame and every zone recorded until it, per-thread in start order and indented by nesting, as milliseconds since
+// launchNs. Worker zones show what overlapped the main thread, and main thread "Wait for" zones show where it still stalled on them.
+static void writeStartupReport(std::ostream& out, uint64_t launchNs, uint64_t firstFrameNs, const PipelineCacheReport& pipelines) {
+    auto toMs = [launchNs](uint64_t ns) { return static_cast<double>(ns - std::min(ns, launchNs)) / 1e6; };
+
+    out << std::fixed << std::setprecision(3);
+    out << "Time to first frame: " << toMs(firstFrameNs) << " ms\n";
+    out << "Pipeline creation: " << pipelines.creationMs << " ms, " << (pipelines.warm ? "warm" : "cold") << " (pipeline cache " << pipelines.status;
+    if (pipelines.warm) {
+        out << ", " << pipelines.loadedBytes << " bytes";
+    }
+    out << ")\n";
+
+    for (CpuThreadZones& thread : CpuProfiler::get().collectZones(launchNs)) {
+        std::sort(thread.zones.begin(), thread.zones.end(), [](const CpuZoneEvent& a, const CpuZoneEvent& b) {
+            return (a.beginNs != b.beginNs) ? a.beginNs < b.beginNs : a.depth < b.depth;
+        });
+
+        out << "\n" << thread.name << "\n";
+        for (const CpuZoneEvent& zone : thread.zones) {
+            if (zone.beginNs >= firstFrameNs) {
+                break;
+            }
+            out << std::setw(10) << toMs(zone.beginNs) << " ms " << std::setw(10) << (zone.endNs - zone.beginNs) / 1e6 << " ms  "
+                << std::string(zone.depth * 2, ' ') << zone.name << "\n";
+        }
+    }
+}
+
 // ===============================================================================================================================================================================
 // ===============================================================================================================================================================================
 // ===============================================================================================================================================================================
 
 
-int main() {
+int main(int argc, char** argv) {
+
+    // The origin of the start-up report, taken before anything else so the time to first frame includes window and device creation.
+    const uint64_t launchNs = CpuProfiler::now();
+
+    // Benchmark capture lengths and headless mode.
+    LaunchOptions launchOptions = parseLaunchOptions(argc, argv);
+    const bool headless = launchOptions.headless;
 
     // Create an empty application structure.
     VulkanApplication vkApp = {};
 
     // Create a timer instance to obtain delta time for the application loop, auto initialises timer.lastTime.
     Timer timer = {};
+    FrameLimiter frameLimiter = {};
 
-    // Initialize glfw for window creation.
-    if (glfwInit() != GLFW_TRUE) {
-        throw std::runtime_error("failed to initialize glfw!");
+    // Headless runs (CI, benchmark machines without a display) never touch glfw, the application renders into offscreen images instead.
+    GLFWwindow* window = nullptr;
+    if (headless) {
+        vkApp.enableHeadless(static_cast<uint32_t>(launchOptions.width), static_cast<uint32_t>(launchOptions.height));
     }
+    else {
+        // Initialize glfw for window creation.
+        if (glfwInit() != GLFW_TRUE) {
+            throw std::runtime_error("failed to initialize glfw!");
+        }
 
-    // Create the glfw window and its associated context.
-    glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
-    GLFWwindow* window = glfwCreateWindow(1920, 1080, "Vulkan procedural grass renderer", nullptr, nullptr);
-    if (window == nullptr) {
-        throw std::runtime_error("failed to create glfw window!");
-    }
+        // Create the glfw window and its associated context.
+        glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
+        window = glfwCreateWindow(launchOptions.width, launchOptions.height, "Vulkan procedural grass renderer", nullptr, nullptr);
+        if (window == nullptr) {
+            throw std::runtime_error("failed to create glfw window!");
+        }
+
+        // Link the application structure to the window.
+        glfwSetWindowUserPointer(window, &vkApp);
 
-    // Link the application structure to the window.
-    glfwSetWindowUserPointer(window, &vkApp);
+        // Link functionality to determine key presses, mostly for the dynamic camera.
+        glfwSetKeyCallback(window, keyCallback);
 
-    // Link functionality to determine key presses, mostly for the dynamic camera.
-    glfwSetKeyCallback(window, keyCallback);
+        // Link functionality to when glfw detects its framebuffer has been resized (window resizing).
+        glfwSetFramebufferSizeCallback(window, frameBufferResizeCallback);
 
-    // Link functionality to when glfw detects its framebuffer has been resized (window resizing).
-    glfwSetFramebufferSizeCallback(window, frameBufferResizeCallback);
+        // Begin the timer to retrieve delta time throughout the application loop.
+        vkApp.lastTime = glfwGetTime();
 
-    // Begin the timer to retrieve delta time throughout the application loop.
-    vkApp.lastTime = glfwGetTime();
+        vkApp.linkWindowToVulkan(window);
+    }
+
+    // The configurations to capture, one unless sweeping. The blade buffers are sized for the largest blade count so switching between
+    // configurations only rebuilds the blades, not the device, pipelines, or descriptor sets.
+    std::vector<SceneSettings> configurations = buildSweep(launchOptions);
+    const bool sweeping = !launchOptions.sweepBlades.empty() || !launchOptions.sweepCulling.empty() || !launchOptions.sweepTessellation.empty() ||
+        !launchOptions.sweepWorkgroup.empty() || !launchOptions.sweepWindField.empty();
+    if (!launchOptions.sweepBlades.empty()) {
+        vkApp.setBladeCapacity(*std::max_element(launchOptions.sweepBlades.begin(), launchOptions.sweepBlades.end()));
+    }
+    vkApp.sceneSettings = configurations.front();
+    vkApp.setLoadPipelineCache(!launchOptions.coldPipelines);
+    vkApp.setFramesInFlight(static_cast<uint32_t>(launchOptions.framesInFlight));
+    vkApp.setAsyncCompute(launchOptions.asyncCompute);
+    vkApp.setDynamicRendering(launchOptions.dynamicRendering);
+    vkApp.setPresentMode(launchOptions.presentMode);
+    vkApp.setSwapchainImageCount(static_cast<uint32_t>(launchOptions.swapchainImages));
+    vkApp.setFrameLimit(static_cast<float>(launchOptions.fpsLimit));
+    size_t configurationIndex = 0;
+
+    // Every configuration of a sweep must see the same views, so it flies the default path unless given another.
+    if (sweeping) {
+        if (!launchOptions.recordPath.empty()) {
+            throw std::runtime_error("cannot record a camera path while sweeping");
+        }
+        if (launchOptions.cameraPath.empty()) {
+            launchOptions.cameraPath = "default";
+        }
+        if (launchOptions.captureFrames == 0) {
+            throw std::runtime_error("a sweep needs a non-zero capture length");
+        }
+        if (launchOptions.resizeTest) {
+            throw std::runtime_error("cannot run the resize test while sweeping");
+        }
+    }
+
+    // CPU zones are always recorded until the first frame for the start-up report, and afterwards only when tracing.
+    CpuProfiler::get().setEnabled(true);
+    CpuProfiler::get().setThreadName("Main");
 
     // Vulkan application initialization:
-    vkApp.linkWindowToVulkan(window);
     vkApp.linkCameraToVulkan(&globalCamera);
     VkResult ret = vkApp.initialiseApplication();
     if (ret != VK_SUCCESS) throw std::runtime_error("Could not initialise application.");
 
-    // For use in monitoring frame time.
+    if (launchOptions.trace) {
+        std::string fileName = "../assets/performance_timings/VulkanStartupTrace.json";
+        if (!CpuProfiler::get().exportChromeTrace(fileName, 0)) {
+            throw std::runtime_error("failed to write " + fileName);
+        }
+    }
+
+    // Scripted camera motion for reproducible benchmarks, or live input recorded into a new path.
+    CameraPath cameraPath = {};
+    if (launchOptions.cameraPath == "default") {
+        cameraPath = CameraPath::createDefaultFlythrough();
+    }
+    else if (!launchOptions.cameraPath.empty() && !cameraPath.load(launchOptions.cameraPath)) {
+        throw std::runtime_error("failed to load camera path " + launchOptions.cameraPath);
+    }
+    CameraPath recordedPath = {};
+
+    // For use in monitoring frame time, frameNum restarts with each configuration of a sweep.
     int frameNum = 0;
-    std::vector<double> timeInMs; 
-    timeInMs.reserve(kMonitorFrames);
-    bool writtenToFile = false;
+    FrameStatsRecorder frameStats = {};
+    SweepResultsWriter sweepResults = {};
+    uint64_t traceStartNs = 0;          // CpuProfiler::now() when the current capture started, the start of its trace.
+    uint32_t resizeTestStep = 0;        // Resizes made by the resize test so far.
+    double resizeTestWorstMs = 0.0;     // The longest frame since the resize test's first resize.
+
+    // Headless runs and sweeps stop after the warm-up and capture of the last configuration, windowed runs when the window is closed.
+    const int configurationFrames = launchOptions.warmupFrames + launchOptions.captureFrames;
 
     // Main application loop:
-    while (!glfwWindowShouldClose(window)) {
+    while (configurationIndex < configurations.size() && (headless || !glfwWindowShouldClose(window))) {
+        CPU_PROFILE_ZONE("Frame");
+
+        // Pace to the frame limit before polling input, so the wait adds to neither the input-to-present latency nor the measured frame time.
+        {
+            CPU_PROFILE_ZONE("Frame limiter");
+            frameLimiter.wait(vkApp.getFrameLimit());
+        }
         
         // Begin calculating frame time.
         auto t0 = std::chrono::high_resolution_clock::now(); 
 
         // Internal application timings.
-        double currentTime = glfwGetTime();
-        vkApp.lastFrameTime = (currentTime - vkApp.lastTime) * 1000.0;
-        vkApp.lastTime = currentTime;
         vkApp.deltaTime = timer.getDeltaTime();
+        if (headless) {
+            vkApp.lastFrameTime = vkApp.deltaTime * 1000.0f;
+        }
+        else {
+            double currentTime = glfwGetTime();
+            vkApp.lastFrameTime = (currentTime - vkApp.lastTime) * 1000.0;
+            vkApp.lastTime = currentTime;
+
+            // Process any window events, calls any associated callbacks (including camera.processKey).
+            {
+                CPU_PROFILE_ZONE("glfwPollEvents");
+                vkApp.setInputTimestamp(CpuProfiler::now());
+                glfwPollEvents();
+            }
 
-        // Process any window events, calls any associated callbacks (including camera.processKey).
-        glfwPollEvents();
-
-        // Create new ImGui frames via its backend and context.
-        ImGui_ImplVulkan_NewFrame();
-        ImGui_ImplGlfw_NewFrame();
-        ImGui::NewFrame();
+            // Create new ImGui frames via its backend and context.
+            CPU_PROFILE_ZONE("ImGui frame");
+            ImGui_ImplVulkan_NewFrame();
+            ImGui_ImplGlfw_NewFrame();
+            ImGui::NewFrame();
 
-        // Prepare ImGui draw data, this does not affect the graphics in any way, the drawing is done later.
-        vkApp.prepareImGuiDrawData();
+            // Prepare ImGui draw data, this does not affect the graphics in any way, the drawing is done later.
+            vkApp.prepareImGuiDrawData();
+        }
 
-        // Update camera data.
-        globalCamera.update();
+        // Update camera data, from the path by frame index when one is playing so every run sees the same views.
+        int64_t pathFrame = -1;
+        {
+            CPU_PROFILE_ZONE("Camera update");
+            if (!cameraPath.isEmpty()) {
+                pathFrame = cameraPath.apply(static_cast<uint32_t>(frameNum), globalCamera);
+            }
+            else {
+                globalCamera.update();
+            }
+        }
+        if (!launchOptions.recordPath.empty() && frameNum % kCameraPathRecordInterval == 0) {
+            recordedPath.addKeyframe({ static_cast<uint32_t>(frameNum), globalCamera.position, globalCamera.pitch, globalCamera.yaw, globalCamera.fov });
+        }
 
         // Prepare the ImGui data for rendering so you can call GetDrawData().
-        ImGui::Render();        
+        if (!headless) {
+            CPU_PROFILE_ZONE("ImGui render");
+            ImGui::Render();        
+        }
         
         // Record and execute commands through a compute and graphics pipeline.
         vkApp.render();
 
+        if (frameNum == 0 && configurationIndex == 0) {
+            uint64_t firstFrameNs = CpuProfiler::now();
+            writeStartupReport(std::cout, launchNs, firstFrameNs, vkApp.getPipelineCacheReport());
+
+            std::ofstream reportFile("../assets/performance_timings/VulkanStartupReport.txt");
+            writeStartupReport(reportFile, launchNs, firstFrameNs, vkApp.getPipelineCacheReport());
+            CpuProfiler::get().setEnabled(launchOptions.trace);
+        }
+
         // End and monitor frame time.
         auto t1 = std::chrono::high_resolution_clock::now();
-        if (frameNum >= kWaitFrames) { // Wait for n frames for scene to populate.
-            auto t = t1 - t0;
-            double tc = std::chrono::duration_cast<std::chrono::duration<double>>(t).count();
-            double time = (tc * 1000);
-            if (timeInMs.size() < kMonitorFrames) { // Insert new frame timing if not at max count.
-                timeInMs.push_back(time);
+        if (frameNum == launchOptions.warmupFrames && launchOptions.captureFrames > 0) { // Wait for n frames for scene to populate.
+            FrameStatsMetadata metadata = vkApp.getFrameStatsMetadata();
+            metadata.warmupFrames = static_cast<uint32_t>(launchOptions.warmupFrames);
+            metadata.captureFrames = static_cast<uint32_t>(launchOptions.captureFrames);
+            metadata.cameraPath = launchOptions.cameraPath.empty() ? "none" : launchOptions.cameraPath;
+
+            std::string fileName = getCaptureFileName(launchOptions, vkApp.sceneSettings, "VulkanFrameStats", ".csv");
+            if (!frameStats.open(fileName, metadata)) {
+                throw std::runtime_error("failed to open " + fileName);
+            }
+
+            // Only average the pipeline statistics over the captured frames, and only trace them.
+            vkApp.gpuProfiler.resetPipelineStatisticsTotals();
+            traceStartNs = CpuProfiler::now();
+        }
+        if (frameStats.isOpen()) {
+            double time = std::chrono::duration_cast<std::chrono::duration<double>>(t1 - t0).count() * 1000.0;
+            FrameStatsSample sample = vkApp.getFrameStatsSample(time);
+            sample.pathFrame = pathFrame;
+            frameStats.record(sample);
+
+            if (frameStats.getNumFrames() >= static_cast<uint64_t>(launchOptions.captureFrames)) { // Capture complete, append the summary.
+                frameStats.close();
+                writePipelineStatistics(vkApp.gpuProfiler, getCaptureFileName(launchOptions, vkApp.sceneSettings, "VulkanPipelineStatistics", ".txt"));
+                if (launchOptions.trace) {
+                    std::string fileName = getCaptureFileName(launchOptions, vkApp.sceneSettings, "VulkanTrace", ".json");
+                    if (!CpuProfiler::get().exportChromeTrace(fileName, traceStartNs)) {
+                        throw std::runtime_error("failed to write " + fileName);
+                    }
+                }
+
+                if (sweeping) {
+                    FrameStatsMetadata metadata = vkApp.getFrameStatsMetadata();
+                    metadata.warmupFrames = static_cast<uint32_t>(launchOptions.warmupFrames);
+                    metadata.captureFrames = static_cast<uint32_t>(launchOptions.captureFrames);
+                    metadata.cameraPath = launchOptions.cameraPath;
+
+                    std::string fileName = "../assets/performance_timings/VulkanSweepResults.csv";
+                    if (!sweepResults.isOpen() && !sweepResults.open(fileName, metadata)) {
+                        throw std::runtime_error("failed to open " + fileName);
+                    }
+                    FrameStatsSummary summary = frameStats.getSummary();
+                    sweepResults.write(metadata, summary);
+                    std::printf("%zu/%zu: %u blades, culling %s, tessellation %.0f, workgroup %u, mean %.4f ms, p99 %.4f ms\n", configurationIndex + 1,
+                        configurations.size(), metadata.numBlades, metadata.frustumCulling ? "on" : "off", metadata.maxTessellationLevel,
+                        metadata.computeWorkgroupSize, summary.mean, summary.p99);
+                }
             }
-            if (timeInMs.size() >= kMonitorFrames && !writtenToFile) { // If at max count, write those timings to file.
-                std::string fileName = "../assets/performance_timings/VulkanFrameTimings_";
-                fileName += std::to_string(kMaxBlades);
-                fileName += ".txt"; 
-                std::ofstream file(fileName);
-                std::ostream_iterator<double> it(file, "\n");
-                std::copy(std::begin(timeInMs), std::end(timeInMs), it); 
-                writtenToFile = true;
+        }
+
+        // Resize the window every kResizeTestInterval frames through a range of sizes, so each frame that recreates the swapchain is timed
+        // alongside the frames still in flight. Once done, report the stalls and close the window.
+        if (launchOptions.resizeTest) {
+            if (resizeTestStep > 0) {
+                resizeTestWorstMs = std::max(resizeTestWorstMs, std::chrono::duration_cast<std::chrono::duration<double>>(t1 - t0).count() * 1000.0);
+            }
+            if (frameNum > 0 && frameNum % static_cast<int>(kResizeTestInterval) == 0) {
+                if (resizeTestStep < kResizeTestSteps) {
+                    float scale = 0.5f + 0.125f * static_cast<float>(resizeTestStep % 5);
+                    glfwSetWindowSize(window, static_cast<int>(launchOptions.width * scale), static_cast<int>(launchOptions.height * scale));
+                    resizeTestStep++;
+                }
+                else {
+                    SwapchainRecreationStats stats = vkApp.getSwapchainRecreationStats();
+                    std::printf("resize test: %u swapchain recreations, mean %.4f ms, max %.4f ms, worst frame %.4f ms\n", stats.count,
+                        (stats.count > 0) ? stats.totalMs / stats.count : 0.0, stats.maxMs, resizeTestWorstMs);
+                    glfwSetWindowShouldClose(window, GLFW_TRUE);
+                }
             }
         }
         frameNum++;
+
+        // Move on to the next configuration once this one has been captured, restarting the warm-up and the camera path. A windowed run of a
+        // single configuration keeps rendering until the window is closed.
+        if (frameNum >= configurationFrames && (headless || sweeping)) {
+            if (++configurationIndex < configurations.size()) {
+                vkApp.applySceneSettings(configurations[configurationIndex]);
+                frameNum = 0;
+            }
+        }
+    }
+    sweepResults.close();
+
+    if (!launchOptions.recordPath.empty() && !recordedPath.save(launchOptions.recordPath)) {
+        throw std::runtime_error("failed to save camera path " + launchOptions.recordPath);
     }
 
     // All operations in vkApp.render() are asynchronous, ensure all operations/commands have completed before termination.
     vkDeviceWaitIdle(vkApp.m_LogicalDevice);
 
     // Destroy the ImGui backends and context.
-    ImGui_ImplVulkan_Shutdown();
-    ImGui_ImplGlfw_Shutdown();
-    ImGui::DestroyContext();
+    if (!headless) {
+        ImGui_ImplVulkan_Shutdown();
+        ImGui_ImplGlfw_Shutdown();
+        ImGui::DestroyContext();
+    }
+
+    // Headless runs report the capture on stdout as well, for CI logs.
+    if (headless && frameStats.getNumFrames() > 0) {
+        FrameStatsSummary summary = frameStats.getSummary();
+        std::printf("frames %llu, mean %.4f ms, median %.4f ms, p95 %.4f ms, p99 %.4f ms, max %.4f ms, variance %.4f ms^2\n",
+            static_cast<unsigned long long>(summary.numFrames), summary.mean, summary.median, summary.p95, summary.p99, summary.max, summary.variance);
+    }
 
     // Clean up/termination of allocated Vulkan objects (in the reverse order to initialization).
     vkApp.cleanupApplication(window);
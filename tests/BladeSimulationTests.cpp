@@ -0,0 +1,165 @@
+// ===============================================================================================================================================================================
+
+// Checks the CPU reference of the blade simulation in include/BladeSimulation.h against hand-computed values. The reference is what the
+// GPU results are validated against, so it is tested on its own without a device. Returns non-zero if any check fails.
+
+// ===============================================================================================================================================================================
+
+#include "BladeSimulation.h"
+
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+// ===============================================================================================================================================================================
+
+static int failures = 0;
+
+static void check(bool condition, const char* name)
+{
+	if (!condition) {
+		std::cerr << "FAILED: " << name << std::endl;
+		failures++;
+	}
+}
+
+static bool near(glm::vec3 a, glm::vec3 b, float tolerance = 1e-4f)
+{
+	return glm::length(a - b) <= tolerance;
+}
+
+static bool near(glm::vec2 a, glm::vec2 b, float tolerance = 1e-4f)
+{
+	return glm::length(a - b) <= tolerance;
+}
+
+// An upright blade rooted at the origin, with its width direction along X.
+static GrassBladeInstanceData createUprightBlade(float height, glm::vec3 p1)
+{
+	GrassBladeInstanceData blade = {};
+	blade.p0_width = glm::vec4(0.0f, 0.0f, 0.0f, 0.1f);
+	blade.p1_height = glm::vec4(p1, height);
+	blade.p2_direction = glm::vec4(0.0f, 0.0f, height, 0.0f);
+	blade.up_stiffness = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f);
+	return blade;
+}
+
+// Gravity off, so only the force under test moves the tip.
+static BladeSimulationParameters createParameters()
+{
+	BladeSimulationParameters parameters = {};
+	parameters.gravity = 0.0f;
+	parameters.windForce = 1.0f;
+	parameters.trampleRecoveryTime = 4.0f;
+	parameters.deltaTime = 1.0f;
+	return parameters;
+}
+
+// ===============================================================================================================================================================================
+
+static void testSampleWindField()
+{
+	// Texels (0, 0), (1, 0), (0, 1), (1, 1) of a 2x2 field.
+	std::vector<glm::vec2> windField = { glm::vec2(0.0f, 0.0f), glm::vec2(1.0f, 0.0f), glm::vec2(0.0f, 2.0f), glm::vec2(1.0f, 2.0f) };
+
+	check(near(BladeSimulation::sampleWindField(windField, 2, glm::vec2(0.25f, 0.25f)), glm::vec2(0.0f, 0.0f)), "wind field texel centre");
+	check(near(BladeSimulation::sampleWindField(windField, 2, glm::vec2(0.75f, 0.25f)), glm::vec2(1.0f, 0.0f)), "wind field second texel centre");
+	check(near(BladeSimulation::sampleWindField(windField, 2, glm::vec2(0.5f, 0.5f)), glm::vec2(0.5f, 1.0f)), "wind field bilinear centre");
+
+	// The corner is halfway between the last and first texels in both directions, so repeat addressing averages all four.
+	check(near(BladeSimulation::sampleWindField(windField, 2, glm::vec2(0.0f, 0.0f)), glm::vec2(0.5f, 1.0f)), "wind field repeat addressing");
+}
+
+static void testStepAtRest()
+{
+	// Upright with no forces, the blade stays put and only the trample decays, by dt / trampleRecoveryTime.
+	GrassBladeInstanceData blade = createUprightBlade(1.0f, glm::vec3(0.0f, 0.0f, 1.0f));
+	float trample = 0.0f;
+	GrassBladeInstanceData result = BladeSimulation::step(blade, glm::vec2(0.0f), 0.5f, {}, createParameters(), trample);
+
+	check(near(glm::vec3(result.p1_height), glm::vec3(0.0f, 0.0f, 1.0f)), "step at rest p1");
+	check(near(glm::vec3(result.p2_direction), glm::vec3(0.0f, 0.0f, 1.0f)), "step at rest p2");
+	check(std::fabs(trample - 0.25f) < 1e-6f, "step at rest trample decay");
+	check(result.p1_height.w == 1.0f && result.p2_direction.w == 0.0f, "step keeps height and direction");
+}
+
+static void testStepWind()
+{
+	// Wind across an upright blade is fully aligned and at full height, so the tip moves by the wind (0.5, 0, 0). The state validation
+	// then puts p1 at (0, 0, 1 - 0.5), and keepPersistentLength scales both segments by 1 / ((2 * |(0.5, 0, 1)| + 0.5 + |(0.5, 0, 0.5)|) / 3).
+	GrassBladeInstanceData blade = createUprightBlade(1.0f, glm::vec3(0.0f, 0.0f, 0.5f));
+	float trample = 0.0f;
+	GrassBladeInstanceData result = BladeSimulation::step(blade, glm::vec2(0.5f, 0.0f), 0.0f, {}, createParameters(), trample);
+
+	check(near(glm::vec3(result.p1_height), glm::vec3(0.0f, 0.0f, 0.435644f)), "step wind p1");
+	check(near(glm::vec3(result.p2_direction), glm::vec3(0.435644f, 0.0f, 0.871289f)), "step wind p2");
+	check(trample == 0.0f, "step wind trample");
+}
+
+static void testStepCollider()
+{
+	// A sphere of radius 1 at (0, 0, 1.5) pushes the tip down by 0.5 and just touches the midpoint (0, 0, 0.5). Half the blade height of
+	// displacement fully tramples it. p1 returns to (0, 0, 1), and keepPersistentLength scales the segments by 1 / ((2 * 0.5 + 1.5) / 3).
+	GrassBladeInstanceData blade = createUprightBlade(1.0f, glm::vec3(0.0f, 0.0f, 0.5f));
+	std::vector<glm::vec4> colliders = { glm::vec4(0.0f, 0.0f, 1.5f, 1.0f) };
+	float trample = 0.0f;
+	GrassBladeInstanceData result = BladeSimulation::step(blade, glm::vec2(0.0f), 0.0f, colliders, createParameters(), trample);
+
+	check(near(glm::vec3(result.p1_height), glm::vec3(0.0f, 0.0f, 1.2f)), "step collider p1");
+	check(near(glm::vec3(result.p2_direction), glm::vec3(0.0f, 0.0f, 0.6f)), "step collider p2");
+	check(trample == 1.0f, "step collider trample");
+}
+
+static void testSway()
+{
+	// Recovery balances the wind (1, 0, 0) at stiffness 1, so the tip points along (0, 0, 1) + (1, 0, 0) and p1 sits at 1 - sqrt(0.5).
+	GrassBladeInstanceData blade = createUprightBlade(1.0f, glm::vec3(0.0f, 0.0f, 0.5f));
+	GrassBladeInstanceData result = BladeSimulation::sway(blade, glm::vec2(1.0f, 0.0f), createParameters());
+
+	check(near(glm::vec3(result.p2_direction), glm::vec3(0.707107f, 0.0f, 0.707107f)), "sway p2");
+	check(near(glm::vec3(result.p1_height), glm::vec3(0.0f, 0.0f, 0.292893f)), "sway p1");
+}
+
+static void testValidate()
+{
+	// One simulated blade and one culled blade, which carries its state forward unchanged and is not compared.
+	BladeSimulationParameters parameters = createParameters();
+	parameters.simulationDistance = 30.0f;
+
+	GrassBladeInstanceData blade = createUprightBlade(1.0f, glm::vec3(0.0f, 0.0f, 0.5f));
+	float trample = 0.0f;
+	GrassBladeInstanceData reference = BladeSimulation::step(blade, glm::vec2(0.5f, 0.0f), 0.0f, {}, parameters, trample);
+
+	std::vector<GrassBladeInstanceData> lastStates = { blade, blade };
+	std::vector<GrassBladeInstanceData> gpuStates = { reference, blade };
+	std::vector<float> lastTrample = { 0.0f, 0.0f };
+	std::vector<float> gpuTrample = { trample, 0.0f };
+	std::vector<glm::vec2> windSamples = { glm::vec2(0.5f, 0.0f), glm::vec2(0.5f, 0.0f) };
+
+	BladeSimulationValidation matching = BladeSimulation::validate(lastStates, gpuStates, lastTrample, gpuTrample, windSamples, {}, parameters, 1e-3f);
+	check(matching.sampled == 2 && matching.compared == 1 && matching.mismatched == 0, "validate matching results");
+
+	gpuStates[0].p2_direction.x += 0.01f;
+	BladeSimulationValidation mismatched = BladeSimulation::validate(lastStates, gpuStates, lastTrample, gpuTrample, windSamples, {}, parameters, 1e-3f);
+	check(mismatched.mismatched == 1 && std::fabs(mismatched.maxError - 0.01f) < 1e-4f, "validate mismatched results");
+}
+
+// ===============================================================================================================================================================================
+
+int main()
+{
+	testSampleWindField();
+	testStepAtRest();
+	testStepWind();
+	testStepCollider();
+	testSway();
+	testValidate();
+
+	if (failures > 0) {
+		std::cerr << failures << " blade simulation check(s) failed." << std::endl;
+		return 1;
+	}
+
+	std::cout << "All blade simulation checks passed." << std::endl;
+	return 0;
+}
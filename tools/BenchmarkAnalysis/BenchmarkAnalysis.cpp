@@ -0,0 +1,385 @@
+// ===============================================================================================================================================================================
+
+// Offline benchmark analysis for the frame timing captures in assets/performance_timings.
+//
+// Usage: BenchmarkAnalysis [options] <baseline> [<candidate>...]
+//
+// Loads both capture formats: the original one frame time per-line files, and the FrameStatsRecorder CSV files ("# key: value" comments, a
+// column header, one row per-frame). Prints the statistics of every capture, then compares each candidate against the baseline. Exits with 1
+// if any candidate regresses, so the tool can gate merges on frame time changes.
+//
+// Options:
+//   --metric <mean|median|p95|p99>   Statistic compared between runs (default p99).
+//   --threshold <percent>            Allowed increase of the metric before a candidate counts as a regression (default 5).
+//   --column <name>                  CSV column to analyse (default cpuMs), ignored by the one value per-line format.
+//   --histogram                      Print a histogram of every capture.
+//   --bins <count>                   Histogram bins (default 20).
+//   --resamples <count>              Bootstrap resamples for the confidence intervals (default 1000).
+
+// ===============================================================================================================================================================================
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// ===============================================================================================================================================================================
+
+// Exit codes.
+static constexpr int kExitSuccess = 0;
+static constexpr int kExitRegression = 1;
+static constexpr int kExitError = 2;
+
+// Two-sided 95% confidence interval.
+static constexpr double kConfidenceLow = 0.025;
+static constexpr double kConfidenceHigh = 0.975;
+
+// Fixed so repeated runs on the same captures give the same intervals.
+static constexpr unsigned kBootstrapSeed = 1234u;
+
+// ===============================================================================================================================================================================
+
+enum class Metric {
+	Mean,
+	Median,
+	P95,
+	P99
+};
+
+struct Options {
+	Metric metric = Metric::P99;
+	double thresholdPercent = 5.0;
+	std::string column = "cpuMs";
+	bool histogram = false;
+	int bins = 20;
+	int resamples = 1000;
+	std::vector<std::string> files = {};
+};
+
+struct Capture {
+	std::string fileName;
+	std::vector<double> samples = {};
+};
+
+struct Statistics {
+	size_t count = 0;
+	double mean = 0.0;
+	double standardDeviation = 0.0;
+	double min = 0.0;
+	double median = 0.0;
+	double p95 = 0.0;
+	double p99 = 0.0;
+	double max = 0.0;
+	double meanConfidence = 0.0;	// Half-width of the 95% confidence interval of the mean.
+};
+
+// ===============================================================================================================================================================================
+
+static const char* getMetricName(Metric metric)
+{
+	switch (metric) {
+	case Metric::Mean: return "mean";
+	case Metric::Median: return "median";
+	case Metric::P95: return "p95";
+	case Metric::P99: return "p99";
+	default: return "unknown";
+	}
+}
+
+// Nearest-rank percentile, reorders values.
+static double percentile(std::vector<double>& values, double fraction)
+{
+	size_t rank = static_cast<size_t>(std::ceil(fraction * values.size()));
+	rank = std::clamp<size_t>(rank, 1, values.size()) - 1;
+	std::nth_element(values.begin(), values.begin() + rank, values.end());
+	return values[rank];
+}
+
+static double computeMetric(std::vector<double>& values, Metric metric)
+{
+	switch (metric) {
+	case Metric::Mean: {
+		double sum = 0.0;
+		for (double value : values) {
+			sum += value;
+		}
+		return sum / values.size();
+	}
+	case Metric::Median: return percentile(values, 0.5);
+	case Metric::P95: return percentile(values, 0.95);
+	case Metric::P99: return percentile(values, 0.99);
+	default: return 0.0;
+	}
+}
+
+static Statistics computeStatistics(const std::vector<double>& samples)
+{
+	Statistics statistics = {};
+	statistics.count = samples.size();
+
+	// Welford's method for the mean and variance.
+	double mean = 0.0, m2 = 0.0;
+	for (size_t i = 0; i < samples.size(); ++i) {
+		double delta = samples[i] - mean;
+		mean += delta / static_cast<double>(i + 1);
+		m2 += delta * (samples[i] - mean);
+	}
+	statistics.mean = mean;
+	statistics.standardDeviation = (samples.size() > 1) ? std::sqrt(m2 / (samples.size() - 1)) : 0.0;
+	statistics.meanConfidence = 1.96 * statistics.standardDeviation / std::sqrt(static_cast<double>(samples.size()));
+
+	std::vector<double> sorted = samples;
+	std::sort(sorted.begin(), sorted.end());
+	statistics.min = sorted.front();
+	statistics.max = sorted.back();
+	statistics.median = percentile(sorted, 0.5);
+	statistics.p95 = percentile(sorted, 0.95);
+	statistics.p99 = percentile(sorted, 0.99);
+
+	return statistics;
+}
+
+// ===============================================================================================================================================================================
+
+static Capture loadCapture(const std::string& fileName, const std::string& column)
+{
+	std::ifstream file(fileName);
+	if (!file.is_open()) {
+		throw std::runtime_error("failed to open " + fileName);
+	}
+
+	Capture capture = {};
+	capture.fileName = fileName;
+
+	int columnIndex = 0;	// The one value per-line format is a single column.
+	bool headerRead = false;
+	std::string line;
+	while (std::getline(file, line)) {
+		if (!line.empty() && line.back() == '\r') {
+			line.pop_back();
+		}
+		if (line.empty() || line[0] == '#') {
+			continue;
+		}
+
+		std::vector<std::string> fields;
+		std::stringstream stream(line);
+		std::string field;
+		while (std::getline(stream, field, ',')) {
+			fields.push_back(field);
+		}
+
+		// A first row that does not start with a number is the CSV column header.
+		if (!headerRead) {
+			headerRead = true;
+			char* end = nullptr;
+			std::strtod(fields[0].c_str(), &end);
+			if (end == fields[0].c_str()) {
+				auto it = std::find(fields.begin(), fields.end(), column);
+				if (it == fields.end()) {
+					throw std::runtime_error("no column " + column + " in " + fileName);
+				}
+				columnIndex = static_cast<int>(it - fields.begin());
+				continue;
+			}
+		}
+
+		if (columnIndex >= static_cast<int>(fields.size())) {
+			throw std::runtime_error("short row in " + fileName + ": " + line);
+		}
+		capture.samples.push_back(std::stod(fields[columnIndex]));
+	}
+
+	if (capture.samples.empty()) {
+		throw std::runtime_error("no samples in " + fileName);
+	}
+
+	return capture;
+}
+
+// ===============================================================================================================================================================================
+
+static void printHistogram(const Capture& capture, int bins)
+{
+	// The range stops at p99 so a handful of hitches do not squash every other bin, anything above lands in the overflow row.
+	std::vector<double> sorted = capture.samples;
+	std::sort(sorted.begin(), sorted.end());
+	double low = sorted.front();
+	double high = percentile(sorted, 0.99);
+	double width = (high > low) ? (high - low) / bins : 1.0;
+
+	std::vector<size_t> counts(bins + 1, 0);
+	for (double sample : capture.samples) {
+		int bin = (sample > high) ? bins : std::clamp(static_cast<int>((sample - low) / width), 0, bins - 1);
+		++counts[bin];
+	}
+
+	size_t largest = *std::max_element(counts.begin(), counts.end());
+	std::printf("\nHistogram of %s (ms):\n", capture.fileName.c_str());
+	for (int i = 0; i <= bins; ++i) {
+		int barLength = (largest > 0) ? static_cast<int>(50.0 * counts[i] / largest) : 0;
+		if (i < bins) {
+			std::printf("  %9.4f - %9.4f | %7zu | %s\n", low + i * width, low + (i + 1) * width, counts[i], std::string(barLength, '#').c_str());
+		}
+		else {
+			std::printf("  %9.4f +           | %7zu | %s\n", high, counts[i], std::string(barLength, '#').c_str());
+		}
+	}
+}
+
+// Bootstrap 95% confidence interval of the relative change of the metric, in percent.
+static void bootstrapDelta(const Capture& baseline, const Capture& candidate, Metric metric, int resamples, double& low, double& high)
+{
+	std::mt19937 generator(kBootstrapSeed);
+	std::uniform_int_distribution<size_t> pickBaseline(0, baseline.samples.size() - 1);
+	std::uniform_int_distribution<size_t> pickCandidate(0, candidate.samples.size() - 1);
+
+	std::vector<double> deltas;
+	deltas.reserve(resamples);
+	std::vector<double> baselineResample(baseline.samples.size());
+	std::vector<double> candidateResample(candidate.samples.size());
+	for (int i = 0; i < resamples; ++i) {
+		for (double& value : baselineResample) {
+			value = baseline.samples[pickBaseline(generator)];
+		}
+		for (double& value : candidateResample) {
+			value = candidate.samples[pickCandidate(generator)];
+		}
+
+		double baselineMetric = computeMetric(baselineResample, metric);
+		double candidateMetric = computeMetric(candidateResample, metric);
+		deltas.push_back(100.0 * (candidateMetric - baselineMetric) / baselineMetric);
+	}
+
+	low = percentile(deltas, kConfidenceLow);
+	high = percentile(deltas, kConfidenceHigh);
+}
+
+// ===============================================================================================================================================================================
+
+static void printUsage()
+{
+	std::printf("Usage: BenchmarkAnalysis [--metric mean|median|p95|p99] [--threshold percent] [--column name] [--histogram] [--bins count]\n");
+	std::printf("                         [--resamples count] <baseline> [<candidate>...]\n");
+}
+
+static Options parseOptions(int argc, char** argv)
+{
+	Options options = {};
+	for (int i = 1; i < argc; ++i) {
+		std::string argument = argv[i];
+		bool hasValue = i + 1 < argc;
+
+		if (argument == "--histogram") {
+			options.histogram = true;
+		}
+		else if (argument == "--metric" && hasValue) {
+			std::string name = argv[++i];
+			if (name == "mean") options.metric = Metric::Mean;
+			else if (name == "median") options.metric = Metric::Median;
+			else if (name == "p95") options.metric = Metric::P95;
+			else if (name == "p99") options.metric = Metric::P99;
+			else throw std::runtime_error("unknown metric " + name);
+		}
+		else if (argument == "--threshold" && hasValue) {
+			options.thresholdPercent = std::stod(argv[++i]);
+		}
+		else if (argument == "--column" && hasValue) {
+			options.column = argv[++i];
+		}
+		else if (argument == "--bins" && hasValue) {
+			options.bins = std::max(1, std::stoi(argv[++i]));
+		}
+		else if (argument == "--resamples" && hasValue) {
+			options.resamples = std::max(1, std::stoi(argv[++i]));
+		}
+		else if (argument.rfind("--", 0) == 0) {
+			throw std::runtime_error("unknown or incomplete option " + argument);
+		}
+		else {
+			options.files.push_back(argument);
+		}
+	}
+
+	if (options.files.empty()) {
+		throw std::runtime_error("no capture files given");
+	}
+
+	return options;
+}
+
+// ===============================================================================================================================================================================
+
+int main(int argc, char** argv)
+{
+	Options options = {};
+	std::vector<Capture> captures;
+	try {
+		options = parseOptions(argc, argv);
+		for (const std::string& fileName : options.files) {
+			captures.push_back(loadCapture(fileName, options.column));
+		}
+	}
+	catch (const std::exception& exception) {
+		std::fprintf(stderr, "error: %s\n", exception.what());
+		printUsage();
+		return kExitError;
+	}
+
+	std::printf("%-48s %7s %9s %9s %9s %9s %9s %9s %9s %16s\n", "capture", "frames", "mean", "stddev", "min", "median", "p95", "p99", "max", "mean 95% CI");
+	for (const Capture& capture : captures) {
+		Statistics statistics = computeStatistics(capture.samples);
+		std::printf("%-48s %7zu %9.4f %9.4f %9.4f %9.4f %9.4f %9.4f %9.4f %7.4f-%-8.4f\n", capture.fileName.c_str(), statistics.count, statistics.mean,
+			statistics.standardDeviation, statistics.min, statistics.median, statistics.p95, statistics.p99, statistics.max,
+			statistics.mean - statistics.meanConfidence, statistics.mean + statistics.meanConfidence);
+	}
+
+	if (options.histogram) {
+		for (const Capture& capture : captures) {
+			printHistogram(capture, options.bins);
+		}
+	}
+
+	if (captures.size() < 2) {
+		return kExitSuccess;
+	}
+
+	// A candidate regresses when its metric grows by more than the threshold and the whole confidence interval of the change is an increase,
+	// so run-to-run noise alone does not fail the gate.
+	const Capture& baseline = captures[0];
+	std::vector<double> baselineSamples = baseline.samples;
+	double baselineMetric = computeMetric(baselineSamples, options.metric);
+
+	std::printf("\nComparison of %s against %s (threshold +%.2f%%):\n", getMetricName(options.metric), baseline.fileName.c_str(), options.thresholdPercent);
+	std::printf("%-48s %11s %11s %9s %20s %s\n", "candidate", "baseline", "candidate", "delta", "delta 95% CI", "result");
+
+	bool anyRegression = false;
+	for (size_t i = 1; i < captures.size(); ++i) {
+		std::vector<double> candidateSamples = captures[i].samples;
+		double candidateMetric = computeMetric(candidateSamples, options.metric);
+		double delta = 100.0 * (candidateMetric - baselineMetric) / baselineMetric;
+
+		double low = 0.0, high = 0.0;
+		bootstrapDelta(baseline, captures[i], options.metric, options.resamples, low, high);
+
+		const char* result = "ok";
+		if (delta > options.thresholdPercent && low > 0.0) {
+			result = "REGRESSION";
+			anyRegression = true;
+		}
+		else if (delta < 0.0 && high < 0.0) {
+			result = "improvement";
+		}
+
+		std::printf("%-48s %11.4f %11.4f %+8.2f%% %+9.2f%%/%+8.2f%% %s\n", captures[i].fileName.c_str(), baselineMetric, candidateMetric, delta, low, high, result);
+	}
+
+	return anyRegression ? kExitRegression : kExitSuccess;
+}